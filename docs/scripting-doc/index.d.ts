@@ -2310,6 +2310,21 @@ declare class TileLayer extends Layer {
    */
   tileAt(x : number, y : number) : Tile | null
 
+  /**
+   * Returns the global tile IDs of the cells in the given rectangle, in
+   * row-major order, as 32-bit unsigned integers. The GIDs include the flip
+   * flags and match those used when saving the map. Empty cells are 0.
+   *
+   * This is much faster than calling {@link tileAt} for each cell:
+   *
+   * ```js
+   * const gids = new Uint32Array(layer.gids(0, 0, layer.width, layer.height))
+   * ```
+   *
+   * @since 1.9
+   */
+  gids(x : number, y : number, width : number, height : number) : ArrayBuffer
+
   /**
    * Returns an object that enables making modifications to the tile layer.
    */
@@ -2341,6 +2356,22 @@ interface TileLayerEdit {
    */
   setTile(x : number, y : number, tile : Tile | null, flags? : number) : void
 
+  /**
+   * Sets the cells in the given rectangle from a buffer of global tile IDs
+   * in row-major order, as returned by {@link TileLayer.gids}. A GID of 0
+   * erases the cell. The buffer needs to contain exactly `width * height`
+   * 32-bit unsigned integers.
+   *
+   * ```js
+   * const gids = new Uint32Array(width * height)
+   * // ... fill gids ...
+   * edit.setGids(x, y, width, height, gids.buffer)
+   * ```
+   *
+   * @since 1.9
+   */
+  setGids(x : number, y : number, width : number, height : number, gids : ArrayBuffer) : void
+
   /**
    * Applies all changes made through this object. This object can be reused to make further changes.
    */
@@ -2984,6 +3015,30 @@ declare namespace tiled {
    */
   export function reload(asset: Asset): Asset | null;
 
+  /**
+   * Returns the files referenced by the given map, tileset, template or
+   * world file in the current project. These are tilesets, templates,
+   * images, maps and file properties.
+   *
+   * The references are indexed in the background. The result may be
+   * incomplete while the project is still being indexed.
+   *
+   * @since 1.9
+   */
+  export function fileDependencies(fileName: string): string[];
+
+  /**
+   * Returns the maps, tilesets, templates and worlds in the current project
+   * that reference the given file. For example, this can be used to find
+   * the maps that use a tileset.
+   *
+   * The references are indexed in the background. The result may be
+   * incomplete while the project is still being indexed.
+   *
+   * @since 1.9
+   */
+  export function fileDependents(fileName: string): string[];
+
   /**
    * Shows a modal warning dialog to the user with the given text and
    * optional title.
@@ -29,11 +29,13 @@
 #include "gidmapper.h"
 
 #include "compression.h"
+#include "numberformat.h"
 #include "tile.h"
 #include "tiled.h"
 #include "tileset.h"
 
 #include <algorithm>
+#include <limits>
 
 using namespace Tiled;
 
@@ -44,6 +46,10 @@ const unsigned FlippedAntiDiagonallyFlag = 0x20000000;
 
 const unsigned RotatedHexagonal120Flag   = 0x10000000;
 
+// Largest buffer allocated up front for encoding layer data, which leaves
+// some room for the header of the QByteArray on Qt 5
+const qint64 MaxByteArraySize = std::numeric_limits<int>::max() - 64;
+
 /**
  * Default constructor. Use \l insert to initialize the gid mapper
  * incrementally.
@@ -150,10 +156,14 @@ unsigned GidMapper::cellToGid(const Cell &cell) const
  * Encodes the tile layer data of the given \a tileLayer in the given
  * \a format. This function should only be used for base64 encoding, with or
  * without compression.
+ *
+ * Returns an empty byte array and sets \a ok to false when the layer is too
+ * large to be encoded in a single block.
  */
 QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
                                       Map::LayerDataFormat format,
-                                      QRect bounds, int compressionLevel) const
+                                      QRect bounds, int compressionLevel,
+                                      bool *ok) const
 {
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
@@ -161,16 +171,23 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     if (bounds.isEmpty())
         bounds = QRect(0, 0, tileLayer.width(), tileLayer.height());
 
+    const qint64 size = qint64(bounds.width()) * bounds.height() * 4;
+    if (ok)
+        *ok = size <= MaxByteArraySize;
+    if (size > MaxByteArraySize)
+        return QByteArray();
+
     QByteArray tileData;
-    tileData.reserve(bounds.width() * bounds.height() * 4);
+    tileData.resize(static_cast<int>(size));
+    char *out = tileData.data();
 
     for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
         for (int x = bounds.left(); x <= bounds.right(); ++x) {
             const unsigned gid = cellToGid(tileLayer.cellAt(x, y));
-            tileData.append(static_cast<char>(gid));
-            tileData.append(static_cast<char>(gid >> 8));
-            tileData.append(static_cast<char>(gid >> 16));
-            tileData.append(static_cast<char>(gid >> 24));
+            *out++ = static_cast<char>(gid);
+            *out++ = static_cast<char>(gid >> 8);
+            *out++ = static_cast<char>(gid >> 16);
+            *out++ = static_cast<char>(gid >> 24);
         }
     }
 
@@ -184,6 +201,84 @@ QByteArray GidMapper::encodeLayerData(const TileLayer &tileLayer,
     return tileData.toBase64();
 }
 
+/**
+ * Encodes the tile layer data of the given \a tileLayer within \a bounds as
+ * comma-separated global tile IDs. When \a newlines is true, the data starts
+ * with a newline and each row is followed by a newline.
+ */
+QByteArray GidMapper::encodeCSVLayerData(const TileLayer &tileLayer,
+                                         QRect bounds,
+                                         bool newlines) const
+{
+    // Reserve enough for the largest possible gids, shrunk again at the end
+    const qint64 rowLength = qint64(bounds.width()) * (MaxUnsignedDigits + 1) + 1;
+    const qint64 reservedSize = 1 + qint64(bounds.height()) * rowLength;
+
+    QByteArray csv;
+
+    // For huge layers, append the gids one by one rather than reserving a
+    // buffer that might not fit in a QByteArray
+    if (reservedSize > MaxByteArraySize) {
+        char buffer[MaxUnsignedDigits];
+
+        if (newlines)
+            csv.append('\n');
+
+        for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+            for (int x = bounds.left(); x <= bounds.right(); ++x) {
+                char *end = formatUnsigned(cellToGid(tileLayer.cellAt(x, y)), buffer);
+                csv.append(buffer, static_cast<int>(end - buffer));
+                if (x != bounds.right() || y != bounds.bottom())
+                    csv.append(',');
+            }
+            if (newlines)
+                csv.append('\n');
+        }
+
+        return csv;
+    }
+
+    csv.resize(static_cast<int>(reservedSize));
+    char *out = csv.data();
+
+    if (newlines)
+        *out++ = '\n';
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        for (int x = bounds.left(); x <= bounds.right(); ++x) {
+            out = formatUnsigned(cellToGid(tileLayer.cellAt(x, y)), out);
+            if (x != bounds.right() || y != bounds.bottom())
+                *out++ = ',';
+        }
+        if (newlines)
+            *out++ = '\n';
+    }
+
+    csv.truncate(static_cast<int>(out - csv.constData()));
+    return csv;
+}
+
+static QByteArray decompressLayerData(const QByteArray &data,
+                                      Map::LayerDataFormat format,
+                                      int size)
+{
+    if (format == Map::Base64Gzip)
+        return decompress(data, size, Gzip);
+    else if (format == Map::Base64Zlib)
+        return decompress(data, size, Zlib);
+    else if (format == Map::Base64Zstandard)
+        return decompress(data, size, Zstandard);
+    return data;
+}
+
+static inline unsigned readGid(const unsigned char *data)
+{
+    return data[0] |
+           data[1] << 8 |
+           data[2] << 16 |
+           data[3] << 24;
+}
+
 GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
                                                   const QByteArray &layerData,
                                                   Map::LayerDataFormat format,
@@ -192,15 +287,9 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
     Q_ASSERT(format != Map::XML);
     Q_ASSERT(format != Map::CSV);
 
-    QByteArray decodedData = QByteArray::fromBase64(layerData);
     const int size = bounds.width() * bounds.height() * 4;
-
-    if (format == Map::Base64Gzip)
-        decodedData = decompress(decodedData, size, Gzip);
-    else if (format == Map::Base64Zlib)
-        decodedData = decompress(decodedData, size, Zlib);
-    else if (format == Map::Base64Zstandard)
-        decodedData = decompress(decodedData, size, Zstandard);
+    const QByteArray decodedData = decompressLayerData(QByteArray::fromBase64(layerData),
+                                                       format, size);
 
     if (size != decodedData.length())
         return CorruptLayerData;
@@ -211,10 +300,7 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
     bool ok;
 
     for (int i = 0; i < size - 3; i += 4) {
-        const unsigned gid = data[i] |
-                             data[i + 1] << 8 |
-                             data[i + 2] << 16 |
-                             data[i + 3] << 24;
+        const unsigned gid = readGid(data + i);
 
         const Cell result = gidToCell(gid, ok);
         if (!ok) {
@@ -233,3 +319,121 @@ GidMapper::DecodeError GidMapper::decodeLayerData(TileLayer &tileLayer,
 
     return NoError;
 }
+
+/**
+ * Decodes the binary \a chunkData of a single chunk into \a cells, which
+ * needs to point to CHUNK_SIZE * CHUNK_SIZE cells. The data is expected to
+ * be base64-decoded already.
+ *
+ * \sa EncodedChunk
+ */
+GidMapper::DecodeError GidMapper::decodeChunkData(Cell *cells,
+                                                  const QByteArray &chunkData,
+                                                  Map::LayerDataFormat format) const
+{
+    Q_ASSERT(format != Map::XML);
+    Q_ASSERT(format != Map::CSV);
+
+    const int size = CHUNK_SIZE * CHUNK_SIZE * 4;
+    const QByteArray decodedData = decompressLayerData(chunkData, format, size);
+
+    if (size != decodedData.length())
+        return CorruptLayerData;
+
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(decodedData.constData());
+    bool ok;
+
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i) {
+        const unsigned gid = readGid(data + i * 4);
+
+        cells[i] = gidToCell(gid, ok);
+        if (!ok) {
+            mInvalidTile = gid;
+            return isEmpty() ? TileButNoTilesets : InvalidTile;
+        }
+    }
+
+    return NoError;
+}
+
+/**
+ * Encodes the CHUNK_SIZE * CHUNK_SIZE \a cells of a chunk as zlib-compressed
+ * binary data, suitable for decodeChunkData() with the Map::Base64Zlib format.
+ *
+ * Sets \a ok to false when a cell refers to a tileset that is not known to
+ * this gid mapper, in which case the chunk can't be encoded.
+ */
+QByteArray GidMapper::encodeChunkData(const Cell *cells, bool &ok) const
+{
+    QByteArray chunkData;
+    chunkData.resize(CHUNK_SIZE * CHUNK_SIZE * 4);
+    char *data = chunkData.data();
+
+    for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i) {
+        const Cell &cell = cells[i];
+        const unsigned gid = cellToGid(cell);
+
+        if ((gid == 0 && !cell.isEmpty()) || cell.checked()) {
+            ok = false;
+            return QByteArray();
+        }
+
+        data[i * 4]     = static_cast<char>(gid);
+        data[i * 4 + 1] = static_cast<char>(gid >> 8);
+        data[i * 4 + 2] = static_cast<char>(gid >> 16);
+        data[i * 4 + 3] = static_cast<char>(gid >> 24);
+    }
+
+    ok = true;
+    return compress(chunkData, Zlib);
+}
+
+/**
+ * Returns the global tile IDs of the cells of \a tileLayer within \a bounds,
+ * in row-major order, as unsigned 32-bit integers in native byte order.
+ */
+QByteArray GidMapper::encodeGids(const TileLayer &tileLayer, QRect bounds) const
+{
+    const qint64 size = qint64(bounds.width()) * bounds.height() * qint64(sizeof(quint32));
+    Q_ASSERT(size <= MaxByteArraySize);
+
+    QByteArray gids(static_cast<int>(size), Qt::Uninitialized);
+    quint32 *out = reinterpret_cast<quint32*>(gids.data());
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y)
+        for (int x = bounds.left(); x <= bounds.right(); ++x)
+            *out++ = cellToGid(tileLayer.cellAt(x, y));
+
+    return gids;
+}
+
+/**
+ * Decodes \a gids, as returned by encodeGids(), into \a cells. The buffer
+ * needs to contain exactly \a cellCount global tile IDs.
+ *
+ * The \a cells are only changed when the whole buffer could be decoded.
+ */
+GidMapper::DecodeError GidMapper::decodeGids(QVector<Cell> &cells,
+                                             const QByteArray &gids,
+                                             int cellCount) const
+{
+    if (cellCount < 0 || gids.size() != qint64(cellCount) * qint64(sizeof(quint32)))
+        return CorruptLayerData;
+
+    const quint32 *in = reinterpret_cast<const quint32*>(gids.constData());
+
+    QVector<Cell> result;
+    result.reserve(cellCount);
+
+    for (int i = 0; i < cellCount; ++i) {
+        bool ok;
+        result.append(gidToCell(in[i], ok));
+        if (!ok) {
+            mInvalidTile = in[i];
+            return isEmpty() ? TileButNoTilesets : InvalidTile;
+        }
+    }
+
+    cells.swap(result);
+    return NoError;
+}
@@ -32,9 +32,26 @@
 #include "tilelayer.h"
 
 #include <QMap>
+#include <QSharedPointer>
 
 namespace Tiled {
 
+class GidMapper;
+
+/**
+ * The contents of a tile layer chunk in encoded form, as read from a file.
+ * Used for loading chunks lazily, only decoding them when they are accessed.
+ *
+ * The \a data is the binary layer data after base64 decoding, which may
+ * still be compressed depending on the \a format.
+ */
+struct EncodedChunk
+{
+    QByteArray data;
+    Map::LayerDataFormat format;
+    QSharedPointer<const GidMapper> gidMapper;
+};
+
 /**
  * A class that maps cells to global IDs (gids) and back.
  */
@@ -48,13 +65,20 @@ public:
     void clear();
     bool isEmpty() const;
 
+    QList<SharedTileset> tilesets() const;
+
     Cell gidToCell(unsigned gid, bool &ok) const;
     unsigned cellToGid(const Cell &cell) const;
 
     QByteArray encodeLayerData(const TileLayer &tileLayer,
                                Map::LayerDataFormat format,
                                QRect bounds = QRect(),
-                               int compressionLevel = -1) const;
+                               int compressionLevel = -1,
+                               bool *ok = nullptr) const;
+
+    QByteArray encodeCSVLayerData(const TileLayer &tileLayer,
+                                  QRect bounds,
+                                  bool newlines) const;
 
     enum DecodeError {
         NoError = 0,
@@ -68,6 +92,17 @@ public:
                                 Map::LayerDataFormat format,
                                 QRect bounds) const;
 
+    DecodeError decodeChunkData(Cell *cells,
+                                const QByteArray &chunkData,
+                                Map::LayerDataFormat format) const;
+
+    QByteArray encodeChunkData(const Cell *cells, bool &ok) const;
+
+    QByteArray encodeGids(const TileLayer &tileLayer, QRect bounds) const;
+    DecodeError decodeGids(QVector<Cell> &cells,
+                           const QByteArray &gids,
+                           int cellCount) const;
+
     unsigned invalidTile() const;
 
 private:
@@ -101,6 +136,15 @@ inline bool GidMapper::isEmpty() const
     return mFirstGidToTileset.isEmpty();
 }
 
+/**
+ * Returns the tilesets known to this gid mapper, ordered by their first
+ * global ID.
+ */
+inline QList<SharedTileset> GidMapper::tilesets() const
+{
+    return mFirstGidToTileset.values();
+}
+
 /**
  * Returns the GID of the invalid tile in case decodeLayerData() returns
  * the InvalidTile error.
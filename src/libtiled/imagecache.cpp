@@ -36,6 +36,8 @@
 #include <QBitmap>
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QRunnable>
+#include <QThreadPool>
 
 namespace Tiled {
 
@@ -99,34 +101,110 @@ LoadedPixmap::LoadedPixmap(const LoadedImage &cachedImage)
 {}
 
 
+class ImageCache::PreloadRunnable : public QRunnable
+{
+public:
+    explicit PreloadRunnable(const QString &fileName)
+        : mFileName(fileName)
+    {}
+
+    // Metatile maps are not rendered in the background, since they may be
+    // waiting for the tilesets being loaded by the thread requesting them
+    void run() override { ImageCache::loadImageImpl(mFileName, false); }
+
+private:
+    const QString mFileName;
+};
+
+
+QMutex ImageCache::sMutex;
+QWaitCondition ImageCache::sImageLoaded;
+QSet<QString> ImageCache::sLoadingImages;
 QHash<QString, LoadedImage> ImageCache::sLoadedImages;
 QHash<QString, LoadedPixmap> ImageCache::sLoadedPixmaps;
 QHash<TilesheetParameters, CutTiles> ImageCache::sCutTiles;
 
+/*
+ * The cache is locked only while accessing the hashes, not while loading,
+ * since loading an image can recursively load other images through
+ * metatile maps. When two threads load the same image at the same time, the
+ * first one to finish wins, so that the image data is still shared.
+ *
+ * While an image file is being decoded it is marked as loading, and other
+ * threads wait for it rather than decoding it as well. The mark is removed
+ * before rendering a metatile map, since that may need to wait for other
+ * threads in turn.
+ */
+
 LoadedImage ImageCache::loadImage(const QString &fileName)
+{
+    return loadImageImpl(fileName, true);
+}
+
+/**
+ * Starts loading the given image on a worker thread, when it isn't loaded
+ * already. Intended to be called as soon as it is known that an image will
+ * be needed, so that it may be available by the time loadImage() is called.
+ */
+void ImageCache::preloadImage(const QString &fileName)
+{
+    if (fileName.isEmpty())
+        return;
+
+    {
+        QMutexLocker locker(&sMutex);
+        if (sLoadingImages.contains(fileName) || sLoadedImages.contains(fileName))
+            return;
+    }
+
+    QThreadPool::globalInstance()->start(new PreloadRunnable(fileName));
+}
+
+LoadedImage ImageCache::loadImageImpl(const QString &fileName, bool renderMaps)
 {
     if (fileName.isEmpty())
         return {};
 
-    auto it = sLoadedImages.find(fileName);
+    const QDateTime lastModified = QFileInfo(fileName).lastModified();
 
-    QFileInfo info(fileName);
-    bool found = it != sLoadedImages.end();
-    bool old = found && it.value().lastModified < info.lastModified();
+    {
+        QMutexLocker locker(&sMutex);
 
-    if (old)
-        remove(fileName);
+        while (sLoadingImages.contains(fileName))
+            sImageLoaded.wait(&sMutex);
 
-    if (old || !found) {
-        QImage image(fileName);
+        auto it = sLoadedImages.find(fileName);
+        if (it != sLoadedImages.end()) {
+            if (!(it.value().lastModified < lastModified))
+                return it.value();
 
-        // If the image failed to load, try to load and render a map file
-        if (image.isNull())
-            image = renderMap(fileName);
+            removeLocked(fileName);
+        }
 
-        it = sLoadedImages.insert(fileName, LoadedImage(image, info.lastModified()));
+        sLoadingImages.insert(fileName);
     }
 
+    QImage image(fileName);
+
+    QMutexLocker locker(&sMutex);
+
+    sLoadingImages.remove(fileName);
+    sImageLoaded.wakeAll();
+
+    // If the image failed to load, try to load and render a map file
+    if (image.isNull()) {
+        if (!renderMaps)
+            return {};
+
+        locker.unlock();
+        image = renderMap(fileName);
+        locker.relock();
+    }
+
+    auto it = sLoadedImages.find(fileName);
+    if (it == sLoadedImages.end())
+        it = sLoadedImages.insert(fileName, LoadedImage(image, lastModified));
+
     return it.value();
 }
 
@@ -135,15 +213,25 @@ QPixmap ImageCache::loadPixmap(const QString &fileName)
     if (fileName.isEmpty())
         return {};
 
-    auto it = sLoadedPixmaps.find(fileName);
+    {
+        QMutexLocker locker(&sMutex);
+
+        auto it = sLoadedPixmaps.find(fileName);
+        if (it != sLoadedPixmaps.end()) {
+            if (!(it.value().lastModified < QFileInfo(fileName).lastModified()))
+                return it.value();
+
+            removeLocked(fileName);
+        }
+    }
+
+    LoadedPixmap loadedPixmap(loadImage(fileName));
 
-    bool found = it != sLoadedPixmaps.end();
-    bool old = found && it.value().lastModified < QFileInfo(fileName).lastModified();
+    QMutexLocker locker(&sMutex);
 
-    if (old)
-        remove(fileName);
-    if (old || !found)
-        it = sLoadedPixmaps.insert(fileName, LoadedPixmap(loadImage(fileName)));
+    auto it = sLoadedPixmaps.find(fileName);
+    if (it == sLoadedPixmaps.end())
+        it = sLoadedPixmaps.insert(fileName, loadedPixmap);
 
     return it.value();
 }
@@ -182,20 +270,39 @@ QVector<QPixmap> ImageCache::cutTiles(const TilesheetParameters &parameters)
     if (parameters.fileName.isEmpty())
         return {};
 
-    auto it = sCutTiles.find(parameters);
+    {
+        QMutexLocker locker(&sMutex);
+
+        auto it = sCutTiles.find(parameters);
+        if (it != sCutTiles.end()) {
+            if (!(it.value().lastModified < QFileInfo(parameters.fileName).lastModified()))
+                return it.value();
+
+            removeLocked(parameters.fileName);
+        }
+    }
 
-    bool found = it != sCutTiles.end();
-    bool old = found && it.value().lastModified < QFileInfo(parameters.fileName).lastModified();
+    CutTiles cutTiles = cutTilesImpl(parameters);
 
-    if (old)
-        remove(parameters.fileName);
-    if (old || !found)
-        it = sCutTiles.insert(parameters, cutTilesImpl(parameters));
+    QMutexLocker locker(&sMutex);
+
+    auto it = sCutTiles.find(parameters);
+    if (it == sCutTiles.end())
+        it = sCutTiles.insert(parameters, cutTiles);
 
     return it.value();
 }
 
 void ImageCache::remove(const QString &fileName)
+{
+    QMutexLocker locker(&sMutex);
+    removeLocked(fileName);
+}
+
+/**
+ * Removes the given file from the caches. Expects sMutex to be locked.
+ */
+void ImageCache::removeLocked(const QString &fileName)
 {
     sLoadedImages.remove(fileName);
     sLoadedPixmaps.remove(fileName);
@@ -213,7 +320,8 @@ QImage ImageCache::renderMap(const QString &fileName)
     if (fileName.isEmpty())
         return {};
 
-    static QSet<QString> loadingMaps;
+    // Tracked per thread, since other threads may load the same map
+    static thread_local QSet<QString> loadingMaps;
 
     if (loadingMaps.contains(fileName)) {
         ERROR(QCoreApplication::translate("Tiled::ImageCache",
@@ -34,8 +34,11 @@
 #include <QDateTime>
 #include <QHash>
 #include <QImage>
+#include <QMutex>
 #include <QPixmap>
+#include <QSet>
 #include <QString>
+#include <QWaitCondition>
 
 namespace Tiled {
 
@@ -72,18 +75,35 @@ struct CutTiles;
 struct LoadedPixmap;
 class Map;
 
+/**
+ * Caches loaded images, pixmaps and tiles cut from tilesheets. The cache can
+ * be used from any thread.
+ *
+ * Images can be preloaded on a thread pool, so that several images can be
+ * decoded in parallel while other work is being done. Loading an image that
+ * is still being decoded waits for it instead of decoding it again.
+ */
 class TILEDSHARED_EXPORT ImageCache
 {
 public:
     static LoadedImage loadImage(const QString &fileName);
+    static void preloadImage(const QString &fileName);
     static QPixmap loadPixmap(const QString &fileName);
     static QVector<QPixmap> cutTiles(const TilesheetParameters &parameters);
 
     static void remove(const QString &fileName);
 
 private:
+    class PreloadRunnable;
+
+    static LoadedImage loadImageImpl(const QString &fileName, bool renderMaps);
+    static void removeLocked(const QString &fileName);
     static QImage renderMap(const QString &fileName);
 
+    static QMutex sMutex;
+    static QWaitCondition sImageLoaded;
+    static QSet<QString> sLoadingImages;
+
     static QHash<QString, LoadedImage> sLoadedImages;
     static QHash<QString, LoadedPixmap> sLoadedPixmaps;
     static QHash<TilesheetParameters, CutTiles> sCutTiles;
@@ -15,6 +15,7 @@ SOURCES += $$PWD/compression.cpp \
     $$PWD/logginginterface.cpp \
     $$PWD/map.cpp \
     $$PWD/mapformat.cpp \
+    $$PWD/mapimagerenderer.cpp \
     $$PWD/mapobject.cpp \
     $$PWD/mapreader.cpp \
     $$PWD/maprenderer.cpp \
@@ -38,6 +39,7 @@ SOURCES += $$PWD/compression.cpp \
     $$PWD/tileanimationdriver.cpp \
     $$PWD/tiled.cpp \
     $$PWD/tilelayer.cpp \
+    $$PWD/tileregion.cpp \
     $$PWD/tileset.cpp \
     $$PWD/tilesetformat.cpp \
     $$PWD/tilesetmanager.cpp \
@@ -61,12 +63,14 @@ HEADERS += $$PWD/compression.h \
     $$PWD/logginginterface.h \
     $$PWD/map.h \
     $$PWD/mapformat.h \
+    $$PWD/mapimagerenderer.h \
     $$PWD/mapobject.h \
     $$PWD/mapreader.h \
     $$PWD/maprenderer.h \
     $$PWD/maptovariantconverter.h \
     $$PWD/mapwriter.h \
     $$PWD/minimaprenderer.h \
+    $$PWD/numberformat.h \
     $$PWD/object.h \
     $$PWD/objectgroup.h \
     $$PWD/objecttemplate.h \
@@ -85,6 +89,7 @@ HEADERS += $$PWD/compression.h \
     $$PWD/tiled.h \
     $$PWD/tiled_global.h \
     $$PWD/tilelayer.h \
+    $$PWD/tileregion.h \
     $$PWD/tileset.h \
     $$PWD/tilesetformat.h \
     $$PWD/tilesetmanager.h \
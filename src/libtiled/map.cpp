@@ -396,7 +396,7 @@ void Map::normalizeTileLayerPositionsAndMapSize()
 
     QRect contentRect;
     while (auto tileLayer = static_cast<TileLayer*>(it.next()))
-        contentRect |= tileLayer->region().boundingRect();
+        contentRect |= tileLayer->tileBounds();
 
     if (!contentRect.topLeft().isNull()) {
         it.toFront();
@@ -467,11 +467,11 @@ MapObject *Map::findObjectById(int objectId) const
 
 QRegion Map::tileRegion() const
 {
-    QRegion region;
+    TileRegion region;
     LayerIterator it(this, Layer::TileLayerType);
     while (auto tileLayer = static_cast<TileLayer*>(it.next()))
-        region |= tileLayer->region();
-    return region;
+        region |= tileLayer->tileRegion();
+    return region.toRegion();
 }
 
 QString Tiled::staggerAxisToString(Map::StaggerAxis staggerAxis)
@@ -0,0 +1,339 @@
+/*
+ * mapimagerenderer.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mapimagerenderer.h"
+
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "maprenderer.h"
+#include "objectgroup.h"
+#include "tile.h"
+#include "tilelayer.h"
+
+#include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Tiled;
+
+// The amount of memory used for keeping downscaled tile images, in KB
+static constexpr int DefaultCacheSize = 64 * 1024;
+
+// The maximum level of detail, at which tile images are scaled down 16 times
+static constexpr int MaxLevelOfDetail = 4;
+
+namespace {
+
+class BandRunnable : public QRunnable
+{
+public:
+    explicit BandRunnable(std::function<void ()> function)
+        : mFunction(std::move(function))
+    {}
+
+    void run() override { mFunction(); }
+
+private:
+    std::function<void ()> mFunction;
+};
+
+} // anonymous namespace
+
+MapImageRenderer::MapImageRenderer()
+    : mScaledImages(DefaultCacheSize)
+{
+}
+
+MapImageRenderer::~MapImageRenderer()
+{
+}
+
+/**
+ * Sets the maximum amount of memory used for keeping the downscaled tile
+ * images between calls to render().
+ */
+void MapImageRenderer::setMaxCacheSize(int kiloBytes)
+{
+    QMutexLocker locker(&mMutex);
+    mScaledImages.setMaxCost(kiloBytes);
+}
+
+void MapImageRenderer::clearCache()
+{
+    QMutexLocker locker(&mMutex);
+    mScaledImages.clear();
+}
+
+/**
+ * Returns the area covered by the given \a map, in pixels, including the
+ * offsets of its layers.
+ */
+QRectF MapImageRenderer::mapBoundingRect(const Map *map)
+{
+    const auto renderer = MapRenderer::create(map);
+    const QMargins margins = map->computeLayerOffsetMargins();
+
+    return QRectF(renderer->mapBoundingRect()).adjusted(-margins.left(),
+                                                        -margins.top(),
+                                                        margins.right(),
+                                                        margins.bottom());
+}
+
+/**
+ * Renders the given \a map into the \a image, according to the given
+ * \a options. The image should have a format that can be painted on, like
+ * QImage::Format_ARGB32_Premultiplied.
+ */
+void MapImageRenderer::render(const Map *map, QImage &image, const Options &options) const
+{
+    if (!map || image.isNull())
+        return;
+
+    const QRectF sourceRect = options.sourceRect.isNull() ? mapBoundingRect(map)
+                                                          : options.sourceRect;
+    if (sourceRect.isEmpty())
+        return;
+
+    qreal scale = options.scale;
+    QPointF origin;
+
+    if (scale <= 0) {
+        scale = qMin(image.width() / sourceRect.width(),
+                     image.height() / sourceRect.height());
+
+        // Center the map in the image
+        origin = QPointF((image.width() - sourceRect.width() * scale) / 2,
+                         (image.height() - sourceRect.height() * scale) / 2);
+    }
+
+    QTransform transform;
+    transform.translate(origin.x(), origin.y());
+    transform.scale(scale, scale);
+    transform.translate(-sourceRect.x(), -sourceRect.y());
+
+    if (options.flags.testFlag(DrawBackground) && map->backgroundColor().isValid())
+        image.fill(map->backgroundColor());
+    else
+        image.fill(Qt::transparent);
+
+    int levelOfDetail = 0;
+    if (options.flags.testFlag(UseLevelOfDetail) && scale <= 0.5)
+        levelOfDetail = qMin(MaxLevelOfDetail, qFloor(std::log2(1.0 / scale)));
+
+    const int threadCount = qBound(1, options.threadCount, image.height());
+    if (threadCount == 1) {
+        renderBand(map, image, transform, scale, levelOfDetail, options);
+        return;
+    }
+
+    // Lazily loaded chunks are decoded up front, so that the bands only read
+    // the tile layers
+    for (const Layer *layer : map->tileLayers())
+        static_cast<const TileLayer*>(layer)->decodeAllChunks();
+
+    // Each band is a separate image referring to rows of the target image,
+    // since an image can only be painted on by one painter at a time.
+    const int bandHeight = (image.height() + threadCount - 1) / threadCount;
+    const int bytesPerLine = image.bytesPerLine();
+    uchar *bits = image.bits();
+
+    std::vector<QImage> bands;
+    std::vector<QTransform> bandTransforms;
+
+    for (int top = 0; top < image.height(); top += bandHeight) {
+        const int height = qMin(bandHeight, image.height() - top);
+        bands.emplace_back(bits + top * bytesPerLine, image.width(), height,
+                           bytesPerLine, image.format());
+        bandTransforms.push_back(transform * QTransform::fromTranslate(0, -top));
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount - 1);
+
+    for (size_t i = 1; i < bands.size(); ++i) {
+        QImage &band = bands[i];
+        const QTransform &bandTransform = bandTransforms[i];
+
+        threadPool.start(new BandRunnable([=, &band, &bandTransform, &options] {
+            renderBand(map, band, bandTransform, scale, levelOfDetail, options);
+        }));
+    }
+
+    renderBand(map, bands.front(), bandTransforms.front(), scale, levelOfDetail, options);
+
+    threadPool.waitForDone();
+}
+
+void MapImageRenderer::renderBand(const Map *map,
+                                  QImage &band,
+                                  const QTransform &transform,
+                                  qreal scale,
+                                  int levelOfDetail,
+                                  const Options &options) const
+{
+    const auto renderer = MapRenderer::create(map);
+    renderer->setFlag(ShowTileAnimations, options.flags.testFlag(DrawAnimationFrames));
+    renderer->setPainterScale(scale);
+
+    if (levelOfDetail > 0) {
+        renderer->setTileImageCallback([this, levelOfDetail] (const Tile *tile) {
+            return scaledTileImage(tile, levelOfDetail);
+        });
+    }
+
+    QPainter painter(&band);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, options.flags.testFlag(SmoothPixmapTransform));
+    painter.setRenderHint(QPainter::Antialiasing, options.flags.testFlag(Antialiasing));
+    painter.setTransform(transform);
+
+    const QRectF exposed = transform.inverted().mapRect(QRectF(band.rect()));
+    drawLayers(painter, *renderer, options, exposed);
+}
+
+/**
+ * Returns the image of the given \a tile, scaled down by a factor of two
+ * for each level of detail. The scaled images are cached based on the
+ * original image, so they are shared between tilesets using the same image.
+ */
+QPixmap MapImageRenderer::scaledTileImage(const Tile *tile, int levelOfDetail) const
+{
+    const QPixmap &image = tile->image();
+    const ScaledImageKey key(image.cacheKey(), levelOfDetail);
+
+    {
+        QMutexLocker locker(&mMutex);
+        if (const QPixmap *scaled = mScaledImages.object(key))
+            return *scaled;
+    }
+
+    const QSize size = (image.size() / (1 << levelOfDetail)).expandedTo(QSize(1, 1));
+    const QPixmap scaled = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    QMutexLocker locker(&mMutex);
+    mScaledImages.insert(key, new QPixmap(scaled),
+                         qMax(1, scaled.width() * scaled.height() * 4 / 1024));
+
+    return scaled;
+}
+
+static bool objectLessThan(const MapObject *a, const MapObject *b)
+{
+    return a->y() < b->y();
+}
+
+/**
+ * Draws the layers of the map of the given \a renderer, as enabled by the
+ * given \a options.
+ *
+ * Only the parts of the layers in the \a exposed area are drawn, when given.
+ */
+void MapImageRenderer::drawLayers(QPainter &painter,
+                                  const MapRenderer &renderer,
+                                  const Options &options,
+                                  const QRectF &exposed)
+{
+    const bool drawTileLayers = options.flags.testFlag(DrawTileLayers);
+    const bool drawObjects = options.flags.testFlag(DrawMapObjects);
+    const bool drawImageLayers = options.flags.testFlag(DrawImageLayers);
+    const bool includeHiddenLayers = options.flags.testFlag(IncludeHiddenLayers);
+
+    LayerIterator iterator(renderer.map());
+    while (const Layer *layer = iterator.next()) {
+        // Recursion handled by LayerIterator
+        if (layer->isGroupLayer())
+            continue;
+        if (!includeHiddenLayers && layer->isHidden())
+            continue;
+        if (options.layerFilter && !options.layerFilter(layer))
+            continue;
+
+        const auto offset = layer->totalOffset();
+        const QRectF layerExposed = exposed.isNull() ? exposed : exposed.translated(-offset);
+
+        painter.setOpacity(layer->effectiveOpacity());
+        painter.translate(offset);
+
+        switch (layer->layerType()) {
+        case Layer::TileLayerType: {
+            if (drawTileLayers) {
+                const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
+                renderer.drawTileLayer(&painter, tileLayer, layerExposed);
+            }
+            break;
+        }
+
+        case Layer::ObjectGroupType: {
+            if (drawObjects) {
+                const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+                QList<MapObject*> objects = objectGroup->objects();
+
+                if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
+                    std::stable_sort(objects.begin(), objects.end(), objectLessThan);
+
+                for (const MapObject *object : qAsConst(objects)) {
+                    if (object->isVisible()) {
+                        if (object->rotation() != qreal(0)) {
+                            QPointF origin = renderer.pixelToScreenCoords(object->position());
+                            painter.save();
+                            painter.translate(origin);
+                            painter.rotate(object->rotation());
+                            painter.translate(-origin);
+                        }
+
+                        const QColor color = object->effectiveColor();
+                        renderer.drawMapObject(&painter, object, color);
+
+                        if (object->rotation() != qreal(0))
+                            painter.restore();
+                    }
+                }
+            }
+            break;
+        }
+
+        case Layer::ImageLayerType: {
+            if (drawImageLayers) {
+                const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
+                renderer.drawImageLayer(&painter, imageLayer, layerExposed);
+            }
+            break;
+        }
+
+        case Layer::GroupLayerType:
+            break;
+        }
+
+        painter.translate(-offset);
+    }
+}
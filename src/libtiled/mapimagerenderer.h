@@ -0,0 +1,146 @@
+/*
+ * mapimagerenderer.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QPair>
+#include <QPixmap>
+#include <QRectF>
+
+#include <functional>
+
+class QPainter;
+
+namespace Tiled {
+
+class Layer;
+class Map;
+class MapRenderer;
+class Tile;
+
+/**
+ * Renders maps into images, for example to generate thumbnails.
+ *
+ * The rendering matches the way maps are displayed in the editor. Downscaled
+ * versions of the tile images are used when rendering at small scales, and
+ * these are kept between calls so that rendering many maps sharing the same
+ * tilesets is efficient. It is safe to call render() from multiple threads
+ * at the same time.
+ */
+class TILEDSHARED_EXPORT MapImageRenderer
+{
+public:
+    using LayerFilter = std::function<bool (const Layer *layer)>;
+
+    enum RenderFlag {
+        DrawTileLayers          = 0x0001,
+        DrawMapObjects          = 0x0002,
+        DrawImageLayers         = 0x0004,
+        DrawAllLayers           = DrawTileLayers | DrawMapObjects | DrawImageLayers,
+        IncludeHiddenLayers     = 0x0008,
+        DrawBackground          = 0x0010,
+        SmoothPixmapTransform   = 0x0020,
+        Antialiasing            = 0x0040,
+        DrawAnimationFrames     = 0x0080,
+        UseLevelOfDetail        = 0x0100,
+    };
+
+    Q_DECLARE_FLAGS(RenderFlags, RenderFlag)
+
+    struct Options
+    {
+        /**
+         * The area of the map to render, in pixels. When null, the whole map
+         * is rendered (see mapBoundingRect()).
+         */
+        QRectF sourceRect;
+
+        /**
+         * The scale at which to render, with the source rect starting at the
+         * top-left of the image. When 0, the source rect is scaled to fit
+         * the image and centered.
+         */
+        qreal scale = 0;
+
+        RenderFlags flags = DrawAllLayers | SmoothPixmapTransform | UseLevelOfDetail;
+
+        /**
+         * When set, only the layers for which this function returns true
+         * are rendered. Group layers are not passed to the filter.
+         */
+        LayerFilter layerFilter;
+
+        /**
+         * The number of threads used for rendering. The image is divided in
+         * horizontal bands, each painted by a different thread.
+         *
+         * This requires pixmaps to be usable outside of the GUI thread, which
+         * is the case for the raster-based platforms like "offscreen".
+         */
+        int threadCount = 1;
+    };
+
+    MapImageRenderer();
+    ~MapImageRenderer();
+
+    void render(const Map *map, QImage &image, const Options &options) const;
+
+    void setMaxCacheSize(int kiloBytes);
+    void clearCache();
+
+    static QRectF mapBoundingRect(const Map *map);
+
+    static void drawLayers(QPainter &painter,
+                           const MapRenderer &renderer,
+                           const Options &options,
+                           const QRectF &exposed = QRectF());
+
+private:
+    void renderBand(const Map *map,
+                    QImage &band,
+                    const QTransform &transform,
+                    qreal scale,
+                    int levelOfDetail,
+                    const Options &options) const;
+
+    QPixmap scaledTileImage(const Tile *tile, int levelOfDetail) const;
+
+    using ScaledImageKey = QPair<qint64, int>;
+
+    mutable QMutex mMutex;
+    mutable QCache<ScaledImageKey, QPixmap> mScaledImages;
+};
+
+} // namespace Tiled
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(Tiled::MapImageRenderer::RenderFlags)
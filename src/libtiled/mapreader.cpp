@@ -33,11 +33,13 @@
 #include "compression.h"
 #include "gidmapper.h"
 #include "grouplayer.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "map.h"
 #include "mapobject.h"
+#include "numberformat.h"
 #include "templatemanager.h"
 #include "tile.h"
 #include "tilelayer.h"
@@ -86,6 +88,9 @@ private:
     void readMapEditorSettings(Map &map);
 
     SharedTileset readTileset();
+    SharedTileset readExternalTileset(const QString &source);
+    void queueExternalTileset();
+    void loadExternalTilesets();
     void readTilesetEditorSettings(Tileset &tileset);
     void readTilesetTile(Tileset &tileset);
     void readTilesetGrid(Tileset &tileset);
@@ -112,6 +117,15 @@ private:
     void decodeCSVLayerData(TileLayer &tileLayer,
                             QStringRef text,
                             QRect bounds);
+    void readEncodedChunk(TileLayer &tileLayer,
+                          Map::LayerDataFormat format,
+                          QRect bounds);
+
+    template<typename Callback>
+    bool readCSVGids(const TileLayer &tileLayer,
+                     QStringRef text,
+                     QRect bounds,
+                     Callback callback);
 
     /**
      * Returns the cell for the given global tile ID. Errors are raised with
@@ -144,8 +158,16 @@ private:
     QDir mPath;
     std::unique_ptr<Map> mMap;
     GidMapper mGidMapper;
+    QSharedPointer<const GidMapper> mLazyGidMapper;
     bool mReadingExternalTileset;
 
+    struct ExternalTilesetReference
+    {
+        QString source;
+        unsigned firstGid;
+    };
+    QVector<ExternalTilesetReference> mExternalTilesets;
+
     QXmlStreamReader xml;
 };
 
@@ -167,6 +189,8 @@ std::unique_ptr<Map> MapReaderPrivate::readMap(QIODevice *device, const QString
     }
 
     mGidMapper.clear();
+    mLazyGidMapper.reset();
+    mExternalTilesets.clear();
     return map;
 }
 
@@ -296,6 +320,16 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
         mMap->setNextObjectId(nextObjectId);
 
     while (xml.readNextStartElement()) {
+        // Consecutive external tilesets are loaded together, so that their
+        // images can be decoded in parallel
+        if (xml.name() == QLatin1String("tileset") &&
+                !xml.attributes().value(QLatin1String("source")).isEmpty()) {
+            queueExternalTileset();
+            continue;
+        }
+
+        loadExternalTilesets();
+
         if (xml.name() == QLatin1String("editorsettings"))
             readMapEditorSettings(*mMap);
         else if (std::unique_ptr<Layer> layer = tryReadLayer())
@@ -308,6 +342,8 @@ std::unique_ptr<Map> MapReaderPrivate::readMap()
             readUnknownElement();
     }
 
+    loadExternalTilesets();
+
     // Clean up in case of error
     if (xml.hasError()) {
         mMap.reset();
@@ -445,26 +481,106 @@ SharedTileset MapReaderPrivate::readTileset()
             }
         }
     } else { // External tileset
-        const QString absoluteSource = p->resolveReference(source, mPath);
-        QString error;
-        tileset = p->readExternalTileset(absoluteSource, &error);
-
-        if (!tileset) {
-            // Insert a placeholder to allow the map to load
-            tileset = Tileset::create(QFileInfo(absoluteSource).completeBaseName(), 32, 32);
-            tileset->setFileName(absoluteSource);
-            tileset->setStatus(LoadingError);
-        }
-
+        tileset = readExternalTileset(p->resolveReference(source, mPath));
         xml.skipCurrentElement();
     }
 
-    if (tileset && !mReadingExternalTileset)
+    if (tileset && !mReadingExternalTileset) {
         mGidMapper.insert(firstGid, tileset);
+        mLazyGidMapper.reset();
+    }
 
     return tileset;
 }
 
+SharedTileset MapReaderPrivate::readExternalTileset(const QString &source)
+{
+    QString error;
+    SharedTileset tileset = p->readExternalTileset(source, &error);
+
+    if (!tileset) {
+        // Insert a placeholder to allow the map to load
+        tileset = Tileset::create(QFileInfo(source).completeBaseName(), 32, 32);
+        tileset->setFileName(source);
+        tileset->setStatus(LoadingError);
+    }
+
+    return tileset;
+}
+
+/**
+ * Returns the image file used by the given tileset file, by reading only the
+ * start of the file. Returns an empty string when the tileset is not a TSX
+ * file or is not based on a single image.
+ */
+static QString tilesetImageFileName(const QString &tilesetFileName)
+{
+    QFile file(tilesetFileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+        return QString();
+
+    QXmlStreamReader xml(&file);
+    if (!xml.readNextStartElement() || xml.name() != QLatin1String("tileset"))
+        return QString();
+
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("image")) {
+            const QString source = xml.attributes().value(QLatin1String("source")).toString();
+            if (source.isEmpty())
+                return QString();
+
+            const QString path = QFileInfo(tilesetFileName).path();
+            return Tiled::urlToLocalFileOrQrc(toUrl(source, path));
+        }
+
+        // The tileset image is written before the tiles
+        if (xml.name() == QLatin1String("tile"))
+            return QString();
+
+        xml.skipCurrentElement();
+    }
+
+    return QString();
+}
+
+/**
+ * Remembers the external tileset referenced by the current element, to be
+ * loaded by loadExternalTilesets(). Its image is already preloaded.
+ */
+void MapReaderPrivate::queueExternalTileset()
+{
+    Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("tileset"));
+
+    const QXmlStreamAttributes atts = xml.attributes();
+    const QString source = atts.value(QLatin1String("source")).toString();
+    const unsigned firstGid = atts.value(QLatin1String("firstgid")).toUInt();
+    const QString absoluteSource = p->resolveReference(source, mPath);
+
+    ImageCache::preloadImage(tilesetImageFileName(absoluteSource));
+    mExternalTilesets.append({ absoluteSource, firstGid });
+
+    xml.skipCurrentElement();
+}
+
+/**
+ * Loads the queued external tilesets and adds them to the map, in the order
+ * in which they were referenced.
+ */
+void MapReaderPrivate::loadExternalTilesets()
+{
+    if (mExternalTilesets.isEmpty())
+        return;
+
+    for (const ExternalTilesetReference &reference : qAsConst(mExternalTilesets)) {
+        SharedTileset tileset = readExternalTileset(reference.source);
+        mGidMapper.insert(reference.firstGid, tileset);
+        mMap->addTileset(tileset);
+    }
+
+    mLazyGidMapper.reset();
+    mExternalTilesets.clear();
+}
+
 void MapReaderPrivate::readTilesetEditorSettings(Tileset &tileset)
 {
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("editorsettings"));
@@ -631,6 +747,9 @@ void MapReaderPrivate::readTilesetImage(Tileset &tileset)
     Q_ASSERT(xml.isStartElement() && xml.name() == QLatin1String("image"));
 
     tileset.setImageReference(readImage());
+
+    // Start decoding the image, which is needed once the tileset is loaded
+    ImageCache::preloadImage(Tiled::urlToLocalFileOrQrc(tileset.imageSource()));
 }
 
 ImageReference MapReaderPrivate::readImage()
@@ -967,6 +1086,13 @@ void MapReaderPrivate::readTileLayerRect(TileLayer &tileLayer,
     int x = bounds.x();
     int y = bounds.y();
 
+    // Chunks matching the native chunk size can be decoded on demand
+    const bool readLazily = MapReader::lazyChunkLoadingEnabled() &&
+            xml.name() == QLatin1String("chunk") &&
+            layerDataFormat != Map::XML &&
+            bounds.width() == CHUNK_SIZE && bounds.height() == CHUNK_SIZE &&
+            (bounds.x() & CHUNK_MASK) == 0 && (bounds.y() & CHUNK_MASK) == 0;
+
     while (xml.readNext() != QXmlStreamReader::Invalid) {
         if (xml.isEndElement()) {
             break;
@@ -1002,7 +1128,9 @@ void MapReaderPrivate::readTileLayerRect(TileLayer &tileLayer,
                 readUnknownElement();
             }
         } else if (xml.isCharacters() && !xml.isWhitespace()) {
-            if (encoding == QLatin1String("base64")) {
+            if (readLazily) {
+                readEncodedChunk(tileLayer, layerDataFormat, bounds);
+            } else if (encoding == QLatin1String("base64")) {
                 decodeBinaryLayerData(tileLayer,
                                       xml.text().toLatin1(),
                                       layerDataFormat,
@@ -1038,50 +1166,115 @@ void MapReaderPrivate::decodeBinaryLayerData(TileLayer &tileLayer,
     }
 }
 
-void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
-                                          QStringRef text,
-                                          QRect bounds)
+/**
+ * Parses the CSV encoded tile data in \a text, calling \a callback with the
+ * coordinates and the global tile ID of each tile in \a bounds. Returns
+ * false and raises an error when the data could not be parsed.
+ */
+template<typename Callback>
+bool MapReaderPrivate::readCSVGids(const TileLayer &tileLayer,
+                                   QStringRef text,
+                                   QRect bounds,
+                                   Callback callback)
 {
-    int currentIndex = 0;
+    // Parse directly from the UTF-16 data, avoiding QChar::digitValue and
+    // QChar::isSpace for the common characters
+    const QChar *current = text.constData();
+    const QChar *const end = current + text.length();
 
     for (int y = bounds.top(); y <= bounds.bottom(); y++) {
         for (int x = bounds.left(); x <= bounds.right(); x++) {
             // Check if the stream ended early.
-            if (currentIndex >= text.length()) {
+            if (current == end) {
                 xml.raiseError(tr("Corrupt layer data for layer '%1'")
                                .arg(tileLayer.name()));
-                return;
+                return false;
             }
 
             // Get the next entry.
-            unsigned int gid = 0;
-            while (currentIndex < text.length()) {
-                auto currentChar = text.at(currentIndex);
-                currentIndex++;
+            unsigned gid = 0;
+            while (current != end) {
+                const QChar currentChar = *current++;
+                const unsigned value = decimalDigitValue(currentChar.unicode());
+                if (value < 10) {
+                    gid = gid * 10 + value;
+                    continue;
+                }
                 if (currentChar == QLatin1Char(','))
                     break;
-                if (currentChar.isSpace())
+                if (currentChar == QLatin1Char('\n') || currentChar == QLatin1Char(' ') || currentChar.isSpace())
                     continue;
-                int value = currentChar.digitValue();
-                if (value != -1)
-                    gid = gid * 10 + value;
-                else {
-                    xml.raiseError(
-                            tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
-                                   .arg(x + 1).arg(y + 1).arg(tileLayer.name()).arg(currentChar));
-                    return;
-                }
+
+                xml.raiseError(
+                        tr("Unable to parse tile at (%1,%2) on layer '%3': \"%4\"")
+                               .arg(x + 1).arg(y + 1).arg(tileLayer.name()).arg(currentChar));
+                return false;
             }
 
-            tileLayer.setCell(x, y, cellForGid(gid));
+            callback(x, y, gid);
         }
     }
-    if (currentIndex < text.length()) {
+    if (current != end) {
         // We didn't consume all the data.
         xml.raiseError(tr("Corrupt layer data for layer '%1'")
                        .arg(tileLayer.name()));
-        return;
+        return false;
     }
+
+    return true;
+}
+
+void MapReaderPrivate::decodeCSVLayerData(TileLayer &tileLayer,
+                                          QStringRef text,
+                                          QRect bounds)
+{
+    readCSVGids(tileLayer, text, bounds, [&] (int x, int y, unsigned gid) {
+        tileLayer.setCell(x, y, cellForGid(gid));
+    });
+}
+
+/**
+ * Stores the data of the current chunk in its encoded form, so that it only
+ * needs to be decoded once it is accessed.
+ */
+void MapReaderPrivate::readEncodedChunk(TileLayer &tileLayer,
+                                        Map::LayerDataFormat format,
+                                        QRect bounds)
+{
+    auto encoded = QSharedPointer<EncodedChunk>::create();
+
+    if (format == Map::CSV) {
+        // The text is parsed right away, keeping the binary tile data
+        QByteArray data;
+        data.reserve(CHUNK_SIZE * CHUNK_SIZE * 4);
+
+        const bool ok = readCSVGids(tileLayer, xml.text(), bounds, [&] (int, int, unsigned gid) {
+            cellForGid(gid);    // validates the gid
+            data.append(static_cast<char>(gid));
+            data.append(static_cast<char>(gid >> 8));
+            data.append(static_cast<char>(gid >> 16));
+            data.append(static_cast<char>(gid >> 24));
+        });
+        if (!ok)
+            return;
+
+        encoded->data = data;
+        encoded->format = Map::Base64;
+    } else {
+        encoded->data = QByteArray::fromBase64(xml.text().toLatin1());
+        encoded->format = format;
+
+        if (format == Map::Base64 && encoded->data.size() != CHUNK_SIZE * CHUNK_SIZE * 4) {
+            xml.raiseError(tr("Corrupt layer data for layer '%1'").arg(tileLayer.name()));
+            return;
+        }
+    }
+
+    if (!mLazyGidMapper)
+        mLazyGidMapper = QSharedPointer<GidMapper>::create(mGidMapper);
+
+    encoded->gidMapper = mLazyGidMapper;
+    tileLayer.setEncodedChunk(bounds.x(), bounds.y(), encoded);
 }
 
 Cell MapReaderPrivate::cellForGid(unsigned gid)
@@ -1532,6 +1725,18 @@ QString MapReader::errorString() const
     return d->errorString();
 }
 
+std::atomic<bool> MapReader::mLazyChunkLoadingEnabled { false };
+
+bool MapReader::lazyChunkLoadingEnabled()
+{
+    return mLazyChunkLoadingEnabled;
+}
+
+void MapReader::setLazyChunkLoadingEnabled(bool enabled)
+{
+    mLazyChunkLoadingEnabled = enabled;
+}
+
 QString MapReader::resolveReference(const QString &reference,
                                     const QDir &mapDir)
 {
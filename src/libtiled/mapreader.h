@@ -34,6 +34,8 @@
 
 #include <QImage>
 
+#include <atomic>
+
 class QFile;
 
 namespace Tiled {
@@ -98,6 +100,15 @@ public:
     std::unique_ptr<ObjectTemplate> readObjectTemplate(QIODevice *device, const QString &path = QString());
     std::unique_ptr<ObjectTemplate> readObjectTemplate(const QString &fileName);
 
+    /**
+     * Returns whether chunks of infinite maps are kept in their encoded
+     * form while reading, to be decoded only when they are first accessed.
+     *
+     * \sa TileLayer::unloadColdChunks()
+     */
+    static bool lazyChunkLoadingEnabled();
+    static void setLazyChunkLoadingEnabled(bool enabled);
+
 protected:
     /**
      * Called for each \a reference to an external file. Should return the path
@@ -122,6 +133,8 @@ private:
 
     friend class Internal::MapReaderPrivate;
     Internal::MapReaderPrivate *d;
+
+    static std::atomic<bool> mLazyChunkLoadingEnabled;
 };
 
 } // namespace Tiled
@@ -240,6 +240,18 @@ void MapRenderer::setFlag(RenderFlag flag, bool enabled)
     mFlags.setFlag(flag, enabled);
 }
 
+/**
+ * Returns the image to draw for the given \a tile.
+ *
+ * @see setTileImageCallback
+ */
+QPixmap MapRenderer::tileImage(const Tile *tile) const
+{
+    if (mTileImageCallback)
+        return mTileImageCallback(tile);
+    return tile->image();
+}
+
 /**
  * Converts a line running from \a start to \a end to a polygon which
  * extends 5 pixels from the line in all directions.
@@ -357,12 +369,10 @@ CellRenderer::CellRenderer(QPainter *painter, const MapRenderer *renderer, const
  */
 void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSizeF &size, Origin origin)
 {
-    const Tile *tile = cell.tile();
+    const CachedTile &drawable = drawableTile(cell);
+    const Tile *tile = drawable.tile;
 
-    if (tile && mRenderer->testFlag(ShowTileAnimations))
-        tile = tile->currentFrameTile();
-
-    if (!tile || tile->image().isNull()) {
+    if (!tile) {
         QRectF target { screenPos, size };
 
         if (origin == BottomLeft)
@@ -377,13 +387,17 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     if (mTile != tile || mFragments.size() == USHRT_MAX)
         flush();
 
-    const QPixmap &image = tile->image();
+    // The image may be a downscaled version of the tile image, in which case
+    // the tile offset still needs to be scaled based on the tile size.
+    const QPixmap &image = drawable.image;
     const QSizeF imageSize = image.size();
-    if (imageSize.isEmpty())
+    const QSizeF tileSize = tile->size();
+    if (imageSize.isEmpty() || tileSize.isEmpty())
         return;
 
     const QSizeF scale(size.width() / imageSize.width(), size.height() / imageSize.height());
     const QPoint offset = tile->offset();
+    const QPointF offsetScale(size.width() / tileSize.width(), size.height() / tileSize.height());
     const QPointF sizeHalf = QPointF(size.width() / 2, size.height() / 2);
 
     bool flippedHorizontally = cell.flippedHorizontally();
@@ -391,8 +405,8 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
 
     QPainter::PixmapFragment fragment;
     // Calculate the position as if the origin is TopLeft, and correct it later.
-    fragment.x = screenPos.x() + (offset.x() * scale.width()) + sizeHalf.x();
-    fragment.y = screenPos.y() + (offset.y() * scale.height()) + sizeHalf.y();
+    fragment.x = screenPos.x() + (offset.x() * offsetScale.x()) + sizeHalf.x();
+    fragment.y = screenPos.y() + (offset.y() * offsetScale.y()) + sizeHalf.y();
     fragment.sourceLeft = 0;
     fragment.sourceTop = 0;
     fragment.width = imageSize.width();
@@ -430,7 +444,10 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     fragment.scaleY = scale.height() * (flippedVertically ? -1 : 1);
 
     if (mIsOpenGL || (fragment.scaleX > 0 && fragment.scaleY > 0)) {
-        mTile = tile;
+        if (mTile != tile) {
+            mTile = tile;
+            mImage = image;
+        }
         mFragments.append(fragment);
         return;
     }
@@ -466,6 +483,40 @@ void CellRenderer::render(const Cell &cell, const QPointF &screenPos, const QSiz
     }
 }
 
+/**
+ * Returns the tile that should be drawn for the given \a cell, which is the
+ * current frame of animated tiles when animations are shown, along with the
+ * image to draw for it. The tile is nullptr when there is no image to draw.
+ */
+const CellRenderer::CachedTile &CellRenderer::drawableTile(const Cell &cell)
+{
+    const Tileset *tileset = cell.tileset();
+    const int tileId = cell.tileId();
+
+    const quintptr hash = (reinterpret_cast<quintptr>(tileset) >> 4) ^ static_cast<quintptr>(tileId);
+    CachedTile &cached = mTileCache[hash % mTileCache.size()];
+
+    if (cached.tileset != tileset || cached.tileId != tileId) {
+        const Tile *tile = cell.tile();
+
+        if (tile && mRenderer->testFlag(ShowTileAnimations))
+            tile = tile->currentFrameTile();
+
+        QPixmap image;
+        if (tile && !tile->image().isNull())
+            image = mRenderer->tileImage(tile);
+        if (image.isNull())
+            tile = nullptr;
+
+        cached.tileset = tileset;
+        cached.tileId = tileId;
+        cached.tile = tile;
+        cached.image = image;
+    }
+
+    return cached;
+}
+
 /**
  * Renders any remaining cells.
  */
@@ -476,7 +527,7 @@ void CellRenderer::flush()
 
     mPainter->drawPixmapFragments(mFragments.constData(),
                                   mFragments.size(),
-                                  tinted(mTile->image(), mTintColor));
+                                  tinted(mImage, mTintColor));
 
     if (mRenderer->flags().testFlag(ShowTileCollisionShapes)
             && mTile->objectGroup()
@@ -485,6 +536,7 @@ void CellRenderer::flush()
     }
 
     mTile = nullptr;
+    mImage = QPixmap();
     mFragments.resize(0);
 }
 
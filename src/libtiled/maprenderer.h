@@ -30,6 +30,7 @@
 
 #include "tiled_global.h"
 
+#include <array>
 #include <functional>
 #include <memory>
 
@@ -44,6 +45,7 @@ class Map;
 class MapObject;
 class Tile;
 class TileLayer;
+class Tileset;
 class ImageLayer;
 
 enum RenderFlag {
@@ -272,6 +274,18 @@ public:
 
     CellType cellType() const { return mCellType; }
 
+    using TileImageCallback = std::function<QPixmap (const Tile *tile)>;
+
+    /**
+     * Sets a callback that provides the image to draw for each tile, for
+     * example to draw downscaled versions of the tile images. By default the
+     * image of the tile itself is drawn.
+     */
+    void setTileImageCallback(const TileImageCallback &callback)
+    { mTileImageCallback = callback; }
+
+    QPixmap tileImage(const Tile *tile) const;
+
     static QPolygonF lineToPolygon(const QPointF &start, const QPointF &end);
 
     static std::unique_ptr<MapRenderer> create(const Map *map);
@@ -290,6 +304,7 @@ private:
     CellType mCellType = OrthogonalCells;
     qreal mObjectLineWidth = 2;
     qreal mPainterScale = 1;
+    TileImageCallback mTileImageCallback;
 };
 
 inline const Map *MapRenderer::map() const
@@ -339,14 +354,31 @@ public:
     void flush();
 
 private:
+    struct CachedTile
+    {
+        const Tileset *tileset = nullptr;
+        int tileId = -1;
+        const Tile *tile = nullptr;
+        QPixmap image;
+    };
+
+    const CachedTile &drawableTile(const Cell &cell);
     void paintTileCollisionShapes();
 
     QPainter * const mPainter;
     const MapRenderer * const mRenderer;
     const Tile *mTile;
+    QPixmap mImage;
     QVector<QPainter::PixmapFragment> mFragments;
     const bool mIsOpenGL;
     const QColor mTintColor;
+
+    /*
+     * Cache of the tiles to draw for recently rendered cells. Since the
+     * CellRenderer only lives while rendering a single frame, the current
+     * animation frames don't change while the entries are in use.
+     */
+    std::array<CachedTile, 64> mTileCache;
 };
 
 } // namespace Tiled
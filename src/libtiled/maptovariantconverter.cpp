@@ -41,6 +41,7 @@ QVariant MapToVariantConverter::toVariant(const Map &map, const QDir &mapDir)
 {
     mDir = mapDir;
     mGidMapper.clear();
+    mError.clear();
 
     QVariantMap mapVariant;
 
@@ -707,6 +708,7 @@ void MapToVariantConverter::addTileLayerData(QVariantMap &variant,
     case Map::XML:
     case Map::CSV: {
         QVariantList tileVariants;
+        tileVariants.reserve(bounds.width() * bounds.height());
         for (int y = bounds.top(); y <= bounds.bottom(); ++y)
             for (int x = bounds.left(); x <= bounds.right(); ++x)
                 tileVariants << mGidMapper.cellToGid(tileLayer.cellAt(x, y));
@@ -718,7 +720,12 @@ void MapToVariantConverter::addTileLayerData(QVariantMap &variant,
     case Map::Base64Zlib:
     case Map::Base64Gzip:
     case Map::Base64Zstandard:{
-        QByteArray layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel);
+        bool ok;
+        QByteArray layerData = mGidMapper.encodeLayerData(tileLayer, format, bounds, compressionLevel, &ok);
+        if (!ok && mError.isEmpty()) {
+            mError = QCoreApplication::translate("File Errors", "Layer '%1' is too large to be saved in this layer format.")
+                    .arg(tileLayer.name());
+        }
         variant[QStringLiteral("data")] = layerData;
         break;
     }
@@ -62,6 +62,12 @@ public:
     QVariant toVariant(const Tileset &tileset, const QDir &directory);
     QVariant toVariant(const ObjectTemplate &objectTemplate, const QDir &directory);
 
+    /**
+     * Returns the error that occurred while converting the last map, in
+     * which case the returned variant is incomplete.
+     */
+    QString errorString() const { return mError; }
+
 private:
     QVariant toVariant(const Tileset &tileset, int firstGid) const;
     QVariant toVariant(const Properties &properties) const;
@@ -90,6 +96,7 @@ private:
     int mVersion;
     QDir mDir;
     GidMapper mGidMapper;
+    mutable QString mError;
 };
 
 } // namespace Tiled
@@ -117,6 +117,7 @@ bool MapWriterPrivate::openFile(SaveFile *file)
 void MapWriterPrivate::writeMap(const Map *map, QIODevice *device,
                                 const QString &path)
 {
+    mError.clear();
     mDir = QDir(path);
     mUseAbsolutePaths = path.isEmpty();
     mLayerDataFormat = map->layerDataFormat();
@@ -602,28 +603,22 @@ void MapWriterPrivate::writeTileLayerData(QXmlStreamWriter &w,
             }
         }
     } else if (mLayerDataFormat == Map::CSV) {
-        QString chunkData;
+        const QByteArray chunkData = mGidMapper.encodeCSVLayerData(tileLayer,
+                                                                   bounds,
+                                                                   !mMinimize);
 
-        if (!mMinimize)
-            chunkData.append(QLatin1Char('\n'));
-
-        for (int y = bounds.top(); y <= bounds.bottom(); y++) {
-            for (int x = bounds.left(); x <= bounds.right(); x++) {
-                const unsigned gid = mGidMapper.cellToGid(tileLayer.cellAt(x, y));
-                chunkData.append(QString::number(gid));
-                if (x != bounds.right() || y != bounds.bottom())
-                    chunkData.append(QLatin1Char(','));
-            }
-            if (!mMinimize)
-                chunkData.append(QLatin1Char('\n'));
-        }
-
-        w.writeCharacters(chunkData);
+        w.writeCharacters(QString::fromLatin1(chunkData));
     } else {
+        bool ok;
         QByteArray chunkData = mGidMapper.encodeLayerData(tileLayer,
                                                           mLayerDataFormat,
                                                           bounds,
-                                                          mCompressionlevel);
+                                                          mCompressionlevel,
+                                                          &ok);
+        if (!ok && mError.isEmpty()) {
+            mError = QCoreApplication::translate("File Errors", "Layer '%1' is too large to be saved in this layer format.")
+                    .arg(tileLayer.name());
+        }
 
         if (!mMinimize)
             w.writeCharacters(QLatin1String("\n   "));
@@ -976,6 +971,10 @@ bool MapWriter::writeMap(const Map *map, const QString &fileName)
 
     writeMap(map, file.device(), QFileInfo(fileName).absolutePath());
 
+    // Don't replace the file with incomplete data
+    if (!d->mError.isEmpty())
+        return false;
+
     if (file.error() != QFileDevice::NoError) {
         d->mError = file.errorString();
         return false;
@@ -30,8 +30,8 @@
 
 #include "minimaprenderer.h"
 
-#include "imagelayer.h"
 #include "map.h"
+#include "mapimagerenderer.h"
 #include "mapobject.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
@@ -71,11 +71,6 @@ QImage MiniMapRenderer::render(QSize size, RenderFlags renderFlags) const
     return image;
 }
 
-static bool objectLessThan(const MapObject *a, const MapObject *b)
-{
-    return a->y() < b->y();
-}
-
 static QRectF cellRect(const MapRenderer &renderer,
                        const Cell &cell,
                        const QPointF &tileCoords)
@@ -172,68 +167,13 @@ void MiniMapRenderer::renderToImage(QImage &image, RenderFlags renderFlags) cons
 
     mRenderer->setPainterScale(scale);
 
-    LayerIterator iterator(mMap);
-    while (const Layer *layer = iterator.next()) {
-        if (visibleLayersOnly && layer->isHidden())
-            continue;
-
-        const auto offset = layer->totalOffset();
-
-        painter.setOpacity(layer->effectiveOpacity());
-        painter.translate(offset);
+    MapImageRenderer::Options options;
+    options.flags.setFlag(MapImageRenderer::DrawTileLayers, drawTileLayers);
+    options.flags.setFlag(MapImageRenderer::DrawMapObjects, drawObjects);
+    options.flags.setFlag(MapImageRenderer::DrawImageLayers, drawImageLayers);
+    options.flags.setFlag(MapImageRenderer::IncludeHiddenLayers, !visibleLayersOnly);
 
-        switch (layer->layerType()) {
-        case Layer::TileLayerType: {
-            if (drawTileLayers) {
-                const TileLayer *tileLayer = static_cast<const TileLayer*>(layer);
-                mRenderer->drawTileLayer(&painter, tileLayer);
-            }
-            break;
-        }
-
-        case Layer::ObjectGroupType: {
-            if (drawObjects) {
-                const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
-                QList<MapObject*> objects = objectGroup->objects();
-
-                if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                    std::stable_sort(objects.begin(), objects.end(), objectLessThan);
-
-                for (const MapObject *object : qAsConst(objects)) {
-                    if (object->isVisible()) {
-                        if (object->rotation() != qreal(0)) {
-                            QPointF origin = mRenderer->pixelToScreenCoords(object->position());
-                            painter.save();
-                            painter.translate(origin);
-                            painter.rotate(object->rotation());
-                            painter.translate(-origin);
-                        }
-
-                        const QColor color = object->effectiveColor();
-                        mRenderer->drawMapObject(&painter, object, color);
-
-                        if (object->rotation() != qreal(0))
-                            painter.restore();
-                    }
-                }
-            }
-            break;
-        }
-        case Layer::ImageLayerType: {
-            if (drawImageLayers) {
-                const ImageLayer *imageLayer = static_cast<const ImageLayer*>(layer);
-                mRenderer->drawImageLayer(&painter, imageLayer);
-            }
-            break;
-        }
-
-        case Layer::GroupLayerType:
-            // Recursion handled by LayerIterator
-            break;
-        }
-
-        painter.translate(-offset);
-    }
+    MapImageRenderer::drawLayers(painter, *mRenderer, options);
 
     if (drawTileGrid)
         mRenderer->drawGrid(&painter, mapBoundingRect, mGridColor);
@@ -0,0 +1,102 @@
+/*
+ * numberformat.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstring>
+
+/*
+ * Fast formatting and parsing of unsigned decimal numbers, used for writing
+ * and reading tile layer data, where QString::number and friends are too slow
+ * due to the allocations involved.
+ */
+
+namespace Tiled {
+
+/**
+ * The maximum number of characters written by formatUnsigned().
+ */
+constexpr int MaxUnsignedDigits = 10;
+
+namespace Internal {
+
+constexpr char DigitPairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+} // namespace Internal
+
+/**
+ * Writes the decimal representation of \a value to \a out, which needs to
+ * have room for at least MaxUnsignedDigits characters. Returns a pointer
+ * just past the last written character.
+ */
+inline char *formatUnsigned(unsigned value, char *out)
+{
+    char buffer[MaxUnsignedDigits];
+    char *p = buffer + MaxUnsignedDigits;
+
+    // Produce two digits at a time, from the back
+    while (value >= 100) {
+        const unsigned index = (value % 100) * 2;
+        value /= 100;
+        *--p = Internal::DigitPairs[index + 1];
+        *--p = Internal::DigitPairs[index];
+    }
+
+    if (value >= 10) {
+        *--p = Internal::DigitPairs[value * 2 + 1];
+        *--p = Internal::DigitPairs[value * 2];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+
+    const int length = static_cast<int>(buffer + MaxUnsignedDigits - p);
+    std::memcpy(out, p, length);
+    return out + length;
+}
+
+/**
+ * Returns the value of the given character when it is a decimal digit, or a
+ * value larger than 9 otherwise. Works for both char and UTF-16 code units.
+ */
+template<typename Char>
+inline unsigned decimalDigitValue(Char c)
+{
+    return static_cast<unsigned>(c) - static_cast<unsigned>('0');
+}
+
+} // namespace Tiled
@@ -123,6 +123,32 @@ void aggregateProperties(AggregatedProperties &aggregated, const Properties &pro
     }
 }
 
+/**
+ * Removes the previously aggregated \a properties from \a aggregated.
+ *
+ * Returns the names of the properties for which the consistency of the
+ * remaining values could not be determined. These need to be aggregated again
+ * from scratch.
+ */
+QStringList deaggregateProperties(AggregatedProperties &aggregated, const Properties &properties)
+{
+    QStringList undetermined;
+
+    for (auto it = properties.constBegin(), end = properties.constEnd(); it != end; ++it) {
+        auto pit = aggregated.find(it.key());
+        if (pit == aggregated.end())
+            continue;
+
+        AggregatedPropertyData &propertyData = pit.value();
+        if (!propertyData.deaggregate(it.value()))
+            undetermined.append(it.key());
+        else if (propertyData.presenceCount() == 0)
+            aggregated.erase(pit);
+    }
+
+    return undetermined;
+}
+
 int propertyValueId()
 {
     return qMetaTypeId<PropertyValue>();
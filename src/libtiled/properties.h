@@ -32,6 +32,7 @@
 
 #include <QJsonArray>
 #include <QObject>
+#include <QStringList>
 #include <QUrl>
 #include <QVariantMap>
 
@@ -119,29 +120,44 @@ public:
     explicit AggregatedPropertyData(const QVariant &value)
         : mValue(value)
         , mPresenceCount(1)
+        , mMatchCount(1)
     {}
 
     void aggregate(const QVariant &value)
     {
-        mValueConsistent &= value == mValue;
+        if (value == mValue)
+            mMatchCount += 1;
         mPresenceCount += 1;
     }
 
+    /**
+     * Removes a previously aggregated \a value. Returns false when the
+     * consistency of the remaining values can't be determined, in which case
+     * they need to be aggregated again.
+     */
+    bool deaggregate(const QVariant &value)
+    {
+        if (value == mValue)
+            mMatchCount -= 1;
+        mPresenceCount -= 1;
+        return mMatchCount > 0 || mPresenceCount == 0;
+    }
+
     const QVariant &value() const { return mValue; }
     int presenceCount() const { return mPresenceCount; }
-    bool valueConsistent() const { return mValueConsistent; }
+    bool valueConsistent() const { return mMatchCount == mPresenceCount; }
 
     bool operator==(const AggregatedPropertyData &other) const
     {
         return mValue == other.mValue &&
                 mPresenceCount == other.mPresenceCount &&
-                mValueConsistent == other.mValueConsistent;
+                valueConsistent() == other.valueConsistent();
     }
 
 private:
     QVariant mValue;
     int mPresenceCount = 0;
-    bool mValueConsistent = true;
+    int mMatchCount = 0;        // number of values equal to mValue
 };
 
 /**
@@ -157,6 +173,7 @@ using Properties = QVariantMap;
 using AggregatedProperties = QMap<QString, AggregatedPropertyData>;
 
 TILEDSHARED_EXPORT void aggregateProperties(AggregatedProperties &aggregated, const Properties &properties);
+TILEDSHARED_EXPORT QStringList deaggregateProperties(AggregatedProperties &aggregated, const Properties &properties);
 TILEDSHARED_EXPORT void mergeProperties(Properties &target, const Properties &source);
 
 TILEDSHARED_EXPORT QJsonArray propertiesToJson(const Properties &properties, const ExportContext &context = ExportContext());
@@ -412,19 +412,23 @@ void PropertyTypes::merge(PropertyTypes typesToMerge)
     for (const auto type : typesToMerge)
         oldTypeIdToName.insert(type->id, type->name);
 
-    while (typesToMerge.count() > 0) {
-        auto typeToImport = typesToMerge.takeAt(0);
-        auto existingIt = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-            return type->name == typeToImport->name;
-        });
+    // Taken from the back, since taking from the front would move all types
+    std::reverse(typesToMerge.mTypes.begin(), typesToMerge.mTypes.end());
+
+    while (!typesToMerge.mTypes.isEmpty()) {
+        std::unique_ptr<PropertyType> typeToImport { typesToMerge.mTypes.takeLast() };
+        PropertyType *existing = mTypesByName.value(typeToImport->name);
 
         if (typeToImport->type == PropertyType::PT_Class)
             classesToProcess.append(static_cast<ClassPropertyType*>(typeToImport.get()));
 
-        if (existingIt != mTypes.end()) {
+        if (existing) {
             // Existing types are replaced, but their ID is retained
-            typeToImport->id = (*existingIt)->id;
-            delete std::exchange(*existingIt, typeToImport.release());
+            typeToImport->id = existing->id;
+            PropertyType *replacement = typeToImport.release();
+            mTypes[mTypes.indexOf(existing)] = replacement;
+            mTypesByName.insert(replacement->name, replacement);
+            delete existing;
         } else {
             // New types are added, but their ID is reset
             typeToImport->id = 0;
@@ -432,6 +436,8 @@ void PropertyTypes::merge(PropertyTypes typesToMerge)
         }
     }
 
+    rebuildIndex();
+
     // Update the type IDs for the class members
     for (auto classType : qAsConst(classesToProcess)) {
         QMutableMapIterator<QString, QVariant> it(classType->members);
@@ -460,10 +466,7 @@ void PropertyTypes::merge(PropertyTypes typesToMerge)
  */
 const PropertyType *PropertyTypes::findTypeById(int typeId) const
 {
-    auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-        return type->id == typeId;
-    });
-    return it == mTypes.end() ? nullptr : *it;
+    return mTypesById.value(typeId);
 }
 
 /**
@@ -472,10 +475,7 @@ const PropertyType *PropertyTypes::findTypeById(int typeId) const
  */
 const PropertyType *PropertyTypes::findTypeByName(const QString &name) const
 {
-    auto it = std::find_if(mTypes.begin(), mTypes.end(), [&] (const PropertyType *type) {
-        return type->name == name;
-    });
-    return it == mTypes.end() ? nullptr : *it;
+    return mTypesByName.value(name);
 }
 
 void PropertyTypes::loadFromJson(const QJsonArray &list, const QString &path)
@@ -492,6 +492,27 @@ void PropertyTypes::loadFromJson(const QJsonArray &list, const QString &path)
         propertyType->resolveDependencies(context);
 }
 
+/**
+ * Adds the given \a type to the ID and name indexes, unless another type
+ * with the same ID or name was indexed already.
+ */
+void PropertyTypes::addToIndex(PropertyType *type)
+{
+    if (!mTypesById.contains(type->id))
+        mTypesById.insert(type->id, type);
+    if (!mTypesByName.contains(type->name))
+        mTypesByName.insert(type->name, type);
+}
+
+void PropertyTypes::rebuildIndex()
+{
+    mTypesById.clear();
+    mTypesByName.clear();
+
+    for (PropertyType *type : qAsConst(mTypes))
+        addToIndex(type);
+}
+
 QJsonArray PropertyTypes::toJson(const QString &path) const
 {
     const ExportContext context(*this, path);
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMetaType>
@@ -151,6 +152,10 @@ public:
 
 /**
  * Container class for property types.
+ *
+ * The types are indexed by their ID and name, for fast lookup while loading
+ * and exporting files. To keep the index up to date, the name of a type in
+ * the container needs to be changed using setTypeName().
  */
 class TILEDSHARED_EXPORT PropertyTypes
 {
@@ -171,6 +176,7 @@ public:
     std::unique_ptr<PropertyType> takeAt(int index);
     PropertyType &typeAt(int index);
     void moveType(int from, int to);
+    void setTypeName(int index, const QString &name);
     void merge(PropertyTypes types);
 
     const PropertyType *findTypeById(int typeId) const;
@@ -186,7 +192,12 @@ public:
     Types::const_iterator end() const { return mTypes.end(); }
 
 private:
+    void addToIndex(PropertyType *type);
+    void rebuildIndex();
+
     Types mTypes;
+    QHash<int, PropertyType*> mTypesById;
+    QHash<QString, PropertyType*> mTypesByName;
     int mNextId = 0;
 };
 
@@ -198,12 +209,15 @@ inline PropertyType &PropertyTypes::add(std::unique_ptr<PropertyType> type)
         mNextId = std::max(mNextId, type->id);
 
     mTypes.append(type.release());
+    addToIndex(mTypes.last());
     return *mTypes.last();
 }
 
 inline void PropertyTypes::clear()
 {
     mTypes.clear();
+    mTypesById.clear();
+    mTypesByName.clear();
 }
 
 inline size_t PropertyTypes::count() const
@@ -214,11 +228,14 @@ inline size_t PropertyTypes::count() const
 inline void PropertyTypes::removeAt(int index)
 {
     delete mTypes.takeAt(index);
+    rebuildIndex();
 }
 
 inline std::unique_ptr<PropertyType> PropertyTypes::takeAt(int index)
 {
-    return std::unique_ptr<PropertyType> { mTypes.takeAt(index) };
+    std::unique_ptr<PropertyType> type { mTypes.takeAt(index) };
+    rebuildIndex();
+    return type;
 }
 
 inline PropertyType &PropertyTypes::typeAt(int index)
@@ -229,6 +246,13 @@ inline PropertyType &PropertyTypes::typeAt(int index)
 inline void PropertyTypes::moveType(int from, int to)
 {
     mTypes.move(from, to);
+    rebuildIndex();     // the first type with a given name or ID is indexed
+}
+
+inline void PropertyTypes::setTypeName(int index, const QString &name)
+{
+    mTypes.at(index)->name = name;
+    rebuildIndex();
 }
 
 using SharedPropertyTypes = QSharedPointer<PropertyTypes>;
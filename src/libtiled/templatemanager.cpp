@@ -27,8 +27,10 @@
 #include "objecttemplateformat.h"
 #include "logginginterface.h"
 
+#include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
+#include <QThread>
 
 using namespace Tiled;
 
@@ -36,9 +38,18 @@ TemplateManager *TemplateManager::mInstance;
 
 TemplateManager *TemplateManager::instance()
 {
-    if (!mInstance)
+    static QBasicMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!mInstance) {
         mInstance = new TemplateManager;
 
+        // Like the TilesetManager, this manager owns a file system watcher
+        // and needs to live on the main thread.
+        if (auto app = QCoreApplication::instance())
+            mInstance->moveToThread(app->thread());
+    }
+
     return mInstance;
 }
 
@@ -61,28 +72,61 @@ TemplateManager::~TemplateManager()
     qDeleteAll(mObjectTemplates);
 }
 
+ObjectTemplate *TemplateManager::findObjectTemplate(const QString &fileName)
+{
+    QMutexLocker locker(&mMutex);
+    return mObjectTemplates.value(fileName);
+}
+
+/**
+ * Loads the template with the given \a fileName, or returns the already
+ * loaded instance. May be called from any thread.
+ */
 ObjectTemplate *TemplateManager::loadObjectTemplate(const QString &fileName, QString *error)
 {
-    ObjectTemplate *objectTemplate = findObjectTemplate(fileName);
+    if (ObjectTemplate *objectTemplate = findObjectTemplate(fileName))
+        return objectTemplate;
 
-    if (!objectTemplate) {
-        auto newTemplate = readObjectTemplate(fileName, error);
+    // Read without holding the lock, so that other threads are not blocked
+    auto newTemplate = readObjectTemplate(fileName, error);
 
-        // This instance will not have an object. It is used to detect broken
-        // template references.
-        if (!newTemplate)
-            newTemplate = std::make_unique<ObjectTemplate>(fileName);
+    // This instance will not have an object. It is used to detect broken
+    // template references.
+    if (!newTemplate)
+        newTemplate = std::make_unique<ObjectTemplate>(fileName);
 
-        // Watch the file, regardless of whether the parse was successful.
-        mWatcher->addPath(fileName);
+    QMutexLocker locker(&mMutex);
 
-        objectTemplate = newTemplate.get();
-        mObjectTemplates.insert(fileName, newTemplate.release());
-    }
+    // Another thread may have loaded the same template in the meantime
+    if (ObjectTemplate *objectTemplate = mObjectTemplates.value(fileName))
+        return objectTemplate;
+
+    ObjectTemplate *objectTemplate = newTemplate.get();
+    mObjectTemplates.insert(fileName, newTemplate.release());
+    locker.unlock();
+
+    // Watch the file, regardless of whether the parse was successful.
+    watchPath(fileName);
 
     return objectTemplate;
 }
 
+/**
+ * Adds the given path to the file system watcher. When called from a worker
+ * thread, this is queued to the thread of the manager, since the watcher is
+ * not thread-safe.
+ */
+void TemplateManager::watchPath(const QString &fileName)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [=] { watchPath(fileName); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
+    mWatcher->addPath(fileName);
+}
+
 void TemplateManager::pathsChanged(const QStringList &paths)
 {
     for (const QString &fileName : paths) {
@@ -25,12 +25,20 @@
 #include "filesystemwatcher.h"
 
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 
 namespace Tiled {
 
 class ObjectTemplate;
 
+/**
+ * Keeps track of the loaded object templates.
+ *
+ * Templates can be loaded from any thread, so that maps referring to them
+ * can be read in the background. The templates themselves should only be
+ * modified on the main thread.
+ */
 class TILEDSHARED_EXPORT TemplateManager : public QObject
 {
     Q_OBJECT
@@ -59,16 +67,13 @@ private:
     ~TemplateManager() override;
 
     void pathsChanged(const QStringList &paths);
+    void watchPath(const QString &fileName);
 
+    mutable QMutex mMutex;
     QHash<QString, ObjectTemplate*> mObjectTemplates;
     FileSystemWatcher *mWatcher;
 
     static TemplateManager *mInstance;
 };
 
-inline ObjectTemplate *TemplateManager::findObjectTemplate(const QString &fileName)
-{
-    return mObjectTemplates.value(fileName);
-}
-
 } // namespace Tiled
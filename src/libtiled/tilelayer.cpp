@@ -30,12 +30,17 @@
 #include "tilelayer.h"
 
 #include "containerhelpers.h"
+#include "gidmapper.h"
 #include "hex.h"
+#include "logginginterface.h"
+#include "map.h"
 #include "tile.h"
 
 #include <algorithm>
 #include <memory>
 
+#include <QCoreApplication>
+#include <QQueue>
 #include <QSet>
 
 using namespace Tiled;
@@ -61,45 +66,73 @@ void Cell::rotate(RotateDirection direction)
     setFlippedAntiDiagonally((mask & 1) != 0);
 }
 
-QRegion Chunk::region(std::function<bool (const Cell &)> condition) const
+Chunk::Chunk(const Chunk &other)
+    : mGrid(other.mGrid)
+    , mEncoded(other.mEncoded)
+    , mDecoded(other.mDecoded.load(std::memory_order_acquire))
+    , mLastUsed(other.mLastUsed.load(std::memory_order_relaxed))
+    , mTilesetUsage(other.mTilesetUsage)
+    , mCellBounds(other.mCellBounds)
+    , mCellCount(other.mCellCount)
+    , mSummaryDirty(other.mSummaryDirty)
+    , mCellBoundsDirty(other.mCellBoundsDirty)
 {
-    QRegion region;
-
-    for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (condition(cellAt(x, y))) {
-                const int rangeStart = x;
-                for (++x; x <= CHUNK_SIZE; ++x) {
-                    if (x == CHUNK_SIZE || !condition(cellAt(x, y))) {
-                        const int rangeEnd = x;
-                        region += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
-                        break;
-                    }
-                }
-            }
-        }
-    }
+}
 
-    return region;
+Chunk &Chunk::operator=(const Chunk &other)
+{
+    mGrid = other.mGrid;
+    mEncoded = other.mEncoded;
+    mDecoded.store(other.mDecoded.load(std::memory_order_acquire), std::memory_order_relaxed);
+    mLastUsed.store(other.mLastUsed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    mTilesetUsage = other.mTilesetUsage;
+    mCellBounds = other.mCellBounds;
+    mCellCount = other.mCellCount;
+    mSummaryDirty = other.mSummaryDirty;
+    mCellBoundsDirty = other.mCellBoundsDirty;
+    return *this;
 }
 
 void Chunk::setCell(int x, int y, const Cell &cell)
 {
-    int index = x + y * CHUNK_SIZE;
+    Cell &target = mGrid[x + y * CHUNK_SIZE];
+
+    Tileset *oldTileset = target.tileset();
+    Tileset *newTileset = cell.tileset();
+
+    if (!mSummaryDirty && oldTileset != newTileset) {
+        if (oldTileset) {
+            addTilesetUsage(oldTileset, -1);
+            --mCellCount;
+
+            // Removing a cell at the edge may shrink the bounds
+            if (mCellCount == 0) {
+                mCellBounds = QRect();
+                mCellBoundsDirty = false;
+            } else if (x == mCellBounds.left() || x == mCellBounds.right() ||
+                       y == mCellBounds.top() || y == mCellBounds.bottom()) {
+                mCellBoundsDirty = true;
+            }
+        }
+        if (newTileset) {
+            addTilesetUsage(newTileset, 1);
+            ++mCellCount;
 
-    mGrid[index] = cell;
+            if (!mCellBoundsDirty)
+                mCellBounds |= QRect(x, y, 1, 1);
+        }
+    }
+
+    target = cell;
 }
 
-bool Chunk::isEmpty() const
+bool Chunk::usesTileset(const Tileset *tileset) const
 {
-    for (int y = 0; y < CHUNK_SIZE; ++y) {
-        for (int x = 0; x < CHUNK_SIZE; ++x) {
-            if (!cellAt(x, y).isEmpty())
-                return false;
-        }
-    }
+    for (const TilesetUsage &usage : tilesetUsage())
+        if (usage.tileset == tileset)
+            return true;
 
-    return true;
+    return false;
 }
 
 bool Chunk::hasCell(std::function<bool (const Cell &)> condition) const
@@ -113,18 +146,152 @@ bool Chunk::hasCell(std::function<bool (const Cell &)> condition) const
 
 void Chunk::removeReferencesToTileset(Tileset *tileset)
 {
+    if (!usesTileset(tileset))
+        return;
+
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         if (mGrid.at(i).tileset() == tileset)
             mGrid.replace(i, Cell::empty);
     }
+
+    for (int i = 0; i < mTilesetUsage.size(); ++i) {
+        if (mTilesetUsage.at(i).tileset == tileset) {
+            mCellCount -= mTilesetUsage.at(i).cellCount;
+            mTilesetUsage.remove(i);
+            break;
+        }
+    }
+
+    mCellBoundsDirty = mCellCount > 0;
+    if (mCellCount == 0)
+        mCellBounds = QRect();
 }
 
 void Chunk::replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset)
 {
+    if (!usesTileset(oldTileset))
+        return;
+
     for (Cell &cell : mGrid) {
         if (cell.tileset() == oldTileset)
             cell.setTile(newTileset, cell.tileId());
     }
+
+    for (int i = 0; i < mTilesetUsage.size(); ++i) {
+        if (mTilesetUsage.at(i).tileset == oldTileset) {
+            const int cellCount = mTilesetUsage.at(i).cellCount;
+            mTilesetUsage.remove(i);
+            addTilesetUsage(newTileset, cellCount);
+            break;
+        }
+    }
+}
+
+/**
+ * Recomputes the summary of this chunk's contents from its cells.
+ */
+void Chunk::updateSummary() const
+{
+    Q_ASSERT(isDecoded());
+
+    mTilesetUsage.clear();
+    mCellBounds = QRect();
+    mCellCount = 0;
+
+    Tileset *lastTileset = nullptr;
+    int lastIndex = -1;
+
+    const Cell *cell = mGrid.constData();
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        for (int x = 0; x < CHUNK_SIZE; ++x, ++cell) {
+            Tileset *tileset = cell->tileset();
+            if (!tileset)
+                continue;
+
+            ++mCellCount;
+            mCellBounds |= QRect(x, y, 1, 1);
+
+            // Neighboring cells tend to use the same tileset
+            if (tileset != lastTileset) {
+                lastTileset = tileset;
+                lastIndex = 0;
+                while (lastIndex < mTilesetUsage.size() && mTilesetUsage.at(lastIndex).tileset != tileset)
+                    ++lastIndex;
+                if (lastIndex == mTilesetUsage.size())
+                    mTilesetUsage.append(TilesetUsage { tileset, 0 });
+            }
+
+            ++mTilesetUsage[lastIndex].cellCount;
+        }
+    }
+
+    mSummaryDirty = false;
+    mCellBoundsDirty = false;
+}
+
+void Chunk::addTilesetUsage(Tileset *tileset, int cellCount)
+{
+    for (int i = 0; i < mTilesetUsage.size(); ++i) {
+        TilesetUsage &usage = mTilesetUsage[i];
+        if (usage.tileset == tileset) {
+            usage.cellCount += cellCount;
+            if (usage.cellCount == 0)
+                mTilesetUsage.remove(i);
+            return;
+        }
+    }
+
+    mTilesetUsage.append(TilesetUsage { tileset, cellCount });
+}
+
+/**
+ * Decodes the encoded data of this chunk. Returns false when the data turned
+ * out to be corrupt, in which case the chunk will contain only the cells that
+ * could be decoded.
+ */
+bool Chunk::decode() const
+{
+    Q_ASSERT(mEncoded);
+
+    mGrid.resize(CHUNK_SIZE * CHUNK_SIZE);
+
+    const auto error = mEncoded->gidMapper->decodeChunkData(mGrid.data(),
+                                                             mEncoded->data,
+                                                             mEncoded->format);
+
+    // Publishes the cells to threads checking isDecoded() without locking
+    mDecoded.store(true, std::memory_order_release);
+
+    return error == GidMapper::NoError;
+}
+
+/**
+ * Releases the decoded cells of this chunk. When the chunk was modified since
+ * it was decoded, it is encoded again using the given \a gidMapper.
+ *
+ * Returns false when the chunk could not be encoded.
+ */
+bool Chunk::unload(const QSharedPointer<const GidMapper> &gidMapper) const
+{
+    if (!mEncoded) {
+        bool ok;
+        QByteArray data = gidMapper->encodeChunkData(mGrid.constData(), ok);
+        if (!ok)
+            return false;
+
+        auto encoded = QSharedPointer<EncodedChunk>::create();
+        encoded->data = std::move(data);
+        encoded->format = Map::Base64Zlib;
+        encoded->gidMapper = gidMapper;
+        mEncoded = encoded;
+    }
+
+    // Keep the summary available while the cells are not decoded
+    ensureSummary();
+
+    mDecoded.store(false, std::memory_order_relaxed);
+    QVector<Cell>().swap(mGrid);
+    return true;
 }
 
 TileLayer::TileLayer(const QString &name, int x, int y, int width, int height)
@@ -170,25 +337,16 @@ static QMargins computeDrawMargins(const QSet<SharedTileset> &tilesets)
 
 QMargins TileLayer::drawMargins() const
 {
-    return computeDrawMargins(usedTilesets());
-}
-
-/**
- * Calculates the region of cells in this tile layer for which the given
- * \a condition returns true.
- */
-QRegion TileLayer::region(std::function<bool (const Cell &)> condition) const
-{
-    QRegion region;
-
-    QHashIterator<QPoint, Chunk> it(mChunks);
-    while (it.hasNext()) {
-        it.next();
-        region += it.value().region(condition).translated(it.key().x() * CHUNK_SIZE + mX,
-                                                          it.key().y() * CHUNK_SIZE + mY);
+    // Avoid decoding all chunks of a lazily loaded layer, by assuming all
+    // tilesets it was loaded with are used.
+    if (mLazyGidMapper && mUsedTilesetsDirty) {
+        QSet<SharedTileset> tilesets = mUsedTilesets;
+        for (const SharedTileset &tileset : mLazyGidMapper->tilesets())
+            tilesets.insert(tileset);
+        return computeDrawMargins(tilesets);
     }
 
-    return region;
+    return computeDrawMargins(usedTilesets());
 }
 
 /**
@@ -218,11 +376,156 @@ void Tiled::TileLayer::setCell(int x, int y, const Cell &cell)
             else if (newTileset)
                 mUsedTilesets.insert(newTileset->sharedFromThis());
         }
+    } else if (mLazyGidMapper && cell.tileset()) {
+        // Keep track of newly used tilesets for drawMargins()
+        mUsedTilesets.insert(cell.tileset()->sharedFromThis());
     }
 
     _chunk.setCell(x & CHUNK_MASK, y & CHUNK_MASK, cell);
 }
 
+/**
+ * Sets the chunk starting at the given coordinates to the \a encoded chunk
+ * data, which will only be decoded when the chunk is accessed. The
+ * coordinates need to be aligned to the native chunk size.
+ *
+ * \sa MapReader::setLazyChunkLoadingEnabled()
+ */
+void TileLayer::setEncodedChunk(int x, int y, const QSharedPointer<const EncodedChunk> &encoded)
+{
+    Q_ASSERT((x & CHUNK_MASK) == 0 && (y & CHUNK_MASK) == 0);
+
+    mChunks.insert(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS), Chunk(encoded));
+    mBounds = mBounds.united(QRect(x, y, CHUNK_SIZE, CHUNK_SIZE));
+    mLazyGidMapper = encoded->gidMapper;
+    mAllChunksDecoded = false;
+    mUsedTilesetsDirty = true;
+}
+
+/**
+ * Releases the decoded cells of the least recently used chunks when more
+ * than \a maxDecodedChunks chunks are decoded. Chunks that were modified are
+ * encoded again. Only has an effect on layers that were loaded lazily.
+ *
+ * Since this invalidates references to cells, it should only be called at
+ * points where no such references are held, for example after painting.
+ */
+void TileLayer::unloadColdChunks(int maxDecodedChunks)
+{
+    if (!mLazyGidMapper)
+        return;
+
+    // Chunks are marked with the epoch in which they were last used, which
+    // advances with each call
+    ++mChunkAccessEpoch;
+
+    if (mDecodedChunkCount <= maxDecodedChunks)
+        return;
+
+    // Iterating non-const detaches the chunks from any other layer
+    QVector<const Chunk*> decodedChunks;
+    for (Chunk &chunk : mChunks)
+        if (chunk.isDecoded())
+            decodedChunks.append(&chunk);
+
+    mDecodedChunkCount = decodedChunks.size();
+    if (mDecodedChunkCount <= maxDecodedChunks)
+        return;
+
+    // Unload down to half the limit, to avoid having to do this again soon
+    const auto firstToKeep = decodedChunks.end() - maxDecodedChunks / 2;
+    const auto lessRecentlyUsed = [] (const Chunk *a, const Chunk *b) {
+        return a->mLastUsed.load(std::memory_order_relaxed) < b->mLastUsed.load(std::memory_order_relaxed);
+    };
+    std::nth_element(decodedChunks.begin(), firstToKeep, decodedChunks.end(), lessRecentlyUsed);
+
+    for (auto it = decodedChunks.begin(); it != firstToKeep; ++it) {
+        if ((*it)->unload(mLazyGidMapper)) {
+            --mDecodedChunkCount;
+            mAllChunksDecoded = false;
+        }
+    }
+}
+
+/**
+ * Makes sure the given lazily loaded \a chunk is decoded and marks it as
+ * recently used.
+ */
+void TileLayer::loadChunk(QPoint chunkCoordinates, const Chunk &chunk) const
+{
+    QMutexLocker locker(&mLazyMutex);
+    decodeChunk(chunkCoordinates, chunk);
+}
+
+/**
+ * Same as loadChunk(), but expects mLazyMutex to be locked.
+ */
+void TileLayer::decodeChunk(QPoint chunkCoordinates, const Chunk &chunk) const
+{
+    chunk.mLastUsed.store(mChunkAccessEpoch, std::memory_order_relaxed);
+
+    if (chunk.isDecoded())
+        return;
+
+    ++mDecodedChunkCount;
+
+    if (!chunk.decode()) {
+        ERROR(QCoreApplication::translate("Tiled::TileLayer",
+                                          "Corrupt layer data for layer '%1' in chunk at %2,%3")
+              .arg(mName)
+              .arg(chunkCoordinates.x() * CHUNK_SIZE)
+              .arg(chunkCoordinates.y() * CHUNK_SIZE));
+    }
+}
+
+/**
+ * Makes sure the summary of the given \a chunk is available, which requires
+ * decoding it when it was loaded lazily and never decoded before.
+ */
+void TileLayer::summarizeChunk(QPoint chunkCoordinates, const Chunk &chunk) const
+{
+    if (!mAllChunksDecoded.load(std::memory_order_acquire) && !chunk.hasSummary())
+        loadChunk(chunkCoordinates, chunk);
+}
+
+/**
+ * Decodes all chunks, for operations that need to process the entire layer.
+ */
+void TileLayer::decodeAllChunks() const
+{
+    if (!mLazyGidMapper || mAllChunksDecoded.load(std::memory_order_acquire))
+        return;
+
+    QMutexLocker locker(&mLazyMutex);
+
+    for (auto it = mChunks.constBegin(), end = mChunks.constEnd(); it != end; ++it)
+        if (!it.value().isDecoded())
+            decodeChunk(it.key(), it.value());
+
+    // From here on, chunks are accessed without locking
+    mAllChunksDecoded.store(true, std::memory_order_release);
+}
+
+/**
+ * Decodes all chunks and drops their encoded data, for operations that
+ * modify the cells of the layer in place. After this, the layer is no longer
+ * lazily loaded.
+ */
+void TileLayer::dropEncodedChunks()
+{
+    if (!mLazyGidMapper)
+        return;
+
+    decodeAllChunks();
+
+    for (Chunk &chunk : mChunks)
+        chunk.mEncoded.reset();
+
+    mLazyGidMapper.reset();
+    mAllChunksDecoded = false;
+    mDecodedChunkCount = 0;
+}
+
 std::unique_ptr<TileLayer> TileLayer::copy(const QRegion &region) const
 {
     const QRect regionBounds = region.boundingRect();
@@ -306,10 +609,15 @@ void TileLayer::clear()
     mBounds = QRect();
     mUsedTilesets.clear();
     mUsedTilesetsDirty = false;
+    mLazyGidMapper.reset();
+    mAllChunksDecoded = false;
+    mDecodedChunkCount = 0;
 }
 
 void TileLayer::flip(FlipDirection direction)
 {
+    dropEncodedChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
@@ -344,6 +652,8 @@ void TileLayer::flip(FlipDirection direction)
 
 void TileLayer::flipHexagonal(FlipDirection direction)
 {
+    dropEncodedChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, mWidth, mHeight);
 
     Q_ASSERT(direction == FlipHorizontally || direction == FlipVertically);
@@ -394,6 +704,8 @@ void TileLayer::flipHexagonal(FlipDirection direction)
 
 void TileLayer::rotate(RotateDirection direction)
 {
+    dropEncodedChunks();
+
     constexpr unsigned char rotateRightMask[8] = { 5, 4, 1, 0, 7, 6, 3, 2 };
     constexpr unsigned char rotateLeftMask[8]  = { 3, 2, 7, 6, 1, 0, 5, 4 };
 
@@ -444,6 +756,8 @@ void TileLayer::rotate(RotateDirection direction)
 
 void TileLayer::rotateHexagonal(RotateDirection direction, Map *map)
 {
+    dropEncodedChunks();
+
     Map::StaggerIndex staggerIndex = map->staggerIndex();
     Map::StaggerAxis staggerAxis = map->staggerAxis();
 
@@ -549,10 +863,10 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
     if (mUsedTilesetsDirty) {
         QSet<SharedTileset> tilesets;
 
-        for (const Chunk &chunk : mChunks) {
-            for (const Cell &cell : chunk)
-                if (const Tile *tile = cell.tile())
-                    tilesets.insert(tile->sharedTileset());
+        for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
+            summarizeChunk(it.key(), it.value());
+            for (const Chunk::TilesetUsage &usage : it.value().tilesetUsage())
+                tilesets.insert(usage.tileset->sharedFromThis());
         }
 
         mUsedTilesets.swap(tilesets);
@@ -564,6 +878,8 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
 
 bool TileLayer::hasCell(std::function<bool (const Cell &)> condition) const
 {
+    decodeAllChunks();
+
     for (const Chunk &chunk : mChunks) {
         if (chunk.hasCell(condition))
             return true;
@@ -579,8 +895,12 @@ bool TileLayer::referencesTileset(const Tileset *tileset) const
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
-    for (Chunk &chunk : mChunks)
-        chunk.removeReferencesToTileset(tileset);
+    if (referencesTileset(tileset)) {
+        dropEncodedChunks();
+
+        for (Chunk &chunk : mChunks)
+            chunk.removeReferencesToTileset(tileset);
+    }
 
     mUsedTilesets.remove(tileset->sharedFromThis());
 }
@@ -588,8 +908,12 @@ void TileLayer::removeReferencesToTileset(Tileset *tileset)
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
-    for (Chunk &chunk : mChunks)
-        chunk.replaceReferencesToTileset(oldTileset, newTileset);
+    if (referencesTileset(oldTileset)) {
+        dropEncodedChunks();
+
+        for (Chunk &chunk : mChunks)
+            chunk.replaceReferencesToTileset(oldTileset, newTileset);
+    }
 
     if (mUsedTilesets.remove(oldTileset->sharedFromThis()))
         mUsedTilesets.insert(newTileset->sharedFromThis());
@@ -600,6 +924,8 @@ void TileLayer::resize(QSize size, QPoint offset)
     if (this->size() == size && offset.isNull())
         return;
 
+    dropEncodedChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, size.width(), size.height());
 
     // Copy over the preserved part
@@ -627,6 +953,8 @@ void TileLayer::offsetTiles(QPoint offset,
     if (offset.isNull())
         return;
 
+    dropEncodedChunks();
+
     const std::unique_ptr<TileLayer> newLayer(clone());
 
     for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
@@ -657,6 +985,8 @@ void TileLayer::offsetTiles(QPoint offset,
 
 void TileLayer::offsetTiles(QPoint offset)
 {
+    dropEncodedChunks();
+
     const auto newLayer = std::make_unique<TileLayer>(QString(), 0, 0, 0, 0);
 
     // Process only the allocated chunks
@@ -704,7 +1034,7 @@ Layer *TileLayer::mergedWith(const Layer *other) const
 
 QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
 {
-    QRegion ret;
+    TileRegion ret;
 
     const int dx = other->x() - mX;
     const int dy = other->y() - mY;
@@ -719,24 +1049,175 @@ QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
                        cellAt(x, y) != other->cellAt(x - dx, y - dy)) {
                     ++x;
                 }
-                const int rangeEnd = x;
-                ret += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
+                ret.addSpan(y, rangeStart, x - 1);
+            }
+        }
+    }
+
+    return ret.toRegion();
+}
+
+QRegion TileLayer::computeFillRegion(const QRegion &region, QPoint fillOrigin) const
+{
+    // Return empty region when the bounds do not contain the fill origin
+    if (!region.contains(fillOrigin))
+        return QRegion();
+
+    Map::Orientation orientation = Map::Orthogonal;
+    Map::StaggerAxis staggerAxis = Map::StaggerY;
+    Map::StaggerIndex staggerIndex = Map::StaggerOdd;
+
+    if (const Map *map = this->map()) {
+        orientation = map->orientation();
+        staggerAxis = map->staggerAxis();
+        staggerIndex = map->staggerIndex();
+    }
+
+    // Cache cell that we will match other cells against
+    const Cell matchCell = cellAt(fillOrigin);
+
+    const QRect bounds = region.boundingRect();
+    const int width = bounds.width();
+    const int height = bounds.height();
+    const int indexOffset = -(bounds.left() + bounds.top() * width);
+
+    const bool isStaggered = orientation == Map::Hexagonal || orientation == Map::Staggered;
+
+    // Create a queue to hold cells that need filling
+    QQueue<QPoint> fillPositions;
+    fillPositions.enqueue(fillOrigin);
+
+    // Create an array that will store which cells have been processed
+    // This is faster than checking if a given cell is in the region/list
+    QVector<bool> processedCellsVec(width * height);
+    bool *processedCells = processedCellsVec.data();
+    QRegion fillRegion;
+
+    // Loop through queued positions and fill them, while at the same time
+    // checking adjacent positions to see if they should be added
+    while (!fillPositions.isEmpty()) {
+        const QPoint currentPoint = fillPositions.dequeue();
+        const int startOfLine = currentPoint.y() * width;
+
+        // Seek as far left as we can
+        int left = currentPoint.x();
+        while (left > bounds.left() && cellAt(left - 1, currentPoint.y()) == matchCell) {
+            --left;
+            processedCells[indexOffset + startOfLine + left] = true;
+        }
+
+        // Seek as far right as we can
+        int right = currentPoint.x();
+        while (right < bounds.right() && cellAt(right + 1, currentPoint.y()) == matchCell) {
+            ++right;
+            processedCells[indexOffset + startOfLine + right] = true;
+        }
+
+        // Add cells between left and right to the region
+        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
+
+        bool leftColumnIsStaggered = false;
+        bool rightColumnIsStaggered = false;
+
+        // For hexagonal maps with a staggered Y-axis, we may need to extend the search range
+        if (isStaggered) {
+            if (staggerAxis == Map::StaggerY) {
+                bool rowIsStaggered = ((mY + currentPoint.y()) & 1) ^ staggerIndex;
+                if (rowIsStaggered)
+                    right = qMin(right + 1, bounds.right());
+                else
+                    left = qMax(left - 1, bounds.left());
+            } else {
+                leftColumnIsStaggered = ((mX + left) & 1) ^ staggerIndex;
+                rightColumnIsStaggered = ((mX + right) & 1) ^ staggerIndex;
+            }
+        }
+
+        // Loop between left and right and check if cells above or below need
+        // to be added to the queue.
+        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
+            bool adjacentCellAdded = false;
+
+            for (int x = left; x <= right; ++x) {
+                const int index = y * width + x;
+
+                if (!processedCells[indexOffset + index] && cellAt(x, y) == matchCell) {
+                    // Do not add the cell to the queue if an adjacent cell was added.
+                    if (!adjacentCellAdded) {
+                        fillPositions.enqueue(QPoint(x, y));
+                        adjacentCellAdded = true;
+                    }
+                } else {
+                    adjacentCellAdded = false;
+                }
+
+                processedCells[indexOffset + index] = true;
             }
+        };
+
+        if (currentPoint.y() > bounds.top()) {
+            int _left = left;
+            int _right = right;
+
+            if (isStaggered && staggerAxis == Map::StaggerX) {
+                if (!leftColumnIsStaggered)
+                    _left = qMax(left - 1, bounds.left());
+                if (!rightColumnIsStaggered)
+                    _right = qMin(right + 1, bounds.right());
+            }
+
+            findFillPositions(_left, _right, currentPoint.y() - 1);
+        }
+
+        if (currentPoint.y() < bounds.bottom()) {
+            int _left = left;
+            int _right = right;
+
+            if (isStaggered && staggerAxis == Map::StaggerX) {
+                if (leftColumnIsStaggered)
+                    _left = qMax(left - 1, bounds.left());
+                if (rightColumnIsStaggered)
+                    _right = qMin(right + 1, bounds.right());
+            }
+
+            findFillPositions(_left, _right, currentPoint.y() + 1);
         }
     }
 
-    return ret;
+    return fillRegion;
 }
 
 bool TileLayer::isEmpty() const
 {
-    for (const Chunk &chunk : mChunks)
-        if (!chunk.isEmpty())
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
+        summarizeChunk(it.key(), it.value());
+        if (!it.value().isEmpty())
             return false;
+    }
 
     return true;
 }
 
+/**
+ * Returns the bounding rectangle of the non-empty cells in this layer, in
+ * map tile coordinates. Unlike bounds(), which is aligned to the chunks,
+ * this is tight around the tiles.
+ */
+QRect TileLayer::tileBounds() const
+{
+    QRect tileBounds;
+
+    for (auto it = mChunks.cbegin(), it_end = mChunks.cend(); it != it_end; ++it) {
+        summarizeChunk(it.key(), it.value());
+        if (it.value().isEmpty())
+            continue;
+
+        tileBounds |= it.value().cellBounds().translated(it.key() * CHUNK_SIZE);
+    }
+
+    return tileBounds.translated(mX, mY);
+}
+
 static bool compareRectPos(const QRect &a, const QRect &b)
 {
     if (a.y() != b.y())
@@ -753,6 +1234,8 @@ static bool compareRectPos(const QRect &a, const QRect &b)
  */
 QVector<QRect> TileLayer::sortedChunksToWrite(QSize chunkSize) const
 {
+    decodeAllChunks();
+
     QVector<QRect> chunksToWrite;
     QSet<QPoint> existingChunks;
 
@@ -838,7 +1321,15 @@ TileLayer *TileLayer::clone() const
 TileLayer *TileLayer::initializeClone(TileLayer *clone) const
 {
     Layer::initializeClone(clone);
+
+    // The clone is not lazily loaded. Its chunks are decoded and detached
+    // from the ones of this layer, so that the state computed on demand for
+    // the chunks of either layer is not shared with the other one.
+    decodeAllChunks();
     clone->mChunks = mChunks;
+    for (Chunk &chunk : clone->mChunks)
+        chunk.mEncoded.reset();
+
     clone->mBounds = mBounds;
     clone->mUsedTilesets = mUsedTilesets;
     clone->mUsedTilesetsDirty = mUsedTilesetsDirty;
@@ -34,30 +34,27 @@
 #include "layer.h"
 #include "tiled.h"
 #include "tile.h"
+#include "tileregion.h"
 #include "tileset.h"
 
 #include <QHash>
 #include <QMargins>
+#include <QMutex>
 #include <QPoint>
 #include <QSharedPointer>
 #include <QString>
 #include <QVector>
 
+#include <atomic>
 #include <functional>
 
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-inline uint qHash(QPoint key, uint seed = 0) Q_DECL_NOTHROW
-{
-    uint h1 = qHash(key.x(), seed);
-    uint h2 = qHash(key.y(), seed);
-    return ((h1 << 16) | (h1 >> 16)) ^ h2 ^ seed;
-}
-#endif
-
 namespace Tiled {
 
+class GidMapper;
 class Tile;
 
+struct EncodedChunk;
+
 /**
  * A cell on a tile layer grid.
  */
@@ -172,15 +169,42 @@ inline bool Cell::refersTile(const Tile *tile) const
 
 /**
  * A Chunk is a grid of cells of size CHUNK_SIZExCHUNK_SIZE.
+ *
+ * When loaded lazily, a chunk initially only holds its encoded data, which
+ * is decoded by the TileLayer when the chunk is first accessed.
+ *
+ * The chunk keeps a summary of its contents: the number of non-empty cells,
+ * the number of cells using each tileset and the bounds of the non-empty
+ * cells. It is updated by setCell() and recomputed when needed after the
+ * cells were modified through the non-const iterators.
  */
 class TILEDSHARED_EXPORT Chunk
 {
 public:
+    struct TilesetUsage
+    {
+        Tileset *tileset;
+        int cellCount;
+    };
+
     Chunk() :
-        mGrid(CHUNK_SIZE * CHUNK_SIZE)
+        mGrid(CHUNK_SIZE * CHUNK_SIZE),
+        mDecoded(true)
+    {}
+
+    explicit Chunk(const QSharedPointer<const EncodedChunk> &encoded) :
+        mEncoded(encoded),
+        mSummaryDirty(true)
     {}
 
-    QRegion region(std::function<bool (const Cell &)> condition) const;
+    Chunk(const Chunk &other);
+    Chunk &operator=(const Chunk &other);
+
+    template<typename Condition>
+    TileRegion::ChunkBits cellBits(Condition condition) const;
+
+    template<typename Condition>
+    QRegion region(Condition condition) const;
 
     const Cell &cellAt(int x, int y) const;
     const Cell &cellAt(QPoint point) const;
@@ -188,6 +212,11 @@ public:
     void setCell(int x, int y, const Cell &cell);
 
     bool isEmpty() const;
+    int cellCount() const;
+    QRect cellBounds() const;
+
+    const QVector<TilesetUsage> &tilesetUsage() const;
+    bool usesTileset(const Tileset *tileset) const;
 
     bool hasCell(std::function<bool (const Cell &)> condition) const;
 
@@ -195,13 +224,45 @@ public:
 
     void replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset);
 
-    QVector<Cell>::iterator begin() { return mGrid.begin(); }
+    QVector<Cell>::iterator begin() { invalidateSummary(); return mGrid.begin(); }
     QVector<Cell>::iterator end() { return mGrid.end(); }
     QVector<Cell>::const_iterator begin() const { return mGrid.begin(); }
     QVector<Cell>::const_iterator end() const { return mGrid.end(); }
 
+    bool isDecoded() const { return mDecoded.load(std::memory_order_acquire); }
+    bool hasEncodedData() const { return !mEncoded.isNull(); }
+
+    /**
+     * Returns whether the summary of this chunk's contents is available
+     * without decoding it first.
+     */
+    bool hasSummary() const { return isDecoded() || !mSummaryDirty; }
+
 private:
-    QVector<Cell> mGrid;
+    friend class TileLayer;
+
+    bool decode() const;
+    bool unload(const QSharedPointer<const GidMapper> &gidMapper) const;
+
+    void invalidateSummary() { mSummaryDirty = true; }
+    void ensureSummary() const;
+    void updateSummary() const;
+    void addTilesetUsage(Tileset *tileset, int cellCount);
+
+    // Mutable since decoding and unloading don't change the logical contents.
+    // The atomics allow checking a chunk of a lazily loaded layer without
+    // locking, once it has been decoded.
+    mutable QVector<Cell> mGrid;
+    mutable QSharedPointer<const EncodedChunk> mEncoded;
+    mutable std::atomic<bool> mDecoded { false };
+    mutable std::atomic<unsigned> mLastUsed { 0 };
+
+    // Summary of the contents, computed on demand when dirty
+    mutable QVector<TilesetUsage> mTilesetUsage;
+    mutable QRect mCellBounds;
+    mutable int mCellCount = 0;
+    mutable bool mSummaryDirty = false;
+    mutable bool mCellBoundsDirty = false;
 };
 
 inline const Cell &Chunk::cellAt(int x, int y) const
@@ -214,6 +275,79 @@ inline const Cell &Chunk::cellAt(QPoint point) const
     return cellAt(point.x(), point.y());
 }
 
+inline void Chunk::ensureSummary() const
+{
+    if (mSummaryDirty || mCellBoundsDirty)
+        updateSummary();
+}
+
+/**
+ * Returns whether this chunk has no non-empty cells.
+ */
+inline bool Chunk::isEmpty() const
+{
+    return cellCount() == 0;
+}
+
+/**
+ * Returns the number of non-empty cells in this chunk.
+ */
+inline int Chunk::cellCount() const
+{
+    if (mSummaryDirty)
+        updateSummary();
+    return mCellCount;
+}
+
+/**
+ * Returns the bounds of the non-empty cells, in local chunk coordinates.
+ */
+inline QRect Chunk::cellBounds() const
+{
+    ensureSummary();
+    return mCellBounds;
+}
+
+/**
+ * Returns the tilesets used by this chunk, along with the number of cells
+ * using each of them.
+ */
+inline const QVector<Chunk::TilesetUsage> &Chunk::tilesetUsage() const
+{
+    if (mSummaryDirty)
+        updateSummary();
+    return mTilesetUsage;
+}
+
+/**
+ * Returns a bit for each cell of this chunk, set when it matches the given
+ * \a condition. The chunk needs to be decoded.
+ */
+template<typename Condition>
+inline TileRegion::ChunkBits Chunk::cellBits(Condition condition) const
+{
+    TileRegion::ChunkBits bits;
+    const Cell *cell = mGrid.constData();
+
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        TileRegion::Row row = 0;
+        for (int x = 0; x < CHUNK_SIZE; ++x, ++cell)
+            if (condition(*cell))
+                row |= static_cast<TileRegion::Row>(1u << x);
+        bits.rows[y] = row;
+    }
+
+    return bits;
+}
+
+template<typename Condition>
+inline QRegion Chunk::region(Condition condition) const
+{
+    TileRegion region;
+    region.uniteChunk(QPoint(), cellBits(condition));
+    return region.toRegion();
+}
+
 /**
  * A tile layer is a grid of cells. Each cell refers to a specific tile, and
  * stores how the tile is flipped.
@@ -372,6 +506,12 @@ public:
      */
     QRect localBounds() const { return mBounds; }
 
+    /**
+     * Returns the number of allocated chunks, each of which holds
+     * CHUNK_SIZE x CHUNK_SIZE cells.
+     */
+    int chunkCount() const { return mChunks.size(); }
+
     QRect rect() const { return QRect(mX, mY, mWidth, mHeight); }
 
     QMargins drawMargins() const;
@@ -383,7 +523,12 @@ public:
 
     const Chunk *findChunk(int x, int y) const;
 
-    QRegion region(std::function<bool (const Cell &)> condition) const;
+    template<typename Condition>
+    TileRegion tileRegion(Condition condition) const;
+    TileRegion tileRegion() const;
+
+    template<typename Condition>
+    QRegion region(Condition condition) const;
     QRegion region() const;
 
     const Cell &cellAt(int x, int y) const;
@@ -391,6 +536,15 @@ public:
 
     void setCell(int x, int y, const Cell &cell);
 
+    void setEncodedChunk(int x, int y, const QSharedPointer<const EncodedChunk> &encoded);
+    void unloadColdChunks(int maxDecodedChunks = DefaultMaxDecodedChunks);
+
+    /**
+     * The default number of decoded chunks unloadColdChunks() keeps in
+     * memory (about 16 MB worth of cells).
+     */
+    static constexpr int DefaultMaxDecodedChunks = 4096;
+
     /**
      * Returns a copy of the area specified by the given \a region. The
      * caller is responsible for the returned tile layer.
@@ -518,16 +672,32 @@ public:
      */
     QRegion computeDiffRegion(const TileLayer *other) const;
 
+    /**
+     * Returns the contiguous region of cells matching the cell at
+     * \a fillOrigin, limited to the given \a region. Both \a region and
+     * \a fillOrigin are relative to this tile layer, as is the returned
+     * region.
+     *
+     * Uses the orientation of the map this layer is part of to determine
+     * which cells are adjacent, falling back to orthogonal adjacency when
+     * the layer is not part of a map.
+     */
+    QRegion computeFillRegion(const QRegion &region, QPoint fillOrigin) const;
+
     /**
      * Returns true if all tiles in the layer are empty.
      */
     bool isEmpty() const override;
 
+    QRect tileBounds() const;
+
     TileLayer *clone() const override;
 
-    iterator begin() { return iterator(mChunks.begin(), mChunks.end()); }
+    void decodeAllChunks() const;
+
+    iterator begin() { dropEncodedChunks(); return iterator(mChunks.begin(), mChunks.end()); }
     iterator end() { return iterator(mChunks.end(), mChunks.end()); }
-    const_iterator begin() const { return const_iterator(mChunks.begin(), mChunks.end()); }
+    const_iterator begin() const { decodeAllChunks(); return const_iterator(mChunks.begin(), mChunks.end()); }
     const_iterator end() const { return const_iterator(mChunks.end(), mChunks.end()); }
 
     QVector<QRect> sortedChunksToWrite(QSize chunkSize) const;
@@ -536,12 +706,26 @@ protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    void loadChunk(QPoint chunkCoordinates, const Chunk &chunk) const;
+    void decodeChunk(QPoint chunkCoordinates, const Chunk &chunk) const;
+    void summarizeChunk(QPoint chunkCoordinates, const Chunk &chunk) const;
+    void dropEncodedChunks();
+
     int mWidth;
     int mHeight;
     QHash<QPoint, Chunk> mChunks;
     QRect mBounds;
     mutable QSet<SharedTileset> mUsedTilesets;
     mutable bool mUsedTilesetsDirty;
+
+    // Only set for layers that have been loaded lazily. Decoding chunks is
+    // protected by the mutex, since it may happen from several threads
+    // reading the layer at the same time.
+    QSharedPointer<const GidMapper> mLazyGidMapper;
+    mutable QMutex mLazyMutex;
+    mutable std::atomic<bool> mAllChunksDecoded { false };
+    unsigned mChunkAccessEpoch = 0;
+    mutable int mDecodedChunkCount = 0;
 };
 
 inline QPoint TileLayer::iterator::key() const
@@ -605,26 +789,80 @@ inline bool TileLayer::contains(QPoint point) const
     return contains(point.x(), point.y());
 }
 
+/**
+ * Returns the chunk at the given tile coordinates, creating it when it
+ * doesn't exist yet. Since the returned chunk may get modified, a chunk that
+ * was loaded lazily is decoded and its encoded data is dropped.
+ */
 inline Chunk& TileLayer::chunk(int x, int y)
 {
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
-    return mChunks[chunkCoordinates];
+    Chunk &chunk = mChunks[chunkCoordinates];
+    if (Q_UNLIKELY(chunk.hasEncodedData())) {
+        loadChunk(chunkCoordinates, chunk);
+        chunk.mEncoded.reset();
+    }
+    return chunk;
 }
 
 inline const Chunk* TileLayer::findChunk(int x, int y) const
 {
     const QPoint chunkCoordinates(x >> CHUNK_BITS, y >> CHUNK_BITS);
     auto it = mChunks.find(chunkCoordinates);
-    return it != mChunks.end() ? &it.value() : nullptr;
+    if (it == mChunks.end())
+        return nullptr;
+
+    // Chunks of lazily loaded layers are decoded on first access. Once
+    // decoded, they are only marked as used, which doesn't need locking.
+    const Chunk &chunk = it.value();
+    if (Q_UNLIKELY(mLazyGidMapper)) {
+        if (!chunk.isDecoded())
+            loadChunk(chunkCoordinates, chunk);
+        else if (chunk.mLastUsed.load(std::memory_order_relaxed) != mChunkAccessEpoch)
+            chunk.mLastUsed.store(mChunkAccessEpoch, std::memory_order_relaxed);
+    }
+    return &chunk;
+}
+
+/**
+ * Calculates the region of cells in this tile layer for which the given
+ * \a condition returns true.
+ */
+template<typename Condition>
+inline TileRegion TileLayer::tileRegion(Condition condition) const
+{
+    decodeAllChunks();
+
+    TileRegion region;
+
+    for (auto it = mChunks.constBegin(), end = mChunks.constEnd(); it != end; ++it)
+        region.uniteChunk(it.key(), it.value().cellBits(condition));
+
+    region.translate(position());
+    return region;
 }
 
 /**
  * Calculates the region occupied by the tiles of this layer. Similar to
  * Layer::bounds(), but leaves out the regions without tiles.
  */
+inline TileRegion TileLayer::tileRegion() const
+{
+    return tileRegion([] (const Cell &cell) { return !cell.isEmpty(); });
+}
+
+/**
+ * Same as tileRegion(), but returns a QRegion.
+ */
+template<typename Condition>
+inline QRegion TileLayer::region(Condition condition) const
+{
+    return tileRegion(condition).toRegion();
+}
+
 inline QRegion TileLayer::region() const
 {
-    return region([] (const Cell &cell) { return !cell.isEmpty(); });
+    return tileRegion().toRegion();
 }
 
 /**
@@ -0,0 +1,428 @@
+/*
+ * tileregion.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "tileregion.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+using namespace Tiled;
+
+namespace {
+
+using Row = TileRegion::Row;
+
+/**
+ * Returns the bits for columns \a left to \a right (inclusive) within a chunk.
+ */
+inline Row spanMask(int left, int right)
+{
+    const quint32 upTo = (quint32(2) << right) - 1;
+    const quint32 below = (quint32(1) << left) - 1;
+    return static_cast<Row>(upTo & ~below);
+}
+
+} // anonymous namespace
+
+
+bool TileRegion::ChunkBits::isEmpty() const
+{
+    for (Row row : rows)
+        if (row)
+            return false;
+    return true;
+}
+
+bool TileRegion::ChunkBits::operator==(const ChunkBits &other) const
+{
+    return std::equal(std::begin(rows), std::end(rows), std::begin(other.rows));
+}
+
+
+TileRegion::TileRegion(const QRect &rect)
+{
+    add(rect);
+}
+
+TileRegion::TileRegion(const QRegion &region)
+{
+    add(region);
+}
+
+bool TileRegion::contains(int x, int y) const
+{
+    auto it = mChunks.constFind(QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS));
+    if (it == mChunks.constEnd())
+        return false;
+
+    return it->rows[y & CHUNK_MASK] & (1u << (x & CHUNK_MASK));
+}
+
+void TileRegion::add(int x, int y)
+{
+    ChunkBits &bits = mChunks[QPoint(x >> CHUNK_BITS, y >> CHUNK_BITS)];
+    bits.rows[y & CHUNK_MASK] |= static_cast<Row>(1u << (x & CHUNK_MASK));
+}
+
+/**
+ * Adds the tiles from \a left to \a right (inclusive) on row \a y.
+ */
+void TileRegion::addSpan(int y, int left, int right)
+{
+    if (right < left)
+        return;
+
+    const int chunkY = y >> CHUNK_BITS;
+    const int row = y & CHUNK_MASK;
+    const int firstChunkX = left >> CHUNK_BITS;
+    const int lastChunkX = right >> CHUNK_BITS;
+
+    for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+        const int chunkLeft = chunkX * CHUNK_SIZE;
+        const int from = std::max(left, chunkLeft) - chunkLeft;
+        const int to = std::min(right, chunkLeft + CHUNK_MASK) - chunkLeft;
+
+        mChunks[QPoint(chunkX, chunkY)].rows[row] |= spanMask(from, to);
+    }
+}
+
+void TileRegion::add(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    const int firstChunkX = rect.left() >> CHUNK_BITS;
+    const int lastChunkX = rect.right() >> CHUNK_BITS;
+    const int firstChunkY = rect.top() >> CHUNK_BITS;
+    const int lastChunkY = rect.bottom() >> CHUNK_BITS;
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        const int chunkTop = chunkY * CHUNK_SIZE;
+        const int fromRow = std::max(rect.top(), chunkTop) - chunkTop;
+        const int toRow = std::min(rect.bottom(), chunkTop + CHUNK_MASK) - chunkTop;
+
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            const int chunkLeft = chunkX * CHUNK_SIZE;
+            const Row mask = spanMask(std::max(rect.left(), chunkLeft) - chunkLeft,
+                                      std::min(rect.right(), chunkLeft + CHUNK_MASK) - chunkLeft);
+
+            ChunkBits &bits = mChunks[QPoint(chunkX, chunkY)];
+            for (int row = fromRow; row <= toRow; ++row)
+                bits.rows[row] |= mask;
+        }
+    }
+}
+
+void TileRegion::add(const QRegion &region)
+{
+    for (const QRect &rect : region)
+        add(rect);
+}
+
+void TileRegion::remove(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+
+    const int firstChunkX = rect.left() >> CHUNK_BITS;
+    const int lastChunkX = rect.right() >> CHUNK_BITS;
+    const int firstChunkY = rect.top() >> CHUNK_BITS;
+    const int lastChunkY = rect.bottom() >> CHUNK_BITS;
+
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; ++chunkY) {
+        const int chunkTop = chunkY * CHUNK_SIZE;
+        const int fromRow = std::max(rect.top(), chunkTop) - chunkTop;
+        const int toRow = std::min(rect.bottom(), chunkTop + CHUNK_MASK) - chunkTop;
+
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; ++chunkX) {
+            auto it = mChunks.find(QPoint(chunkX, chunkY));
+            if (it == mChunks.end())
+                continue;
+
+            const int chunkLeft = chunkX * CHUNK_SIZE;
+            const Row mask = spanMask(std::max(rect.left(), chunkLeft) - chunkLeft,
+                                      std::min(rect.right(), chunkLeft + CHUNK_MASK) - chunkLeft);
+
+            for (int row = fromRow; row <= toRow; ++row)
+                it->rows[row] &= ~mask;
+
+            if (it->isEmpty())
+                mChunks.erase(it);
+        }
+    }
+}
+
+/**
+ * Adds the tiles set in \a bits to the chunk at \a chunkPosition (in chunk
+ * coordinates).
+ */
+void TileRegion::uniteChunk(QPoint chunkPosition, const ChunkBits &bits)
+{
+    if (bits.isEmpty())
+        return;
+
+    ChunkBits &target = mChunks[chunkPosition];
+    for (int row = 0; row < CHUNK_SIZE; ++row)
+        target.rows[row] |= bits.rows[row];
+}
+
+TileRegion &TileRegion::operator|=(const TileRegion &other)
+{
+    if (isEmpty()) {
+        mChunks = other.mChunks;
+        return *this;
+    }
+
+    for (auto it = other.mChunks.constBegin(); it != other.mChunks.constEnd(); ++it)
+        uniteChunk(it.key(), it.value());
+
+    return *this;
+}
+
+TileRegion &TileRegion::operator&=(const TileRegion &other)
+{
+    for (auto it = mChunks.begin(); it != mChunks.end(); ) {
+        auto otherIt = other.mChunks.constFind(it.key());
+        if (otherIt == other.mChunks.constEnd()) {
+            it = mChunks.erase(it);
+            continue;
+        }
+
+        for (int row = 0; row < CHUNK_SIZE; ++row)
+            it->rows[row] &= otherIt->rows[row];
+
+        if (it->isEmpty())
+            it = mChunks.erase(it);
+        else
+            ++it;
+    }
+
+    return *this;
+}
+
+TileRegion &TileRegion::operator-=(const TileRegion &other)
+{
+    for (auto otherIt = other.mChunks.constBegin(); otherIt != other.mChunks.constEnd(); ++otherIt) {
+        auto it = mChunks.find(otherIt.key());
+        if (it == mChunks.end())
+            continue;
+
+        for (int row = 0; row < CHUNK_SIZE; ++row)
+            it->rows[row] &= ~otherIt->rows[row];
+
+        if (it->isEmpty())
+            mChunks.erase(it);
+    }
+
+    return *this;
+}
+
+void TileRegion::translate(QPoint offset)
+{
+    if (offset.isNull() || isEmpty())
+        return;
+
+    const int chunkDx = offset.x() >> CHUNK_BITS;
+    const int chunkDy = offset.y() >> CHUNK_BITS;
+    const int shiftX = offset.x() & CHUNK_MASK;
+    const int shiftY = offset.y() & CHUNK_MASK;
+
+    QHash<QPoint, ChunkBits> translated;
+    translated.reserve(mChunks.size());
+
+    // When aligned to the chunk grid, only the chunk positions change
+    if (shiftX == 0 && shiftY == 0) {
+        for (auto it = mChunks.constBegin(); it != mChunks.constEnd(); ++it)
+            translated.insert(it.key() + QPoint(chunkDx, chunkDy), it.value());
+
+        mChunks.swap(translated);
+        return;
+    }
+
+    // Otherwise, each chunk is spread over up to four target chunks
+    for (auto it = mChunks.constBegin(); it != mChunks.constEnd(); ++it) {
+        const QPoint target = it.key() + QPoint(chunkDx, chunkDy);
+
+        for (int row = 0; row < CHUNK_SIZE; ++row) {
+            const quint32 shifted = quint32(it->rows[row]) << shiftX;
+            if (!shifted)
+                continue;
+
+            int targetRow = row + shiftY;
+            QPoint targetChunk = target;
+            if (targetRow >= CHUNK_SIZE) {
+                targetRow -= CHUNK_SIZE;
+                targetChunk.ry() += 1;
+            }
+
+            if (const Row low = static_cast<Row>(shifted))
+                translated[targetChunk].rows[targetRow] |= low;
+            if (const Row high = static_cast<Row>(shifted >> CHUNK_SIZE))
+                translated[targetChunk + QPoint(1, 0)].rows[targetRow] |= high;
+        }
+    }
+
+    mChunks.swap(translated);
+}
+
+int TileRegion::tileCount() const
+{
+    int count = 0;
+    for (const ChunkBits &bits : mChunks)
+        for (Row row : bits.rows)
+            count += qPopulationCount(row);
+    return count;
+}
+
+QRect TileRegion::boundingRect() const
+{
+    int left = std::numeric_limits<int>::max();
+    int top = std::numeric_limits<int>::max();
+    int right = std::numeric_limits<int>::min();
+    int bottom = std::numeric_limits<int>::min();
+
+    for (auto it = mChunks.constBegin(); it != mChunks.constEnd(); ++it) {
+        const QPoint chunkStart = it.key() * CHUNK_SIZE;
+
+        Row columns = 0;
+        int firstRow = CHUNK_SIZE;
+        int lastRow = -1;
+
+        for (int row = 0; row < CHUNK_SIZE; ++row) {
+            if (const Row bits = it->rows[row]) {
+                columns |= bits;
+                firstRow = std::min(firstRow, row);
+                lastRow = row;
+            }
+        }
+
+        if (!columns)
+            continue;
+
+        left = std::min(left, chunkStart.x() + int(qCountTrailingZeroBits(columns)));
+        right = std::max(right, chunkStart.x() + CHUNK_MASK - int(qCountLeadingZeroBits(columns)));
+        top = std::min(top, chunkStart.y() + firstRow);
+        bottom = std::max(bottom, chunkStart.y() + lastRow);
+    }
+
+    if (right < left)
+        return QRect();
+
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+/**
+ * Returns the rectangles making up this region, in the banded form expected
+ * by QRegion::setRects: sorted by y and then x, with rows that have the same
+ * spans merged.
+ */
+QVector<QRect> TileRegion::rects() const
+{
+    QVector<QRect> rects;
+
+    int bandStart = 0;          // index of the first rect of the current band
+    int previousY = 0;
+    int currentY = 0;
+    int currentStart = 0;       // index of the first rect of the current row
+    bool hasRow = false;
+
+    // Merges the spans just added for the current row into the previous
+    // band, when they are identical.
+    auto finishRow = [&] {
+        const int previousCount = currentStart - bandStart;
+        const int currentCount = rects.size() - currentStart;
+
+        if (currentStart > 0 && previousY == currentY - 1 && previousCount == currentCount) {
+            bool same = true;
+            for (int i = 0; i < currentCount && same; ++i) {
+                const QRect &a = rects.at(bandStart + i);
+                const QRect &b = rects.at(currentStart + i);
+                same = a.left() == b.left() && a.right() == b.right();
+            }
+
+            if (same) {
+                for (int i = bandStart; i < currentStart; ++i)
+                    rects[i].setBottom(currentY);
+                rects.resize(currentStart);
+                previousY = currentY;
+                return;
+            }
+        }
+
+        bandStart = currentStart;
+        previousY = currentY;
+    };
+
+    forEachSpan([&] (int y, int left, int right) {
+        if (!hasRow || y != currentY) {
+            if (hasRow)
+                finishRow();
+            hasRow = true;
+            currentY = y;
+            currentStart = rects.size();
+        }
+        rects.append(QRect(QPoint(left, y), QPoint(right, y)));
+    });
+
+    if (hasRow)
+        finishRow();
+
+    return rects;
+}
+
+QRegion TileRegion::toRegion() const
+{
+    const QVector<QRect> rects = this->rects();
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+bool TileRegion::operator==(const TileRegion &other) const
+{
+    return mChunks == other.mChunks;
+}
+
+QVector<QPoint> TileRegion::sortedChunkPositions() const
+{
+    QVector<QPoint> positions;
+    positions.reserve(mChunks.size());
+    for (auto it = mChunks.constBegin(); it != mChunks.constEnd(); ++it)
+        positions.append(it.key());
+
+    std::sort(positions.begin(), positions.end(), [] (QPoint a, QPoint b) {
+        return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+    });
+
+    return positions;
+}
@@ -0,0 +1,228 @@
+/*
+ * tileregion.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of libtiled.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "tiled_global.h"
+
+#include "tiled.h"
+
+#include <QHash>
+#include <QPoint>
+#include <QRect>
+#include <QRegion>
+#include <QVarLengthArray>
+#include <QVector>
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+inline uint qHash(QPoint key, uint seed = 0) Q_DECL_NOTHROW
+{
+    uint h1 = qHash(key.x(), seed);
+    uint h2 = qHash(key.y(), seed);
+    return ((h1 << 16) | (h1 >> 16)) ^ h2 ^ seed;
+}
+#endif
+
+namespace Tiled {
+
+/**
+ * A set of tile positions, stored as a bitmap for each chunk of
+ * CHUNK_SIZE x CHUNK_SIZE tiles.
+ *
+ * Compared to QRegion, adding single tiles or spans and combining regions
+ * is cheap, since it never requires merging lists of rectangles. Use
+ * toRegion() to convert to a QRegion where one is needed, for example when
+ * interfacing with the UI.
+ */
+class TILEDSHARED_EXPORT TileRegion
+{
+public:
+    using Row = quint16;
+
+    static_assert(sizeof(Row) * 8 == CHUNK_SIZE, "Row type must hold exactly one row of a chunk");
+
+    /**
+     * The occupied tiles within a single chunk, one bit per tile.
+     */
+    struct ChunkBits
+    {
+        Row rows[CHUNK_SIZE] = {};
+
+        bool isEmpty() const;
+        bool operator==(const ChunkBits &other) const;
+    };
+
+    TileRegion() = default;
+    explicit TileRegion(const QRect &rect);
+    explicit TileRegion(const QRegion &region);
+
+    bool isEmpty() const { return mChunks.isEmpty(); }
+    void clear() { mChunks.clear(); }
+
+    bool contains(int x, int y) const;
+    bool contains(QPoint point) const { return contains(point.x(), point.y()); }
+
+    void add(int x, int y);
+    void add(QPoint point) { add(point.x(), point.y()); }
+    void addSpan(int y, int left, int right);
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+
+    void remove(const QRect &rect);
+
+    void uniteChunk(QPoint chunkPosition, const ChunkBits &bits);
+
+    TileRegion &operator|=(const TileRegion &other);
+    TileRegion &operator&=(const TileRegion &other);
+    TileRegion &operator-=(const TileRegion &other);
+
+    TileRegion united(const TileRegion &other) const;
+    TileRegion intersected(const TileRegion &other) const;
+    TileRegion subtracted(const TileRegion &other) const;
+
+    void translate(QPoint offset);
+    TileRegion translated(QPoint offset) const;
+
+    int tileCount() const;
+    QRect boundingRect() const;
+
+    /**
+     * Calls \a function with (y, left, right) for each horizontal span of
+     * tiles, ordered by row and then by column.
+     */
+    template<typename Function>
+    void forEachSpan(Function function) const;
+
+    QVector<QRect> rects() const;
+    QRegion toRegion() const;
+
+    bool operator==(const TileRegion &other) const;
+    bool operator!=(const TileRegion &other) const { return !(*this == other); }
+
+private:
+    QVector<QPoint> sortedChunkPositions() const;
+
+    QHash<QPoint, ChunkBits> mChunks;
+};
+
+
+inline TileRegion TileRegion::united(const TileRegion &other) const
+{
+    TileRegion result(*this);
+    result |= other;
+    return result;
+}
+
+inline TileRegion TileRegion::intersected(const TileRegion &other) const
+{
+    TileRegion result(*this);
+    result &= other;
+    return result;
+}
+
+inline TileRegion TileRegion::subtracted(const TileRegion &other) const
+{
+    TileRegion result(*this);
+    result -= other;
+    return result;
+}
+
+inline TileRegion TileRegion::translated(QPoint offset) const
+{
+    TileRegion result(*this);
+    result.translate(offset);
+    return result;
+}
+
+template<typename Function>
+void TileRegion::forEachSpan(Function function) const
+{
+    const QVector<QPoint> positions = sortedChunkPositions();
+
+    // Process one row of chunks at a time, to report the spans in order
+    for (int begin = 0; begin < positions.size(); ) {
+        const int chunkY = positions.at(begin).y();
+        int end = begin + 1;
+        while (end < positions.size() && positions.at(end).y() == chunkY)
+            ++end;
+
+        QVarLengthArray<const ChunkBits*, 16> chunks;
+        for (int i = begin; i < end; ++i)
+            chunks.append(&mChunks.constFind(positions.at(i)).value());
+
+        for (int row = 0; row < CHUNK_SIZE; ++row) {
+            const int y = chunkY * CHUNK_SIZE + row;
+
+            bool spanOpen = false;
+            int spanLeft = 0;
+            int spanRight = 0;
+
+            for (int i = begin; i < end; ++i) {
+                const int chunkLeft = positions.at(i).x() * CHUNK_SIZE;
+                Row bits = chunks.at(i - begin)->rows[row];
+
+                // Continue a span from the previous chunk
+                if (spanOpen && (spanRight != chunkLeft - 1 || !(bits & 1))) {
+                    function(y, spanLeft, spanRight);
+                    spanOpen = false;
+                }
+
+                int x = 0;
+                while (bits) {
+                    // Skip the unset bits, then find the end of the set ones
+                    while (!(bits & 1)) {
+                        bits >>= 1;
+                        ++x;
+                    }
+                    const int start = x;
+                    while (bits & 1) {
+                        bits >>= 1;
+                        ++x;
+                    }
+
+                    if (spanOpen && start == 0) {
+                        spanRight = chunkLeft + x - 1;
+                    } else {
+                        if (spanOpen)
+                            function(y, spanLeft, spanRight);
+                        spanOpen = true;
+                        spanLeft = chunkLeft + start;
+                        spanRight = chunkLeft + x - 1;
+                    }
+                }
+            }
+
+            if (spanOpen)
+                function(y, spanLeft, spanRight);
+        }
+
+        begin = end;
+    }
+}
+
+} // namespace Tiled
@@ -122,7 +122,7 @@ Tile *Tileset::findOrCreateTile(int id)
     mNextTileId = std::max(mNextTileId, id + 1);
 
     auto tile = new Tile(id, this);
-    mTilesById[id] = tile;
+    insertTile(tile);
     mTiles.append(tile);
 
     return tile;
@@ -222,7 +222,7 @@ bool Tileset::loadFromImage(const QImage &image, const QUrl &source)
                 it.value()->setImage(tilePixmap);
             } else {
                 auto tile = new Tile(tilePixmap, tileNum, this);
-                mTilesById.insert(tileNum, tile);
+                insertTile(tile);
                 mTiles.insert(tileNum, tile);
             }
 
@@ -308,7 +308,7 @@ bool Tileset::loadImage()
             it.value()->setImage(tiles.at(tileNum));
         } else {
             auto tile = new Tile(tiles.at(tileNum), tileNum, this);
-            mTilesById.insert(tileNum, tile);
+            insertTile(tile);
             mTiles.insert(tileNum, tile);
         }
     }
@@ -476,7 +476,7 @@ Tile *Tileset::addTile(const QPixmap &image, const QUrl &source)
     newTile->setImage(image);
     newTile->setImageSource(source);
 
-    mTilesById.insert(newTile->id(), newTile);
+    insertTile(newTile);
     mTiles.append(newTile);
     if (mTileHeight < image.height())
         mTileHeight = image.height();
@@ -494,7 +494,7 @@ void Tileset::addTiles(const QList<Tile *> &tiles)
 {
     for (Tile *tile : tiles) {
         Q_ASSERT(tile->tileset() == this && !mTilesById.contains(tile->id()));
-        mTilesById.insert(tile->id(), tile);
+        insertTile(tile);
         mTiles.append(tile);
     }
 
@@ -510,7 +510,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
 {
     for (Tile *tile : tiles) {
         Q_ASSERT(tile->tileset() == this && mTilesById.contains(tile->id()));
-        mTilesById.remove(tile->id());
+        takeTile(tile->id());
         mTiles.removeOne(tile);
     }
 
@@ -522,7 +522,7 @@ void Tileset::removeTiles(const QList<Tile *> &tiles)
  */
 void Tileset::deleteTile(int id)
 {
-    auto tile = mTilesById.take(id);
+    auto tile = takeTile(id);
     mTiles.removeOne(tile);
     delete tile;
 }
@@ -631,6 +631,7 @@ void Tileset::swap(Tileset &other)
     std::swap(mExpectedColumnCount, other.mExpectedColumnCount);
     std::swap(mExpectedRowCount, other.mExpectedRowCount);
     std::swap(mTilesById, other.mTilesById);
+    std::swap(mTileArray, other.mTileArray);
     std::swap(mTiles, other.mTiles);
     std::swap(mNextTileId, other.mNextTileId);
     std::swap(mWangSets, other.mWangSets);
@@ -677,6 +678,8 @@ SharedTileset Tileset::clone() const
         c->mTiles.append(clonedTile);
     }
 
+    c->rebuildTileArray();
+
     c->mWangSets.reserve(mWangSets.size());
     for (WangSet *wangSet : mWangSets)
         c->mWangSets.append(wangSet->clone(c.data()));
@@ -706,6 +709,66 @@ void Tileset::updateTileSize()
     mTileHeight = maxHeight;
 }
 
+/**
+ * Returns the size up to which the tile array may grow. It is kept at least
+ * half full, so that sparse tile IDs don't waste memory.
+ */
+static int maxTileArraySize(int tileCount)
+{
+    return std::max(64, tileCount * 2);
+}
+
+/**
+ * Adds the given \a tile to the lookup structures. Does not add it to the
+ * list of tiles.
+ */
+void Tileset::insertTile(Tile *tile)
+{
+    const int id = tile->id();
+    mTilesById.insert(id, tile);
+
+    if (id >= mTileArray.size() && id < maxTileArraySize(mTilesById.size())) {
+        const int previousSize = mTileArray.size();
+        mTileArray.resize(id + 1);
+
+        // Tiles that did not fit in the array before need to be added now
+        for (auto it = mTilesById.lowerBound(previousSize); it.key() < id; ++it)
+            mTileArray[it.key()] = it.value();
+    }
+    if (id >= 0 && id < mTileArray.size())
+        mTileArray[id] = tile;
+}
+
+/**
+ * Removes the tile with the given \a id from the lookup structures and
+ * returns it. Does not remove it from the list of tiles.
+ */
+Tile *Tileset::takeTile(int id)
+{
+    if (id >= 0 && id < mTileArray.size())
+        mTileArray[id] = nullptr;
+    return mTilesById.take(id);
+}
+
+void Tileset::rebuildTileArray()
+{
+    mTileArray.clear();
+
+    if (mTilesById.isEmpty())
+        return;
+
+    // Only include the IDs up to the point where the array gets too sparse
+    const int arraySize = std::min(mTilesById.lastKey() + 1,
+                                   maxTileArraySize(mTilesById.size()));
+    if (arraySize <= 0)
+        return;
+
+    mTileArray.resize(arraySize);
+    for (auto it = mTilesById.cbegin(), end = qAsConst(mTilesById).lowerBound(arraySize); it != end; ++it)
+        if (it.key() >= 0)
+            mTileArray[it.key()] = it.value();
+}
+
 
 QString Tileset::orientationToString(Tileset::Orientation orientation)
 {
@@ -255,6 +255,10 @@ public:
 private:
     void updateTileSize();
 
+    void insertTile(Tile *tile);
+    Tile *takeTile(int id);
+    void rebuildTileArray();
+
     QString mName;
     QString mFileName;
     ImageReference mImageReference;
@@ -271,6 +275,7 @@ private:
     int mExpectedRowCount = 0;
     int mNextTileId = 0;
     QMap<int, Tile*> mTilesById;
+    QVector<Tile*> mTileArray;          // dense lookup for the lower tile IDs
     QList<Tile*> mTiles;
     QList<WangSet*> mWangSets;
     LoadingStatus mStatus = LoadingReady;
@@ -445,9 +450,15 @@ inline const QList<Tile*> &Tileset::tiles() const
 /**
  * Returns the tile with the given tile ID. The tile IDs are local to this
  * tileset.
+ *
+ * Most tile IDs are looked up in an array. Only the IDs beyond the array,
+ * which can happen for image collection tilesets from which tiles were
+ * removed, are looked up in the map.
  */
 inline Tile *Tileset::findTile(int id) const
 {
+    if (static_cast<unsigned>(id) < static_cast<unsigned>(mTileArray.size()))
+        return mTileArray.at(id);
     return mTilesById.value(id);
 }
 
@@ -35,6 +35,11 @@
 #include "tileanimationdriver.h"
 #include "tilesetformat.h"
 
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QThread>
+
 namespace Tiled {
 
 TilesetManager *TilesetManager::mInstance;
@@ -66,9 +71,18 @@ TilesetManager::~TilesetManager()
  */
 TilesetManager *TilesetManager::instance()
 {
-    if (!mInstance)
+    static QBasicMutex instanceMutex;
+    QMutexLocker locker(&instanceMutex);
+
+    if (!mInstance) {
         mInstance = new TilesetManager;
 
+        // The manager needs to live on the main thread, even when it is first
+        // used by a worker thread, since it owns the file system watcher.
+        if (auto app = QCoreApplication::instance())
+            mInstance->moveToThread(app->thread());
+    }
+
     return mInstance;
 }
 
@@ -81,19 +95,75 @@ void TilesetManager::deleteInstance()
     mInstance = nullptr;
 }
 
+static QString canonicalTilesetPath(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString canonicalPath = fileInfo.canonicalFilePath();
+    if (!canonicalPath.isEmpty())
+        return canonicalPath;
+    return QDir::cleanPath(fileInfo.absoluteFilePath());
+}
+
 /**
  * Loads the tileset with the given \a fileName. If the tileset is already
  * loaded, returns that instance.
  *
+ * This function may be called from any thread. When several threads request
+ * the same tileset at the same time, it is only loaded once.
+ *
  * When an error occurs during loading it is assigned to the optional \a error
  * parameter.
  */
 SharedTileset TilesetManager::loadTileset(const QString &fileName, QString *error)
 {
-    SharedTileset tileset = findTileset(fileName);
+    const QString canonicalPath = canonicalTilesetPath(fileName);
+
+    // Declared before the locker, so that it is released without holding the
+    // lock (the destructor of Tileset calls removeTileset).
+    SharedTileset tileset;
+
+    QMutexLocker locker(&mMutex);
+
+    // Wait when another thread is already loading this tileset. When it is
+    // this thread, we're dealing with a recursive reference (possible through
+    // metatile maps), which is left to be detected by the ImageCache.
+    QThread *currentThread = QThread::currentThread();
+    bool recursive = false;
+
+    while (QThread *loadingThread = mLoadingTilesets.value(canonicalPath)) {
+        if (loadingThread == currentThread) {
+            recursive = true;
+            break;
+        }
+        mTilesetLoaded.wait(&mMutex);
+    }
+
+    const auto it = mLoadedTilesets.constFind(canonicalPath);
+    if (it != mLoadedTilesets.constEnd()) {
+        tileset = it->tileset.toStrongRef();
+
+        // Make sure it wasn't saved elsewhere in the meantime
+        if (tileset && tileset->fileName() == it->fileName)
+            return tileset;
+    }
+
+    if (!recursive)
+        mLoadingTilesets.insert(canonicalPath, currentThread);
+    locker.unlock();
+
+    tileset = findTileset(fileName);
     if (!tileset)
         tileset = readTileset(fileName, error);
 
+    locker.relock();
+
+    if (!recursive)
+        mLoadingTilesets.remove(canonicalPath);
+    if (tileset)
+        mLoadedTilesets.insert(canonicalPath, { tileset, tileset->fileName() });
+
+    mTilesetLoaded.wakeAll();
+
     return tileset;
 }
 
@@ -103,9 +173,15 @@ SharedTileset TilesetManager::loadTileset(const QString &fileName, QString *erro
  */
 SharedTileset TilesetManager::findTileset(const QString &fileName) const
 {
-    for (Tileset *tileset : mTilesets)
-        if (tileset->fileName() == fileName)
-            return tileset->sharedFromThis();
+    QMutexLocker locker(&mMutex);
+
+    for (Tileset *tileset : mTilesets) {
+        if (tileset->fileName() == fileName) {
+            // May be null when the tileset is being destroyed
+            if (SharedTileset sharedTileset = tileset->sharedFromThis())
+                return sharedTileset;
+        }
+    }
 
     return SharedTileset();
 }
@@ -116,6 +192,8 @@ SharedTileset TilesetManager::findTileset(const QString &fileName) const
  */
 void TilesetManager::addTileset(Tileset *tileset)
 {
+    QMutexLocker locker(&mMutex);
+
     Q_ASSERT(!mTilesets.contains(tileset));
     mTilesets.append(tileset);
 }
@@ -126,11 +204,15 @@ void TilesetManager::addTileset(Tileset *tileset)
  */
 void TilesetManager::removeTileset(Tileset *tileset)
 {
-    Q_ASSERT(mTilesets.contains(tileset));
-    mTilesets.removeOne(tileset);
+    {
+        QMutexLocker locker(&mMutex);
+
+        Q_ASSERT(mTilesets.contains(tileset));
+        mTilesets.removeOne(tileset);
+    }
 
     if (tileset->imageSource().isLocalFile())
-        mWatcher->removePath(tileset->imageSource().toLocalFile());
+        updateWatchedImage(tileset->imageSource().toLocalFile(), QString());
 }
 
 /**
@@ -138,8 +220,11 @@ void TilesetManager::removeTileset(Tileset *tileset)
  */
 void TilesetManager::reloadImages(Tileset *tileset)
 {
-    if (!mTilesets.contains(tileset))
-        return;
+    {
+        QMutexLocker locker(&mMutex);
+        if (!mTilesets.contains(tileset))
+            return;
+    }
 
     if (tileset->isCollection()) {
         for (Tile *tile : tileset->tiles()) {
@@ -190,13 +275,56 @@ bool TilesetManager::animateTiles() const
 void TilesetManager::tilesetImageSourceChanged(const Tileset &tileset,
                                                const QUrl &oldImageSource)
 {
-    Q_ASSERT(mTilesets.contains(const_cast<Tileset*>(&tileset)));
+    QString oldFileName;
+    QString newFileName;
 
     if (oldImageSource.isLocalFile())
-        mWatcher->removePath(oldImageSource.toLocalFile());
+        oldFileName = oldImageSource.toLocalFile();
 
     if (tileset.imageSource().isLocalFile())
-        mWatcher->addPath(tileset.imageSource().toLocalFile());
+        newFileName = tileset.imageSource().toLocalFile();
+
+    updateWatchedImage(oldFileName, newFileName);
+}
+
+/**
+ * Updates the watched tileset images. When called from a worker thread, the
+ * update is queued to the thread of the manager, since the file system
+ * watcher is not thread-safe.
+ */
+void TilesetManager::updateWatchedImage(const QString &oldFileName,
+                                        const QString &newFileName)
+{
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [=] {
+            updateWatchedImage(oldFileName, newFileName);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (!oldFileName.isEmpty())
+        mWatcher->removePath(oldFileName);
+
+    if (!newFileName.isEmpty())
+        mWatcher->addPath(newFileName);
+}
+
+/**
+ * Returns strong references to all tilesets, excluding those that are still
+ * being constructed or already being destroyed on other threads.
+ */
+QVector<SharedTileset> TilesetManager::liveTilesets() const
+{
+    QMutexLocker locker(&mMutex);
+
+    QVector<SharedTileset> tilesets;
+    tilesets.reserve(mTilesets.size());
+
+    for (Tileset *tileset : mTilesets)
+        if (SharedTileset sharedTileset = tileset->sharedFromThis())
+            tilesets.append(sharedTileset);
+
+    return tilesets;
 }
 
 void TilesetManager::filesChanged(const QStringList &fileNames)
@@ -207,11 +335,12 @@ void TilesetManager::filesChanged(const QStringList &fileNames)
     for (const QString &fileName : fileNames)
         ImageCache::remove(fileName);
 
-    for (Tileset *tileset : qAsConst(mTilesets)) {
+    const auto tilesets = liveTilesets();
+    for (const SharedTileset &tileset : tilesets) {
         const QString fileName = tileset->imageSource().toLocalFile();
         if (fileNames.contains(fileName))
             if (tileset->loadImage())
-                emit tilesetImagesChanged(tileset);
+                emit tilesetImagesChanged(tileset.data());
     }
 }
 
@@ -226,14 +355,15 @@ void TilesetManager::resetTileAnimations()
     // TODO: This could be more optimal by keeping track of the list of
     // actually animated tiles
 
-    for (Tileset *tileset : qAsConst(mTilesets)) {
+    const auto tilesets = liveTilesets();
+    for (const SharedTileset &tileset : tilesets) {
         bool imageChanged = false;
 
         for (Tile *tile : tileset->tiles())
             imageChanged |= tile->resetAnimation();
 
         if (imageChanged)
-            emit repaintTileset(tileset);
+            emit repaintTileset(tileset.data());
     }
 }
 
@@ -242,14 +372,15 @@ void TilesetManager::advanceTileAnimations(int ms)
     // TODO: This could be more optimal by keeping track of the list of
     // actually animated tiles
 
-    for (Tileset *tileset : qAsConst(mTilesets)) {
+    const auto tilesets = liveTilesets();
+    for (const SharedTileset &tileset : tilesets) {
         bool imageChanged = false;
 
         for (Tile *tile : tileset->tiles())
             imageChanged |= tile->advanceAnimation(ms);
 
         if (imageChanged)
-            emit repaintTileset(tileset);
+            emit repaintTileset(tileset.data());
     }
 }
 
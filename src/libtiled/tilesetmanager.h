@@ -31,9 +31,12 @@
 
 #include "tileset.h"
 
-#include <QObject>
+#include <QHash>
 #include <QList>
+#include <QMutex>
+#include <QObject>
 #include <QString>
+#include <QWaitCondition>
 
 namespace Tiled {
 
@@ -44,6 +47,9 @@ class TileAnimationDriver;
  * The tileset manager keeps track of all tilesets used by loaded maps. It also
  * watches the tileset images for changes and will attempt to reload them when
  * they change.
+ *
+ * Tilesets can be loaded from any thread. Each external tileset is parsed
+ * only once, even when several threads request it at the same time.
  */
 class TILEDSHARED_EXPORT TilesetManager : public QObject
 {
@@ -93,10 +99,37 @@ signals:
 private:
     void filesChanged(const QStringList &fileNames);
 
+    QVector<SharedTileset> liveTilesets() const;
+    void updateWatchedImage(const QString &oldFileName, const QString &newFileName);
+
+    struct LoadedTileset
+    {
+        QWeakPointer<Tileset> tileset;
+        QString fileName;
+    };
+
+    /**
+     * Protects mTilesets, mLoadedTilesets and mLoadingTilesets.
+     */
+    mutable QMutex mMutex;
+    QWaitCondition mTilesetLoaded;
+
     /**
      * The list of loaded tilesets (weak references).
      */
     QList<Tileset*> mTilesets;
+
+    /**
+     * The external tilesets loaded through loadTileset(), by canonical path.
+     */
+    QHash<QString, LoadedTileset> mLoadedTilesets;
+
+    /**
+     * The canonical paths of the tilesets currently being loaded, and the
+     * threads loading them.
+     */
+    QHash<QString, QThread*> mLoadingTilesets;
+
     FileSystemWatcher *mWatcher;
     TileAnimationDriver *mAnimationDriver;
     bool mReloadTilesetsOnChange;
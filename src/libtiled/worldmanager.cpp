@@ -42,8 +42,27 @@
 
 #include <QDebug>
 
+#include <algorithm>
+
 namespace Tiled {
 
+static quint64 gridKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+// Division rounding towards negative infinity, for a positive divisor
+static int floorDiv(int value, int divisor)
+{
+    int quotient = value / divisor;
+    if (value % divisor != 0 && value < 0)
+        --quotient;
+    return quotient;
+}
+
+// Maps covering more grid cells are not added to the grid, but always checked
+static constexpr qint64 MaxGridCellsPerMap = 1024;
+
 WorldManager *WorldManager::mInstance;
 
 WorldManager::WorldManager()
@@ -51,6 +70,8 @@ WorldManager::WorldManager()
     mIgnoreFileChangeEventForFile.clear();
     connect(&mFileSystemWatcher, &FileSystemWatcher::pathsChanged,
             this, &WorldManager::reloadWorldFiles);
+    connect(&mDirectoryWatcher, &FileSystemWatcher::pathsChanged,
+            this, &WorldManager::directoriesChanged);
 }
 
 WorldManager::~WorldManager()
@@ -89,7 +110,9 @@ void WorldManager::reloadWorldFiles(const QStringList &fileNames)
             if (world) {
                 std::unique_ptr<World> oldWorld { mWorlds.take(fileName) };
                 oldWorld->clearErrorsAndWarnings();
+                unwatchDirectory(oldWorld.get());
 
+                watchDirectory(world.get());
                 mWorlds.insert(fileName, world.release());
 
                 changed = true;
@@ -243,11 +266,14 @@ World *WorldManager::loadAndStoreWorld(const QString &fileName, QString *errorSt
     if (!world)
         return nullptr;
 
-    if (mWorlds.contains(fileName))
-        delete mWorlds.take(fileName);
-    else
+    if (World *oldWorld = mWorlds.take(fileName)) {
+        unwatchDirectory(oldWorld);
+        delete oldWorld;
+    } else {
         mFileSystemWatcher.addPath(fileName);
+    }
 
+    watchDirectory(world.get());
     mWorlds.insert(fileName, world.release());
 
     return mWorlds.value(fileName);
@@ -332,6 +358,7 @@ void WorldManager::unloadWorld(const QString &fileName)
     std::unique_ptr<World> world { mWorlds.take(fileName) };
     if (world) {
         mFileSystemWatcher.removePath(fileName);
+        unwatchDirectory(world.get());
         emit worldsChanged();
         emit worldUnloaded(fileName);
     }
@@ -355,9 +382,41 @@ void WorldManager::unloadAllWorlds()
     }
 
     mFileSystemWatcher.clear();
+    mDirectoryWatcher.clear();
     emit worldsChanged();
 }
 
+/**
+ * Watches the directory of worlds using patterns, so that the maps matching
+ * the patterns are only looked up again when the directory changed.
+ */
+void WorldManager::watchDirectory(const World *world)
+{
+    if (!world->patterns.isEmpty())
+        mDirectoryWatcher.addPath(QFileInfo(world->fileName).path());
+}
+
+void WorldManager::unwatchDirectory(const World *world)
+{
+    if (!world->patterns.isEmpty())
+        mDirectoryWatcher.removePath(QFileInfo(world->fileName).path());
+}
+
+void WorldManager::directoriesChanged(const QStringList &paths)
+{
+    bool changed = false;
+
+    for (World *world : qAsConst(mWorlds)) {
+        if (!world->patterns.isEmpty() && paths.contains(QFileInfo(world->fileName).path())) {
+            world->invalidateMapIndex();
+            changed = true;
+        }
+    }
+
+    if (changed)
+        emit worldsChanged();
+}
+
 const World *WorldManager::worldForMap(const QString &fileName) const
 {
     for (auto world : mWorlds)
@@ -434,11 +493,13 @@ bool WorldManager::addMap(const QString &fileName, const QString &mapFileName, c
 void World::setMapRect(int mapIndex, const QRect &rect)
 {
     maps[mapIndex].rect = rect;
+    mMapIndexValid = false;
 }
 
 void World::removeMap(int mapIndex)
 {
     maps.removeAt(mapIndex);
+    mMapIndexValid = false;
 }
 
 void World::addMap(const QString &fileName, const QRect &rect)
@@ -447,23 +508,28 @@ void World::addMap(const QString &fileName, const QRect &rect)
     entry.rect = rect;
     entry.fileName = fileName;
     maps.append(entry);
+    mMapIndexValid = false;
 }
 
+/**
+ * Returns the index of the given map in the explicitly listed \a maps, or -1
+ * when it is not listed.
+ */
 int World::mapIndex(const QString &fileName) const
 {
-    for (int i = 0; i < maps.length(); i++) {
-        if (maps[i].fileName == fileName)
-            return i;
-    }
-    return -1;
+    ensureMapIndex();
+
+    // The explicitly listed maps come first in the index
+    const int index = mMapIndexByFileName.value(fileName, -1);
+    return index < maps.size() ? index : -1;
 }
 
 bool World::containsMap(const QString &fileName) const
 {
-    for (const World::MapEntry &mapEntry : maps) {
-        if (mapEntry.fileName == fileName)
-            return true;
-    }
+    ensureMapIndex();
+
+    if (mMapIndexByFileName.contains(fileName))
+        return true;
 
     // Currently patterns can only be used to search for maps in the same
     // folder as the .world file. It could be useful to support a "prefix" or
@@ -471,6 +537,7 @@ bool World::containsMap(const QString &fileName) const
     if (QFileInfo(this->fileName).path() != QFileInfo(fileName).path())
         return false;
 
+    // Also check the patterns for files that were not found in the directory
     for (const World::Pattern &pattern : patterns) {
         QRegularExpressionMatch match = pattern.regexp.match(fileName);
         if (match.hasMatch())
@@ -480,74 +547,89 @@ bool World::containsMap(const QString &fileName) const
     return false;
 }
 
-QRect World::mapRect(const QString &fileName) const
+static QRect patternMapRect(const World::Pattern &pattern,
+                            const QRegularExpressionMatch &match)
 {
-    for (const World::MapEntry &mapEntry : maps) {
-       if (mapEntry.fileName == fileName)
-            return mapEntry.rect;
-    }
-
-    for (const World::Pattern &pattern : patterns) {
-        QRegularExpressionMatch match = pattern.regexp.match(fileName);
-        if (match.hasMatch()) {
 #if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-            const int x = match.capturedView(1).toInt();
-            const int y = match.capturedView(2).toInt();
+    const int x = match.capturedView(1).toInt();
+    const int y = match.capturedView(2).toInt();
 #else
-            const int x = match.capturedRef(1).toInt();
-            const int y = match.capturedRef(2).toInt();
+    const int x = match.capturedRef(1).toInt();
+    const int y = match.capturedRef(2).toInt();
 #endif
 
-            return QRect(QPoint(x * pattern.multiplierX,
-                                y * pattern.multiplierY) + pattern.offset,
-                         pattern.mapSize);
-        }
+    return QRect(QPoint(x * pattern.multiplierX,
+                        y * pattern.multiplierY) + pattern.offset,
+                 pattern.mapSize);
+}
+
+QRect World::mapRect(const QString &fileName) const
+{
+    ensureMapIndex();
+
+    const int index = mMapIndexByFileName.value(fileName, -1);
+    if (index != -1)
+        return mAllMaps.at(index).rect;
+
+    for (const World::Pattern &pattern : patterns) {
+        QRegularExpressionMatch match = pattern.regexp.match(fileName);
+        if (match.hasMatch())
+            return patternMapRect(pattern, match);
     }
 
     return QRect();
 }
 
+/**
+ * Returns all maps in this world, including the ones matching any of the
+ * patterns. The directory is only listed again after it changed.
+ */
 QVector<World::MapEntry> World::allMaps() const
 {
-    QVector<World::MapEntry> all(maps);
+    ensureMapIndex();
+    return mAllMaps;
+}
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+QVector<World::MapEntry> World::mapsInRect(const QRect &rect) const
+{
+    ensureMapIndex();
 
-        for (const World::Pattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch()) {
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-                    const int x = match.capturedView(1).toInt();
-                    const int y = match.capturedView(2).toInt();
-#else
-                    const int x = match.capturedRef(1).toInt();
-                    const int y = match.capturedRef(2).toInt();
-#endif
+    QVector<World::MapEntry> maps;
 
-                    MapEntry entry;
-                    entry.fileName = dir.filePath(fileName);
-                    entry.rect = QRect(QPoint(x * pattern.multiplierX,
-                                              y * pattern.multiplierY) + pattern.offset,
-                                       pattern.mapSize);
-                    all.append(entry);
-                }
-            }
-        }
+    if (rect.isEmpty() || mAllMaps.isEmpty())
+        return maps;
+
+    const int left = floorDiv(rect.left(), mGridCellSize.width());
+    const int top = floorDiv(rect.top(), mGridCellSize.height());
+    const int right = floorDiv(rect.right(), mGridCellSize.width());
+    const int bottom = floorDiv(rect.bottom(), mGridCellSize.height());
+
+    // For very large areas, checking each map is faster than each grid cell
+    if ((qint64(right) - left + 1) * (qint64(bottom) - top + 1) > mAllMaps.size()) {
+        for (const MapEntry &mapEntry : qAsConst(mAllMaps))
+            if (mapEntry.rect.intersects(rect))
+                maps.append(mapEntry);
+        return maps;
     }
 
-    return all;
-}
+    QVector<int> indexes = mLargeMapIndexes;
+    for (int y = top; y <= bottom; ++y) {
+        for (int x = left; x <= right; ++x) {
+            const auto it = mGrid.constFind(gridKey(x, y));
+            if (it != mGrid.constEnd())
+                indexes.append(*it);
+        }
+    }
 
-QVector<World::MapEntry> World::mapsInRect(const QRect &rect) const
-{
-    QVector<World::MapEntry> maps(allMaps());
+    // Report each map once, in the same order as allMaps()
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
 
-    maps.erase(std::remove_if(maps.begin(), maps.end(),
-                              [&](const World::MapEntry &mapEntry) { return !mapEntry.rect.intersects(rect); }),
-               maps.end());
+    for (int index : qAsConst(indexes)) {
+        const MapEntry &mapEntry = mAllMaps.at(index);
+        if (mapEntry.rect.intersects(rect))
+            maps.append(mapEntry);
+    }
 
     return maps;
 }
@@ -564,20 +646,108 @@ QString World::firstMap() const
     if (!maps.isEmpty())
         return maps.first().fileName;
 
-    if (!patterns.isEmpty()) {
-        const QDir dir(QFileInfo(fileName).dir());
-        const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+    ensureMapIndex();
+
+    if (!mPatternMaps.isEmpty())
+        return mPatternMaps.first().fileName;
+
+    return QString();
+}
+
+/**
+ * Makes sure the maps matching the patterns are looked up again, for
+ * example because the contents of the directory changed.
+ */
+void World::invalidateMapIndex()
+{
+    mPatternMapsValid = false;
+    mMapIndexValid = false;
+}
+
+void World::ensureMapIndex() const
+{
+    if (mMapIndexValid)
+        return;
 
-        for (const World::Pattern &pattern : patterns) {
-            for (const QString &fileName : entries) {
-                QRegularExpressionMatch match = pattern.regexp.match(fileName);
-                if (match.hasMatch())
-                    return dir.filePath(fileName);
+    if (!mPatternMapsValid) {
+        mPatternMaps.clear();
+
+        if (!patterns.isEmpty()) {
+            const QDir dir(QFileInfo(fileName).dir());
+            const QStringList entries = dir.entryList(QDir::Files | QDir::Readable);
+
+            for (const World::Pattern &pattern : patterns) {
+                for (const QString &fileName : entries) {
+                    QRegularExpressionMatch match = pattern.regexp.match(fileName);
+                    if (match.hasMatch()) {
+                        MapEntry entry;
+                        entry.fileName = dir.filePath(fileName);
+                        entry.rect = patternMapRect(pattern, match);
+                        mPatternMaps.append(entry);
+                    }
+                }
             }
         }
+
+        mPatternMapsValid = true;
     }
 
-    return QString();
+    mAllMaps = maps + mPatternMaps;
+
+    mMapIndexByFileName.clear();
+    mMapIndexByFileName.reserve(mAllMaps.size());
+
+    // Iterate backwards, so that the first entry for each file wins
+    for (int i = mAllMaps.size() - 1; i >= 0; --i)
+        mMapIndexByFileName.insert(mAllMaps.at(i).fileName, i);
+
+    // Use the average map size as grid cell size
+    qint64 totalWidth = 0;
+    qint64 totalHeight = 0;
+    int count = 0;
+    for (const MapEntry &mapEntry : qAsConst(mAllMaps)) {
+        if (mapEntry.rect.isEmpty())
+            continue;
+        totalWidth += mapEntry.rect.width();
+        totalHeight += mapEntry.rect.height();
+        ++count;
+    }
+
+    mGrid.clear();
+    mLargeMapIndexes.clear();
+
+    if (count > 0) {
+        mGridCellSize = QSize(qMax<qint64>(1, totalWidth / count),
+                              qMax<qint64>(1, totalHeight / count));
+
+        for (int i = 0; i < mAllMaps.size(); ++i)
+            addToGrid(i);
+    }
+
+    mMapIndexValid = true;
+}
+
+void World::addToGrid(int index) const
+{
+    const QRect &rect = mAllMaps.at(index).rect;
+
+    // Maps without a size never intersect any area
+    if (rect.isEmpty())
+        return;
+
+    const int left = floorDiv(rect.left(), mGridCellSize.width());
+    const int top = floorDiv(rect.top(), mGridCellSize.height());
+    const int right = floorDiv(rect.right(), mGridCellSize.width());
+    const int bottom = floorDiv(rect.bottom(), mGridCellSize.height());
+
+    if ((qint64(right) - left + 1) * (qint64(bottom) - top + 1) > MaxGridCellsPerMap) {
+        mLargeMapIndexes.append(index);
+        return;
+    }
+
+    for (int y = top; y <= bottom; ++y)
+        for (int x = left; x <= right; ++x)
+            mGrid[gridKey(x, y)].append(index);
 }
 
 void World::error(const QString &message) const
@@ -33,6 +33,7 @@
 #include "filesystemwatcher.h"
 
 #include <QCoreApplication>
+#include <QHash>
 #include <QMap>
 #include <QObject>
 #include <QPoint>
@@ -63,7 +64,7 @@ struct TILEDSHARED_EXPORT World
     };
 
     QString fileName;
-    QVector<MapEntry> maps;
+    QVector<MapEntry> maps;             // modify only through the functions below
     QVector<Pattern> patterns;
     bool onlyShowAdjacentMaps;
 
@@ -90,6 +91,26 @@ struct TILEDSHARED_EXPORT World
      */
     QString displayName() const;
     static QString displayName(const QString &fileName);
+
+    void invalidateMapIndex();
+
+private:
+    void ensureMapIndex() const;
+    void addToGrid(int index) const;
+
+    /*
+     * Lookup structures, built on demand. The maps matched by the patterns
+     * require listing the directory, so they are only refreshed when the
+     * directory changed (see invalidateMapIndex).
+     */
+    mutable bool mPatternMapsValid = false;
+    mutable bool mMapIndexValid = false;
+    mutable QVector<MapEntry> mPatternMaps;
+    mutable QVector<MapEntry> mAllMaps;
+    mutable QHash<QString, int> mMapIndexByFileName;
+    mutable QHash<quint64, QVector<int>> mGrid;
+    mutable QVector<int> mLargeMapIndexes;
+    mutable QSize mGridCellSize;
 };
 
 class TILEDSHARED_EXPORT WorldManager : public QObject
@@ -131,9 +152,14 @@ private:
     std::unique_ptr<World> privateLoadWorld(const QString &fileName,
                                             QString *errorString = nullptr);
 
+    void watchDirectory(const World *world);
+    void unwatchDirectory(const World *world);
+    void directoriesChanged(const QStringList &paths);
+
     QMap<QString, World*> mWorlds;
 
     FileSystemWatcher mFileSystemWatcher;
+    FileSystemWatcher mDirectoryWatcher;
     QString mIgnoreFileChangeEventForFile;
 
     static WorldManager *mInstance;
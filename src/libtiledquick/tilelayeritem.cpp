@@ -29,6 +29,7 @@
 #include "mapitem.h"
 #include "tilesnode.h"
 
+#include <QMap>
 #include <QtMath>
 #include <QQuickWindow>
 
@@ -44,13 +45,15 @@ namespace {
 static inline QSGTexture *tilesetTexture(Tileset *tileset,
                                          QQuickWindow *window)
 {
-    static QHash<Tileset *, QSGTexture *> cache;
+    // Keyed by image source as well, so a changed tileset image is loaded
+    static QHash<QPair<Tileset *, QUrl>, QSGTexture *> cache;
 
-    QSGTexture *texture = cache.value(tileset);
+    const auto key = qMakePair(tileset, tileset->imageSource());
+    QSGTexture *texture = cache.value(key);
     if (!texture) {
         const QString imagePath(Tiled::urlToLocalFileOrQrc(tileset->imageSource()));
         texture = window->createTextureFromImage(QImage(imagePath));
-        cache.insert(tileset, texture);
+        cache.insert(key, texture);
     }
     return texture;
 }
@@ -112,43 +115,22 @@ private:
     int mTilesPerRow;
 };
 
-} // anonymous namespace
-
-
-TileLayerItem::TileLayerItem(TileLayer *layer, MapRenderer *renderer,
-                             MapItem *parent)
-    : QQuickItem(parent)
-    , mLayer(layer)
-    , mRenderer(renderer)
-    , mVisibleArea(parent->visibleArea())
-{
-    setFlag(ItemHasContents);
-    layerVisibilityChanged();
-
-    syncWithTileLayer();
-    setOpacity(mLayer->opacity());
-}
-
-void TileLayerItem::syncWithTileLayer()
-{
-    const QRectF boundingRect = mRenderer->boundingRect(mLayer->rect());
-    setPosition(boundingRect.topLeft());
-    setSize(boundingRect.size());
-}
-
-
-
-QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
-                                        QQuickItem::UpdatePaintNodeData *)
+/**
+ * Creates the node displaying the tiles of the \a layer within \a tiles that
+ * are rendered in the \a exposed area. Returns nullptr when there are no such
+ * tiles.
+ */
+static QSGNode *createTilesNode(const TileLayer *layer,
+                                const MapRenderer *renderer,
+                                const QRect &tiles,
+                                const QRectF &exposed,
+                                TilesetHelper &helper)
 {
-    delete node;
-    node = new QSGNode;
+    auto node = new QSGNode;
     node->setFlag(QSGNode::OwnedByParent);
 
-    TilesetHelper helper(static_cast<MapItem*>(parentItem()));
-
     QVector<TileData> tileData;
-    tileData.reserve(TilesNode::MaxTileCount);
+    tileData.reserve(qMin(TilesNode::MaxTileCount, CHUNK_SIZE * CHUNK_SIZE));
 
     /**
      * Draws the tiles by adding nodes to the scene graph. When sequentially
@@ -156,7 +138,11 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
      * geometry node.
      */
     auto tileRenderFunction = [&](QPoint tilePos, const QPointF &screenPos) {
-        const Cell &cell = mLayer->cellAt(tilePos);
+        // The exposed area may include tiles of other chunks
+        if (!tiles.contains(tilePos))
+            return;
+
+        const Cell &cell = layer->cellAt(tilePos);
         Tileset *tileset = cell.tileset();
         if (!tileset)
             return;
@@ -180,7 +166,7 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
 
         const auto offset = tileset->tileOffset();
         const auto tile = tileset->findTile(cell.tileId());
-        const QSize size = (tile && !tile->image().isNull()) ? tile->size() : mRenderer->map()->tileSize();
+        const QSize size = (tile && !tile->image().isNull()) ? tile->size() : renderer->map()->tileSize();
 
         TileData data;
         data.x = static_cast<float>(screenPos.x()) + offset.x();
@@ -193,14 +179,228 @@ QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
         tileData.append(data);
     };
 
-    mRenderer->drawTileLayer(tileRenderFunction, mVisibleArea);
+    renderer->drawTileLayer(tileRenderFunction, exposed);
 
     if (!tileData.isEmpty())
         node->appendChildNode(new TilesNode(helper.texture(), tileData));
 
+    if (!node->childCount()) {
+        delete node;
+        return nullptr;
+    }
+
     return node;
 }
 
+/**
+ * Creates the node displaying the tiles in the given \a chunk of the \a layer.
+ * Returns nullptr when the chunk has no tiles.
+ */
+static QSGNode *createChunkNode(const TileLayer *layer,
+                                const MapRenderer *renderer,
+                                QPoint chunk,
+                                TilesetHelper &helper)
+{
+    const QRect chunkRect(chunk.x() * CHUNK_SIZE, chunk.y() * CHUNK_SIZE,
+                          CHUNK_SIZE, CHUNK_SIZE);
+
+    const Chunk *layerChunk = layer->findChunk(chunkRect.x(), chunkRect.y());
+    if (!layerChunk || layerChunk->isEmpty())
+        return nullptr;
+
+    return createTilesNode(layer, renderer, chunkRect,
+                           renderer->boundingRect(chunkRect), helper);
+}
+
+/**
+ * The root node of a tile layer, which has a child node for each visible
+ * chunk. The chunk nodes are kept while they remain visible, so that only the
+ * newly exposed chunks need to be created while scrolling.
+ *
+ * When tiles are larger than the grid, they overlap tiles of neighboring
+ * chunks. Drawing the chunks one after another would then change the order
+ * in which these tiles overlap, so instead the whole visible area is drawn
+ * by a single node, which is recreated on each update.
+ */
+class TileLayerNode : public QSGNode
+{
+public:
+    struct ChunkNode
+    {
+        QPoint chunk;
+        QSGNode *node;
+    };
+
+    // Ordered by row and then by column, in render order
+    using ChunkKey = QPair<int, int>;
+
+    QMap<ChunkKey, ChunkNode> chunkNodes;
+    QSGNode *areaNode = nullptr;
+
+    void removeChunkNode(QMap<ChunkKey, ChunkNode>::iterator &it)
+    {
+        removeChildNode(it.value().node);
+        delete it.value().node;
+        it = chunkNodes.erase(it);
+    }
+
+    void removeAllNodes()
+    {
+        for (auto it = chunkNodes.begin(); it != chunkNodes.end(); )
+            removeChunkNode(it);
+
+        if (areaNode) {
+            removeChildNode(areaNode);
+            delete areaNode;
+            areaNode = nullptr;
+        }
+    }
+};
+
+} // anonymous namespace
+
+
+TileLayerItem::TileLayerItem(TileLayer *layer, MapRenderer *renderer,
+                             MapItem *parent)
+    : QQuickItem(parent)
+    , mLayer(layer)
+    , mRenderer(renderer)
+    , mVisibleArea(parent->visibleArea())
+{
+    setFlag(ItemHasContents);
+    layerVisibilityChanged();
+
+    syncWithTileLayer();
+    setOpacity(mLayer->opacity());
+}
+
+void TileLayerItem::syncWithTileLayer()
+{
+    const QRectF boundingRect = mRenderer->boundingRect(mLayer->rect());
+    setPosition(boundingRect.topLeft());
+    setSize(boundingRect.size());
+}
+
+
+
+QSGNode *TileLayerItem::updatePaintNode(QSGNode *node,
+                                        QQuickItem::UpdatePaintNodeData *)
+{
+    auto layerNode = static_cast<TileLayerNode*>(node);
+    if (!layerNode) {
+        layerNode = new TileLayerNode;
+        layerNode->setFlag(QSGNode::OwnedByParent);
+    }
+
+    TilesetHelper helper(static_cast<MapItem*>(parentItem()));
+
+    const bool drawWholeArea = tilesExceedGrid();
+
+    if (drawWholeArea || layerNode->areaNode)
+        layerNode->removeAllNodes();
+
+    if (drawWholeArea) {
+        layerNode->areaNode = createTilesNode(mLayer, mRenderer, mLayer->localBounds(),
+                                              mVisibleArea, helper);
+        if (layerNode->areaNode)
+            layerNode->appendChildNode(layerNode->areaNode);
+        return layerNode;
+    }
+
+    const QRect chunks = visibleChunks();
+
+    // Remove the nodes of the chunks that are no longer visible
+    auto &chunkNodes = layerNode->chunkNodes;
+    for (auto it = chunkNodes.begin(); it != chunkNodes.end(); ) {
+        if (chunks.contains(it.value().chunk))
+            ++it;
+        else
+            layerNode->removeChunkNode(it);
+    }
+
+    // Create the nodes of the chunks that became visible
+    const Map::RenderOrder renderOrder = mRenderer->map()->renderOrder();
+    const int incX = (renderOrder == Map::RightDown || renderOrder == Map::RightUp) ? 1 : -1;
+    const int incY = (renderOrder == Map::RightDown || renderOrder == Map::LeftDown) ? 1 : -1;
+
+    for (int y = chunks.top(); y <= chunks.bottom(); ++y) {
+        for (int x = chunks.left(); x <= chunks.right(); ++x) {
+            const TileLayerNode::ChunkKey key(y * incY, x * incX);
+            if (chunkNodes.contains(key))
+                continue;
+
+            const QPoint chunk(x, y);
+            QSGNode *chunkNode = createChunkNode(mLayer, mRenderer, chunk, helper);
+            if (!chunkNode)
+                continue;
+
+            const auto next = chunkNodes.upperBound(key);
+            QSGNode *before = next != chunkNodes.end() ? next.value().node : nullptr;
+
+            chunkNodes.insert(key, TileLayerNode::ChunkNode { chunk, chunkNode });
+
+            if (before)
+                layerNode->insertChildNodeBefore(chunkNode, before);
+            else
+                layerNode->appendChildNode(chunkNode);
+        }
+    }
+
+    return layerNode;
+}
+
+/**
+ * Returns whether the tiles of this layer extend beyond their grid cell,
+ * overlapping the tiles in neighboring cells.
+ */
+bool TileLayerItem::tilesExceedGrid() const
+{
+    const QMargins drawMargins = mLayer->drawMargins();
+    return drawMargins.left() > 0 ||
+            drawMargins.top() > mRenderer->map()->tileHeight() ||
+            drawMargins.right() > mRenderer->map()->tileWidth() ||
+            drawMargins.bottom() > 0;
+}
+
+/**
+ * Returns the range of chunks (in chunk coordinates) that intersect the
+ * visible area of this layer.
+ */
+QRect TileLayerItem::visibleChunks() const
+{
+    if (mVisibleArea.isEmpty())
+        return QRect();
+
+    // Determine the tiles covering the visible area, which for non-orthogonal
+    // maps is not a rectangle in tile coordinates
+    const QPointF corners[] = {
+        mRenderer->screenToTileCoords(mVisibleArea.topLeft()),
+        mRenderer->screenToTileCoords(mVisibleArea.topRight()),
+        mRenderer->screenToTileCoords(mVisibleArea.bottomLeft()),
+        mRenderer->screenToTileCoords(mVisibleArea.bottomRight()),
+    };
+
+    qreal left = corners[0].x();
+    qreal top = corners[0].y();
+    qreal right = left;
+    qreal bottom = top;
+    for (const QPointF &corner : corners) {
+        left = qMin(left, corner.x());
+        top = qMin(top, corner.y());
+        right = qMax(right, corner.x());
+        bottom = qMax(bottom, corner.y());
+    }
+
+    QRect tiles(QPoint(qFloor(left) - 1, qFloor(top) - 1),
+                QPoint(qFloor(right) + 1, qFloor(bottom) + 1));
+    tiles &= mLayer->localBounds();
+    if (tiles.isEmpty())
+        return QRect();
+
+    return QRect(QPoint(tiles.left() >> CHUNK_BITS, tiles.top() >> CHUNK_BITS),
+                 QPoint(tiles.right() >> CHUNK_BITS, tiles.bottom() >> CHUNK_BITS));
+}
+
 void TileLayerItem::updateVisibleTiles()
 {
     const MapItem *mapItem = static_cast<MapItem*>(parentItem());
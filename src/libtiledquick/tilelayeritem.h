@@ -67,6 +67,8 @@ public slots:
 
 private:
     void layerVisibilityChanged();
+    QRect visibleChunks() const;
+    bool tilesExceedGrid() const;
 
     Tiled::TileLayer *mLayer;
     Tiled::MapRenderer *mRenderer;
@@ -25,7 +25,8 @@
 namespace TiledQuick {
 
 TilesNode::TilesNode(QSGTexture *texture, const QVector<TileData> &tileData)
-    : mGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0)
+    : mGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0, 0,
+                QSGGeometry::UnsignedShortType)
 {
     setFlag(QSGNode::OwnedByParent);
 
@@ -54,15 +55,13 @@ void TilesNode::processTileData(const QVector<TileData> &tileData)
     const float s_x = r.width() / s.width();
     const float s_y = r.height() / s.height();
 
-    // TODO: By using indices the memory usage could be reduced by 25%, at the
-    // cost of an additional indirection:
-    //
-    // Currently each tile takes:   6 * 16         = 96 bytes
-    // With indices it would take:  4 * 16 + 4 * 2 = 72 bytes
-
-    // Two triangles to draw each tile
-    mGeometry.allocate(tileData.size() * 6);
+    // Four vertices per tile, with two triangles referring to them by index.
+    // This takes 4 * 16 + 6 * 2 = 76 bytes per tile, compared to 96 bytes
+    // when specifying 6 vertices.
+    mGeometry.allocate(tileData.size() * 4, tileData.size() * 6);
     QSGGeometry::TexturedPoint2D *v = mGeometry.vertexDataAsTexturedPoint2D();
+    quint16 *indices = mGeometry.indexDataAsUShort();
+    quint16 index = 0;
 
     for (const TileData &data : tileData) {
         // Taking into account the normalized texture subrectancle
@@ -71,43 +70,38 @@ void TilesNode::processTileData(const QVector<TileData> &tileData)
         const float s_tx = r_x + data.tx * s_x;
         const float s_ty = r_y + data.ty * s_y;
 
+        float left = s_tx;
+        float right = s_tx + s_width;
+        float top = s_ty;
+        float bottom = s_ty + s_height;
+
+        if (data.flippedHorizontally)
+            std::swap(left, right);
+        if (data.flippedVertically)
+            std::swap(top, bottom);
+
         // TopLeft                      // TopRight
         v[0].x = data.x;                v[2].x = data.x + data.width;
         v[0].y = data.y;                v[2].y = data.y;
-        v[0].tx = s_tx;                 v[2].tx = s_tx + s_width;
-        v[0].ty = s_ty;                 v[2].ty = s_ty;
-
-        // BottomLeft
-        v[1].x = data.x;
-        v[1].y = data.y + data.height;
-        v[1].tx = s_tx;
-        v[1].ty = s_ty + s_height;
-
-
-                                        // TopRight
-                                        v[5].x = data.x + data.width;
-                                        v[5].y = data.y;
-                                        v[5].tx = s_tx + s_width;
-                                        v[5].ty = s_ty;
+        v[0].tx = left;                 v[2].tx = right;
+        v[0].ty = top;                  v[2].ty = top;
 
         // BottomLeft                   // BottomRight
-        v[3].x = data.x;                v[4].x = data.x + data.width;
-        v[3].y = data.y + data.height;  v[4].y = data.y + data.height;
-        v[3].tx = s_tx;                 v[4].tx = s_tx + s_width;
-        v[3].ty = s_ty + s_height;      v[4].ty = s_ty + s_height;
-
-        if (data.flippedHorizontally) {
-            std::swap(v[0].tx, v[4].tx);
-            std::swap(v[1].tx, v[5].tx);
-            std::swap(v[2].tx, v[3].tx);
-        }
-        if (data.flippedVertically) {
-            std::swap(v[0].ty, v[4].ty);
-            std::swap(v[1].ty, v[5].ty);
-            std::swap(v[2].ty, v[3].ty);
-        }
-
-        v += 6;
+        v[1].x = data.x;                v[3].x = data.x + data.width;
+        v[1].y = data.y + data.height;  v[3].y = data.y + data.height;
+        v[1].tx = left;                 v[3].tx = right;
+        v[1].ty = bottom;               v[3].ty = bottom;
+
+        indices[0] = index;         // TopLeft
+        indices[1] = index + 1;     // BottomLeft
+        indices[2] = index + 2;     // TopRight
+        indices[3] = index + 1;     // BottomLeft
+        indices[4] = index + 3;     // BottomRight
+        indices[5] = index + 2;     // TopRight
+
+        v += 4;
+        indices += 6;
+        index += 4;
     }
 
     markDirty(DirtyGeometry);
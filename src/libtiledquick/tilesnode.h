@@ -41,15 +41,16 @@ struct TileData {
     float height;
     float tx;
     float ty;
-    bool flippedHorizontally;
-    bool flippedVertically;
+    bool flippedHorizontally : 1;
+    bool flippedVertically : 1;
 };
 
 class TILEDQUICK_SHARED_EXPORT TilesNode : public QSGGeometryNode
 {
 public:
     enum {
-        MaxTileCount = 65536 / 6
+        // Each tile uses 4 vertices, indexed by unsigned shorts
+        MaxTileCount = 65536 / 4
     };
 
     TilesNode(QSGTexture *texture, const QVector<TileData> &tileData);
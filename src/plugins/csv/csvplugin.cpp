@@ -64,7 +64,7 @@ bool CsvPlugin::write(const Map *map, const QString &fileName, Options options)
 
         auto device = file.device();
 
-        QRect bounds = map->infinite() ? tileLayer->region().boundingRect() : tileLayer->rect();
+        QRect bounds = map->infinite() ? tileLayer->tileBounds() : tileLayer->rect();
         bounds.translate(-layer->position());
 
         // Write out tiles either by ID or their name, if given. -1 is "empty"
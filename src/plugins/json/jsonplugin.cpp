@@ -101,6 +101,11 @@ bool JsonMapFormat::write(const Tiled::Map *map,
     Tiled::MapToVariantConverter converter;
     QVariant variant = converter.toVariant(*map, QFileInfo(fileName).dir());
 
+    if (!converter.errorString().isEmpty()) {
+        mError = converter.errorString();
+        return false;
+    }
+
     JsonWriter writer;
     writer.setAutoFormatting(!options.testFlag(WriteMinimized));
 
@@ -62,6 +62,8 @@ public:
 
     void setMinimize(bool minimize);
 
+    QString errorString() const { return mError; }
+
     void writeMap(const Tiled::Map *);
     void writeProperties(const Tiled::Properties &);
     void writeTileset(const Tiled::Tileset &,
@@ -97,6 +99,7 @@ private:
     LuaTableWriter &mWriter;
     const QDir mDir;
     Tiled::GidMapper mGidMapper;
+    QString mError;
 };
 
 
@@ -123,6 +126,12 @@ bool LuaMapFormat::write(const Map *map,
     luaWriter.setMinimize(options.testFlag(WriteMinimized));
     luaWriter.writeMap(map);
 
+    // Don't replace the file with incomplete data
+    if (!luaWriter.errorString().isEmpty()) {
+        mError = luaWriter.errorString();
+        return false;
+    }
+
     if (file.error() != QFileDevice::NoError) {
         mError = file.errorString();
         return false;
@@ -593,23 +602,33 @@ void LuaWriter::writeTileLayerData(const TileLayer *tileLayer,
 {
     switch (format) {
     case Map::XML:
-    case Map::CSV:
+    case Map::CSV: {
+        QVector<unsigned> rowGids(bounds.width());
+
         mWriter.writeStartTable("data");
         for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
             if (y > bounds.top())
                 mWriter.prepareNewLine();
 
             for (int x = bounds.left(); x <= bounds.right(); ++x)
-                mWriter.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+                rowGids[x - bounds.left()] = mGidMapper.cellToGid(tileLayer->cellAt(x, y));
+
+            mWriter.writeValues(rowGids.constData(), rowGids.size());
         }
         mWriter.writeEndTable();
         break;
+    }
 
     case Map::Base64:
     case Map::Base64Zlib:
     case Map::Base64Gzip:
     case Map::Base64Zstandard: {
-        QByteArray layerData = mGidMapper.encodeLayerData(*tileLayer, format, bounds, compressionLevel);
+        bool ok;
+        QByteArray layerData = mGidMapper.encodeLayerData(*tileLayer, format, bounds, compressionLevel, &ok);
+        if (!ok && mError.isEmpty()) {
+            mError = QCoreApplication::translate("File Errors", "Layer '%1' is too large to be saved in this layer format.")
+                    .arg(tileLayer->name());
+        }
         mWriter.writeKeyAndValue("data", layerData);
         break;
     }
@@ -20,7 +20,10 @@
 
 #include "luatablewriter.h"
 
+#include "numberformat.h"
+
 #include <QIODevice>
+#include <QVarLengthArray>
 
 namespace Lua {
 
@@ -108,6 +111,34 @@ void LuaTableWriter::writeUnquotedValue(const QByteArray &value)
     m_valueWritten = true;
 }
 
+/**
+ * Writes the given \a count unsigned \a values, formatted the same as when
+ * calling writeValue() for each of them, but with a single write.
+ */
+void LuaTableWriter::writeValues(const unsigned *values, int count)
+{
+    if (count == 0)
+        return;
+
+    prepareNewValue();
+
+    QVarLengthArray<char, 1024> buffer(count * (Tiled::MaxUnsignedDigits + 2));
+    char *out = buffer.data();
+
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            *out++ = m_valueSeparator;
+            if (!m_minimize)
+                *out++ = ' ';
+        }
+        out = Tiled::formatUnsigned(values[i], out);
+    }
+
+    write(buffer.constData(), out - buffer.constData());
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
 void LuaTableWriter::writeKeyAndValue(const QByteArray &key,
                                       const char *value)
 {
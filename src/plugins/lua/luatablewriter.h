@@ -49,6 +49,7 @@ public:
     void writeValue(unsigned value);
     void writeValue(const QByteArray &value);
     void writeValue(const QString &value);
+    void writeValues(const unsigned *values, int count);
 
     void writeUnquotedValue(const QByteArray &value);
 
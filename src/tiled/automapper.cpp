@@ -525,12 +525,12 @@ void AutoMapper::autoMap(QRegion *where)
 
 QRegion AutoMapper::computeSetLayersRegion() const
 {
-    QRegion result;
+    TileRegion result;
     for (const QString &name : mInputLayers.names) {
         if (const TileLayer *setLayer = mSetLayers.value(name))
-            result |= setLayer->region();
+            result |= setLayer->tileRegion();
     }
-    return result;
+    return result.toRegion();
 }
 
 /**
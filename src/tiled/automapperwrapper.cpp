@@ -42,7 +42,7 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
                 continue;
 
             TouchedLayerData &data = mTouchedTileLayers[layer];
-            data.before.reset(layer->clone());
+            data.before = std::unique_ptr<TileLayer>(layer->clone());
         }
     }
 
@@ -108,3 +108,26 @@ void AutoMapperWrapper::patchLayer(TileLayer *target, const TileLayer &layer, co
 
     emit mMapDocument->regionChanged(region, target);
 }
+
+qint64 AutoMapperWrapper::memoryUsage() const
+{
+    qint64 usage = 0;
+    for (const std::pair<TileLayer* const, TouchedLayerData> &pair : mTouchedTileLayers)
+        usage += pair.second.before.memoryUsage() + pair.second.after.memoryUsage();
+    return usage;
+}
+
+bool AutoMapperWrapper::compress()
+{
+    bool compressed = false;
+
+    // The before and after layers are copies of the bounds of the region
+    for (std::pair<TileLayer* const, TouchedLayerData> &pair : mTouchedTileLayers) {
+        TouchedLayerData &data = pair.second;
+        const QRegion localRegion = data.region.translated(-data.region.boundingRect().topLeft());
+        compressed |= data.before.pack(localRegion);
+        compressed |= data.after.pack(localRegion);
+    }
+
+    return compressed;
+}
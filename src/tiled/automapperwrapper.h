@@ -22,6 +22,8 @@
 #pragma once
 
 #include "automapper.h"
+#include "tilelayersnapshot.h"
+#include "undocommands.h"
 
 #include <QMap>
 #include <QUndoCommand>
@@ -41,7 +43,7 @@ class MapDocument;
  * automapping is done. In between the instances of AutoMapper are doing the
  * work.
  */
-class AutoMapperWrapper : public QUndoCommand
+class AutoMapperWrapper : public QUndoCommand, public CompressibleUndoCommand
 {
 public:
     AutoMapperWrapper(MapDocument *mapDocument,
@@ -52,14 +54,17 @@ public:
     void undo() override;
     void redo() override;
 
+    qint64 memoryUsage() const override;
+    bool compress() override;
+
 private:
     void patchLayer(TileLayer *target, const TileLayer &layer, const QRegion &region);
 
     struct TouchedLayerData
     {
         QRegion region;
-        std::unique_ptr<TileLayer> before;
-        std::unique_ptr<TileLayer> after;
+        TileLayerSnapshot before;
+        TileLayerSnapshot after;
     };
 
     MapDocument *mMapDocument;
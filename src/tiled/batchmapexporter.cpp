@@ -0,0 +1,277 @@
+/*
+ * batchmapexporter.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batchmapexporter.h"
+
+#include "exporthelper.h"
+#include "exportmanifest.h"
+#include "map.h"
+#include "mapformat.h"
+#include "scriptedfileformat.h"
+#include "tmxmapformat.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+#include <memory>
+
+namespace Tiled {
+
+/**
+ * The state of a single map export. The maps are owned by the task, since
+ * they need to be destroyed on the main thread (tilesets register themselves
+ * with the TilesetManager).
+ */
+struct BatchMapExporter::Task
+{
+    BatchMapExporter::Job job;
+    std::unique_ptr<Map> sourceMap;
+    std::unique_ptr<Map> exportMap;
+    const Map *map = nullptr;
+    FileFormat::Options options;
+    QByteArray sourceHash;
+    qint64 readTime = 0;
+
+    // Set by WriteMapRunnable
+    bool success = false;
+    qint64 writeTime = 0;
+    QString error;
+};
+
+class BatchMapExporter::WriteMapRunnable : public QRunnable
+{
+public:
+    WriteMapRunnable(BatchMapExporter *exporter, Task *task)
+        : mExporter(exporter)
+        , mTask(task)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        if (qobject_cast<TmxMapFormat*>(mTask->job.format)) {
+            // Stateless apart from its error string, so each write uses its
+            // own instance and can run in parallel
+            TmxMapFormat format;
+            write(format);
+        } else {
+            // Other formats may keep state while writing, so they are only
+            // used by one thread at a time
+            QMutexLocker locker(&mExporter->mSharedFormatMutex);
+            write(*mTask->job.format);
+        }
+        mTask->writeTime = timer.elapsed();
+
+        mExporter->writeFinished(mTask);
+    }
+
+private:
+    void write(MapFormat &format)
+    {
+        mTask->success = format.write(mTask->map, mTask->job.targetFile, mTask->options);
+        if (!mTask->success)
+            mTask->error = format.errorString();
+    }
+
+    BatchMapExporter * const mExporter;
+    Task * const mTask;
+};
+
+
+BatchMapExporter::BatchMapExporter(Preferences::ExportOptions options)
+    : mOptions(options)
+    , mMaxThreadCount(QThread::idealThreadCount())
+{
+}
+
+int BatchMapExporter::exportMaps(const QVector<Job> &jobs)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, mMaxThreadCount));
+
+    // Limits the amount of maps kept in memory while waiting to be written
+    const int maxPendingTasks = pool.maxThreadCount() * 2;
+    int pendingTasks = 0;
+    int failures = 0;
+
+    mUpToDateCount = 0;
+    mExportedCount = 0;
+    mCanceled = false;
+
+    QElapsedTimer totalTimer;
+    totalTimer.start();
+
+    const ExportHelper exportHelper(mOptions);
+
+    for (int index = 0; index < jobs.size(); ++index) {
+        const Job &job = jobs.at(index);
+
+        // Wait for a write to finish when too many maps are in memory
+        pendingTasks -= processFinishedTasks(pendingTasks >= maxPendingTasks);
+
+        if (mProgressCallback && !mProgressCallback(index, jobs.size())) {
+            mCanceled = true;
+            break;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // Skip maps that did not change since they were last exported
+        QByteArray sourceHash;
+        if (mManifest) {
+            sourceHash = mManifest->sourceHash(job.sourceFile, job.targetFile, job.format, mOptions);
+            if (mManifest->isUpToDate(job.sourceFile, sourceHash)) {
+                ++mUpToDateCount;
+                continue;
+            }
+        }
+
+        // Load the source file
+        QString errorMsg;
+        std::unique_ptr<Map> sourceMap(readMap(job.sourceFile, &errorMsg));
+        if (!sourceMap) {
+            qWarning().noquote() << tr("Failed to load source map '%1'.").arg(job.sourceFile);
+            if (!errorMsg.isEmpty())
+                qWarning().noquote() << errorMsg;
+
+            ++failures;
+            continue;
+        }
+
+        // Fall back to the export settings stored in the map
+        Job resolvedJob = job;
+        if (resolvedJob.targetFile.isEmpty())
+            resolvedJob.targetFile = sourceMap->exportFileName;
+        if (!resolvedJob.format)
+            resolvedJob.format = findFileFormat<MapFormat>(sourceMap->exportFormat);
+
+        if (resolvedJob.targetFile.isEmpty() || !resolvedJob.format) {
+            // Nothing to export, which is remembered until the map changes
+            if (mManifest)
+                mManifest->setExported(job.sourceFile, QString(), sourceHash);
+
+            ++mUpToDateCount;
+            continue;
+        }
+
+        // Keep external tilesets loaded, so other maps can share them
+        for (const SharedTileset &tileset : sourceMap->tilesets())
+            if (tileset->isExternal())
+                mExternalTilesets.insert(tileset);
+
+        auto task = new Task;
+        task->job = resolvedJob;
+        task->sourceHash = sourceHash;
+        task->map = exportHelper.prepareExportMap(sourceMap.get(), task->exportMap);
+        task->sourceMap = std::move(sourceMap);
+        task->options = exportHelper.formatOptions();
+        task->readTime = timer.elapsed();
+
+        ++pendingTasks;
+
+        // Scripted formats need to run on the thread owning the script engine
+        auto runnable = new WriteMapRunnable(this, task);
+        if (qobject_cast<ScriptedMapFormat*>(resolvedJob.format)) {
+            runnable->run();
+            delete runnable;
+        } else {
+            pool.start(runnable);
+        }
+    }
+
+    pool.waitForDone();
+    pendingTasks -= processFinishedTasks(false);
+    Q_ASSERT(pendingTasks == 0);
+
+    failures += mFailedWrites;
+    mFailedWrites = 0;
+
+    if (mReportTimings) {
+        qInfo().noquote() << tr("Exported %1 of %2 maps in %3 ms")
+                             .arg(mExportedCount)
+                             .arg(mExportedCount + failures)
+                             .arg(totalTimer.elapsed());
+    }
+
+    return failures;
+}
+
+/**
+ * Called by the worker threads when a map has been written.
+ */
+void BatchMapExporter::writeFinished(Task *task)
+{
+    QMutexLocker locker(&mFinishedMutex);
+    mFinishedTasks.append(task);
+    mTaskFinished.wakeOne();
+}
+
+/**
+ * Reports on and deletes the finished tasks. When \a wait is true, blocks
+ * until at least one task has finished. Returns the number of tasks that were
+ * processed.
+ */
+int BatchMapExporter::processFinishedTasks(bool wait)
+{
+    QVector<Task*> finishedTasks;
+    {
+        QMutexLocker locker(&mFinishedMutex);
+        while (wait && mFinishedTasks.isEmpty())
+            mTaskFinished.wait(&mFinishedMutex);
+        finishedTasks.swap(mFinishedTasks);
+    }
+
+    for (Task *task : qAsConst(finishedTasks)) {
+        const Job &job = task->job;
+
+        if (task->success) {
+            ++mExportedCount;
+
+            if (mManifest)
+                mManifest->setExported(job.sourceFile, job.targetFile, task->sourceHash);
+
+            if (mReportTimings) {
+                qInfo().noquote() << tr("Exported '%1' to '%2' (read: %3 ms, write: %4 ms)")
+                                     .arg(job.sourceFile, job.targetFile)
+                                     .arg(task->readTime)
+                                     .arg(task->writeTime);
+            }
+        } else {
+            qWarning().noquote() << tr("Failed to export map '%1' to target file '%2'.")
+                                    .arg(job.sourceFile, job.targetFile);
+            if (!task->error.isEmpty())
+                qWarning().noquote() << task->error;
+
+            ++mFailedWrites;
+        }
+
+        delete task;
+    }
+
+    return finishedTasks.size();
+}
+
+} // namespace Tiled
@@ -0,0 +1,139 @@
+/*
+ * batchmapexporter.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "preferences.h"
+#include "tileset.h"
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace Tiled {
+
+class ExportManifest;
+class MapFormat;
+
+/**
+ * Exports any number of maps within a single process, as used by the
+ * --export-map and --export-changed command-line options.
+ *
+ * Maps are read and prepared for export on the calling thread, after which
+ * they are written out by a pool of worker threads. Only the TMX format is
+ * written by several threads at once; writes through other formats are
+ * serialized, since their instances are shared. External tilesets are
+ * kept alive for the duration of the batch, so that each is only loaded
+ * once, no matter how many maps refer to it.
+ *
+ * When a manifest is set, maps that did not change since they were last
+ * exported are skipped.
+ */
+class BatchMapExporter
+{
+    Q_DECLARE_TR_FUNCTIONS(BatchMapExporter)
+
+public:
+    /**
+     * When the target file or format are not set, the export settings stored
+     * in the map are used.
+     */
+    struct Job
+    {
+        QString sourceFile;
+        QString targetFile;
+        MapFormat *format = nullptr;
+    };
+
+    explicit BatchMapExporter(Preferences::ExportOptions options);
+
+    void setMaxThreadCount(int count) { mMaxThreadCount = count; }
+
+    /**
+     * When enabled, the time taken to read and write each map is reported.
+     */
+    void setReportTimings(bool enabled) { mReportTimings = enabled; }
+
+    /**
+     * Sets the manifest used to skip unchanged maps. Successful exports are
+     * recorded in the manifest, but it is not saved by the exporter.
+     */
+    void setManifest(ExportManifest *manifest) { mManifest = manifest; }
+
+    /**
+     * Sets a function that is called before each job with the number of jobs
+     * handled so far and the total number of jobs. When it returns false,
+     * the remaining jobs are skipped.
+     */
+    void setProgressCallback(std::function<bool (int, int)> callback) { mProgressCallback = std::move(callback); }
+
+    /**
+     * Exports all given \a jobs. Returns the number of jobs that failed.
+     */
+    int exportMaps(const QVector<Job> &jobs);
+
+    /**
+     * Returns the number of maps skipped by the last exportMaps() call,
+     * because they were up to date or have no export target.
+     */
+    int upToDateCount() const { return mUpToDateCount; }
+
+    /**
+     * Returns the number of maps written by the last exportMaps() call.
+     */
+    int exportedCount() const { return mExportedCount; }
+
+    /**
+     * Returns whether the last exportMaps() call was canceled by the
+     * progress callback.
+     */
+    bool wasCanceled() const { return mCanceled; }
+
+private:
+    struct Task;
+    class WriteMapRunnable;
+
+    void writeFinished(Task *task);
+    int processFinishedTasks(bool wait);
+
+    const Preferences::ExportOptions mOptions;
+    int mMaxThreadCount;
+    bool mReportTimings = false;
+    ExportManifest *mManifest = nullptr;
+    std::function<bool (int, int)> mProgressCallback;
+    int mFailedWrites = 0;
+    int mUpToDateCount = 0;
+    int mExportedCount = 0;
+    bool mCanceled = false;
+    QSet<SharedTileset> mExternalTilesets;
+
+    QMutex mSharedFormatMutex;
+
+    QMutex mFinishedMutex;
+    QVector<Task*> mFinishedTasks;
+    QWaitCondition mTaskFinished;
+};
+
+} // namespace Tiled
@@ -48,6 +48,7 @@ public:
     void clear();
     bool hasProperty(QtProperty *property) const;
     QtVariantProperty *property(const QString &name);
+    int propertyTypeId(QtProperty *property) const;
 
     QVariant toDisplayValue(QVariant value) const;
     QVariant fromDisplayValue(QtProperty *property, QVariant value) const;
@@ -92,6 +93,15 @@ inline QtVariantProperty *CustomPropertiesHelper::property(const QString &name)
     return mProperties.value(name);
 }
 
+/**
+ * Returns the ID of the custom property type used by the given property, or
+ * 0 when it isn't using a custom type.
+ */
+inline int CustomPropertiesHelper::propertyTypeId(QtProperty *property) const
+{
+    return mPropertyTypeIds.value(property);
+}
+
 inline void CustomPropertiesHelper::setMapDocument(MapDocument *mapDocument)
 {
     mMapDocument = mapDocument;
@@ -0,0 +1,414 @@
+/*
+ * dependencyindex.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dependencyindex.h"
+
+#include "projectmodel.h"
+#include "tiled.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
+
+#include <algorithm>
+
+namespace Tiled {
+
+// The minimum age of a file in msecs, for its dependencies to be reused when
+// its modification time did not change
+static constexpr qint64 MinimumCachedAge = 2000;
+
+static constexpr quint32 DependencyCacheMagic = 0x54504443;    // "TPDC"
+static constexpr quint32 DependencyCacheVersion = 1;
+
+static QDataStream &operator<<(QDataStream &out, const DependencyIndex::FileDependencies &file)
+{
+    return out << file.lastModified << file.dependencies;
+}
+
+static QDataStream &operator>>(QDataStream &in, DependencyIndex::FileDependencies &file)
+{
+    return in >> file.lastModified >> file.dependencies;
+}
+
+static QString dependencyCacheFileName(const QString &projectFileName)
+{
+    if (projectFileName.isEmpty())
+        return QString();
+
+    const QByteArray hash = QCryptographicHash::hash(projectFileName.toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    path += QLatin1String("/project-dependencies/");
+    path += QString::fromLatin1(hash);
+    path += QLatin1String(".cache");
+    return path;
+}
+
+static QHash<QString, DependencyIndex::FileDependencies> loadDependencyCache(const QString &fileName)
+{
+    QHash<QString, DependencyIndex::FileDependencies> files;
+
+    QFile file(fileName);
+    if (fileName.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return files;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic;
+    quint32 version;
+    in >> magic >> version;
+    if (magic != DependencyCacheMagic || version != DependencyCacheVersion)
+        return files;
+
+    in >> files;
+    if (in.status() != QDataStream::Ok)
+        files.clear();
+
+    return files;
+}
+
+static void saveDependencyCache(const QString &fileName,
+                                const QHash<QString, DependencyIndex::FileDependencies> &files)
+{
+    if (fileName.isEmpty())
+        return;
+    if (!QDir().mkpath(QFileInfo(fileName).path()))
+        return;
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << DependencyCacheMagic << DependencyCacheVersion << files;
+
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+/**
+ * Adds the local file referenced by \a reference, relative to \a path.
+ */
+static void addReference(const QString &reference, const QString &path, QStringList &result)
+{
+    const QUrl url = toUrl(reference, path);
+    if (url.isLocalFile())
+        result.append(QDir::cleanPath(url.toLocalFile()));
+}
+
+static void readXmlDependencies(QIODevice *device, const QString &path, QStringList &result)
+{
+    QXmlStreamReader xml(device);
+
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+
+        const auto name = xml.name();
+        const QXmlStreamAttributes atts = xml.attributes();
+
+        if (name == QLatin1String("data")) {
+            // Skip tile layer data and embedded images
+            xml.skipCurrentElement();
+        } else if (name == QLatin1String("tileset") || name == QLatin1String("image")) {
+            addReference(atts.value(QLatin1String("source")).toString(), path, result);
+        } else if (name == QLatin1String("object")) {
+            addReference(atts.value(QLatin1String("template")).toString(), path, result);
+        } else if (name == QLatin1String("property")) {
+            if (atts.value(QLatin1String("type")) == QLatin1String("file"))
+                addReference(atts.value(QLatin1String("value")).toString(), path, result);
+        }
+    }
+}
+
+static void readJsonDependencies(const QJsonObject &object, const QString &path, QStringList &result)
+{
+    for (auto it = object.begin(); it != object.end(); ++it) {
+        const QString key = it.key();
+        const QJsonValue value = it.value();
+
+        // Skip tile layer data
+        if (key == QLatin1String("data") || key == QLatin1String("chunks"))
+            continue;
+
+        if (value.isString()) {
+            if (key == QLatin1String("image") ||
+                    key == QLatin1String("source") ||
+                    key == QLatin1String("template")) {
+                addReference(value.toString(), path, result);
+            }
+        } else if (value.isObject()) {
+            readJsonDependencies(value.toObject(), path, result);
+        } else if (value.isArray()) {
+            const bool isProperties = key == QLatin1String("properties");
+
+            for (const QJsonValue element : value.toArray()) {
+                const QJsonObject elementObject = element.toObject();
+
+                if (isProperties) {
+                    if (elementObject.value(QLatin1String("type")).toString() == QLatin1String("file"))
+                        addReference(elementObject.value(QLatin1String("value")).toString(), path, result);
+                } else if (!elementObject.isEmpty()) {
+                    readJsonDependencies(elementObject, path, result);
+                }
+            }
+        }
+    }
+}
+
+static void readWorldDependencies(const QJsonObject &object, const QString &path, QStringList &result)
+{
+    const QJsonArray maps = object.value(QLatin1String("maps")).toArray();
+    for (const QJsonValue map : maps)
+        addReference(map.toObject().value(QLatin1String("fileName")).toString(), path, result);
+}
+
+
+class DependencyIndex::IndexRunnable : public QRunnable
+{
+public:
+    IndexRunnable(DependencyIndex *index,
+                  int generation,
+                  const QStringList &fileNames,
+                  const QHash<QString, FileDependencies> &previousFiles,
+                  const QString &cacheFileName)
+        : mIndex(index)
+        , mGeneration(generation)
+        , mFileNames(fileNames)
+        , mPreviousFiles(previousFiles)
+        , mCacheFileName(cacheFileName)
+    {}
+
+    void run() override;
+
+private:
+    bool isCanceled() const { return mIndex->mGeneration != mGeneration; }
+
+    DependencyIndex * const mIndex;
+    const int mGeneration;
+    const QStringList mFileNames;
+    const QHash<QString, FileDependencies> mPreviousFiles;
+    const QString mCacheFileName;
+};
+
+void DependencyIndex::IndexRunnable::run()
+{
+    QHash<QString, FileDependencies> files;
+    files.reserve(mFileNames.size());
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    for (const QString &fileName : mFileNames) {
+        if (isCanceled())
+            return;
+
+        const qint64 lastModified = QFileInfo(fileName).lastModified().toMSecsSinceEpoch();
+
+        const auto previous = mPreviousFiles.constFind(fileName);
+        if (previous != mPreviousFiles.constEnd() && previous->lastModified == lastModified) {
+            files.insert(fileName, previous.value());
+            continue;
+        }
+
+        // A file modified just now may still change without its modification
+        // time changing, so it is read again next time
+        FileDependencies file;
+        file.lastModified = now - lastModified > MinimumCachedAge ? lastModified : 0;
+        file.dependencies = DependencyIndex::readDependencies(fileName);
+        files.insert(fileName, file);
+    }
+
+    saveDependencyCache(mCacheFileName, files);
+
+    QMetaObject::invokeMethod(mIndex, [index = mIndex, generation = mGeneration, files] {
+        index->indexingFinished(generation, files);
+    }, Qt::QueuedConnection);
+}
+
+
+DependencyIndex::DependencyIndex(ProjectModel *projectModel, QObject *parent)
+    : QObject(parent)
+    , mProjectModel(projectModel)
+{
+    mThreadPool.setMaxThreadCount(1);
+
+    connect(projectModel, &ProjectModel::fileIndexChanged,
+            this, &DependencyIndex::fileIndexChanged);
+}
+
+DependencyIndex::~DependencyIndex()
+{
+    ++mGeneration;
+    mThreadPool.waitForDone();
+}
+
+/**
+ * Returns the files directly referenced by the given file.
+ */
+QStringList DependencyIndex::dependencies(const QString &fileName) const
+{
+    return mFiles.value(QDir::cleanPath(fileName)).dependencies;
+}
+
+/**
+ * Returns the files in the project that directly reference the given file.
+ */
+QStringList DependencyIndex::dependents(const QString &fileName) const
+{
+    return mDependents.value(QDir::cleanPath(fileName));
+}
+
+/**
+ * Returns whether the dependencies of the given file are indexed, based on
+ * its file extension.
+ */
+bool DependencyIndex::isIndexed(const QString &fileName)
+{
+    static const QStringList suffixes {
+        QStringLiteral("tmx"), QStringLiteral("tsx"), QStringLiteral("tx"),
+        QStringLiteral("tmj"), QStringLiteral("tsj"), QStringLiteral("tj"),
+        QStringLiteral("json"), QStringLiteral("world"),
+    };
+
+    const int dot = fileName.lastIndexOf(QLatin1Char('.'));
+    if (dot == -1)
+        return false;
+
+#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
+    const QString suffix = fileName.mid(dot + 1);
+#else
+    const QStringView suffix = QStringView(fileName).mid(dot + 1);
+#endif
+
+    return std::any_of(suffixes.begin(), suffixes.end(), [&] (const QString &s) {
+        return suffix.compare(s, Qt::CaseInsensitive) == 0;
+    });
+}
+
+/**
+ * Reads the files referenced by the given map, tileset, template or world
+ * file: tilesets, templates, images, maps and file properties.
+ *
+ * Only the references are read, which is a lot faster than loading the
+ * file. Can be called from any thread.
+ */
+QStringList DependencyIndex::readDependencies(const QString &fileName)
+{
+    QStringList result;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return result;
+
+    const QFileInfo fileInfo(fileName);
+    const QString suffix = fileInfo.suffix().toLower();
+    const QString path = fileInfo.absolutePath();
+
+    if (suffix == QLatin1String("tmx") || suffix == QLatin1String("tsx") || suffix == QLatin1String("tx")) {
+        readXmlDependencies(&file, path, result);
+    } else {
+        const QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+
+        if (suffix == QLatin1String("world")) {
+            readWorldDependencies(object, path, result);
+        } else if (suffix != QLatin1String("json")) {
+            readJsonDependencies(object, path, result);
+        } else {
+            // Other JSON files are only read when they are a map, tileset or template
+            const QString type = object.value(QLatin1String("type")).toString();
+            if (type == QLatin1String("map") || type == QLatin1String("tileset") || type == QLatin1String("template"))
+                readJsonDependencies(object, path, result);
+        }
+    }
+
+    result.removeDuplicates();
+    return result;
+}
+
+void DependencyIndex::fileIndexChanged()
+{
+    // Use the dependencies cached for a project while it is indexed again
+    const QString projectFileName = mProjectModel->project().fileName();
+    if (projectFileName != mProjectFileName) {
+        mProjectFileName = projectFileName;
+        mCacheFileName = dependencyCacheFileName(projectFileName);
+        setFiles(loadDependencyCache(mCacheFileName));
+    }
+
+    startIndexing();
+}
+
+/**
+ * Starts updating the index, canceling any update still in progress.
+ */
+void DependencyIndex::startIndexing()
+{
+    QStringList fileNames;
+
+    for (const ProjectModel::IndexedFile &file : mProjectModel->fileIndex())
+        if (isIndexed(file.path))
+            fileNames.append(file.path);
+
+    const int generation = ++mGeneration;
+    mIndexing = true;
+    mThreadPool.start(new IndexRunnable(this, generation, fileNames, mFiles, mCacheFileName));
+}
+
+void DependencyIndex::indexingFinished(int generation, const QHash<QString, FileDependencies> &files)
+{
+    if (generation != mGeneration)
+        return;
+
+    mIndexing = false;
+    setFiles(files);
+}
+
+void DependencyIndex::setFiles(const QHash<QString, FileDependencies> &files)
+{
+    mFiles = files;
+    mDependents.clear();
+
+    for (auto it = mFiles.cbegin(); it != mFiles.cend(); ++it)
+        for (const QString &dependency : it->dependencies)
+            mDependents[dependency].append(it.key());
+
+    for (QStringList &dependents : mDependents)
+        dependents.sort();
+
+    emit updated();
+}
+
+} // namespace Tiled
+
+#include "moc_dependencyindex.cpp"
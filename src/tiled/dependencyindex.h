@@ -0,0 +1,101 @@
+/*
+ * dependencyindex.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <atomic>
+
+namespace Tiled {
+
+class ProjectModel;
+
+/**
+ * Keeps track of the files referenced by the maps, tilesets, templates and
+ * worlds in the project.
+ *
+ * The files are read on a worker thread whenever the project folders have
+ * been scanned, and only files that were modified since they were last read
+ * are read again. Only the references are read from each file, skipping for
+ * example the tile layer data.
+ *
+ * The index is remembered between sessions in the cache directory.
+ */
+class DependencyIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct FileDependencies
+    {
+        qint64 lastModified = 0;    // msecs since epoch
+        QStringList dependencies;
+    };
+
+    explicit DependencyIndex(ProjectModel *projectModel, QObject *parent = nullptr);
+    ~DependencyIndex() override;
+
+    QStringList dependencies(const QString &fileName) const;
+    QStringList dependents(const QString &fileName) const;
+
+    bool isIndexing() const;
+
+    static bool isIndexed(const QString &fileName);
+    static QStringList readDependencies(const QString &fileName);
+
+signals:
+    /**
+     * Emitted when the index has been updated.
+     */
+    void updated();
+
+private:
+    class IndexRunnable;
+
+    void fileIndexChanged();
+    void startIndexing();
+    void indexingFinished(int generation, const QHash<QString, FileDependencies> &files);
+    void setFiles(const QHash<QString, FileDependencies> &files);
+
+    ProjectModel *mProjectModel;
+    QThreadPool mThreadPool;
+    std::atomic<int> mGeneration { 0 };
+    bool mIndexing = false;
+
+    QString mProjectFileName;
+    QString mCacheFileName;
+
+    QHash<QString, FileDependencies> mFiles;
+    QHash<QString, QStringList> mDependents;
+};
+
+/**
+ * Returns whether the index is currently being updated.
+ */
+inline bool DependencyIndex::isIndexing() const
+{
+    return mIndexing;
+}
+
+} // namespace Tiled
@@ -25,6 +25,7 @@
 #include "editableasset.h"
 #include "logginginterface.h"
 #include "object.h"
+#include "preferences.h"
 #include "tile.h"
 #include "undocommands.h"
 #include "wangset.h"
@@ -36,6 +37,8 @@ namespace Tiled {
 
 QHash<QString, Document*> Document::sDocumentInstances;
 
+Preference<int> Document::ourUndoMemoryLimit { "Storage/UndoMemoryLimit", 256 };
+
 Document::Document(DocumentType type, const QString &fileName,
                    QObject *parent)
     : QObject(parent)
@@ -49,6 +52,7 @@ Document::Document(DocumentType type, const QString &fileName,
 
     connect(mUndoStack, &QUndoStack::indexChanged, this, &Document::updateModifiedChanged);
     connect(mUndoStack, &QUndoStack::cleanChanged, this, &Document::updateModifiedChanged);
+    connect(mUndoStack, &QUndoStack::indexChanged, this, &Document::limitUndoMemory);
 }
 
 Document::~Document()
@@ -232,6 +236,98 @@ void Document::updateModifiedChanged()
     }
 }
 
+/**
+ * Compresses the data of undo commands while the undo history uses more
+ * memory than allowed by ourUndoMemoryLimit.
+ *
+ * Commands further away from the current index are compressed first, since
+ * they are the least likely to be needed soon. The commands right before and
+ * after the current index are left alone, since they are needed for the next
+ * undo or redo and the former may still be merged with.
+ */
+void Document::limitUndoMemory()
+{
+    const qint64 limit = qint64(ourUndoMemoryLimit) * 1024 * 1024;
+    if (limit <= 0) {
+        mUndoMemoryUsages.clear();
+        mUndoMemoryUsage = 0;
+        return;
+    }
+
+    updateUndoMemoryUsage();
+
+    const QUndoStack &undo = *undoStack();
+    const int index = undo.index();
+
+    int older = 0;
+    int newer = undo.count() - 1;
+
+    while (mUndoMemoryUsage > limit) {
+        int i;
+        if (older < index - 1 && index - 1 - older >= newer - index)
+            i = older++;
+        else if (newer > index)
+            i = newer--;
+        else
+            break;
+
+        // QUndoStack only provides const access to its commands
+        auto command = const_cast<QUndoCommand*>(undo.command(i));
+        if (compressUndoCommand(command)) {
+            const qint64 usage = undoMemoryUsage(command);
+            mUndoMemoryUsage += usage - mUndoMemoryUsages[i].usage;
+            mUndoMemoryUsages[i].usage = usage;
+        }
+    }
+}
+
+/**
+ * Updates the memory usage of the commands that may have changed since the
+ * last call. These are the commands that were undone or redone, the command
+ * before the current index, which may have been merged with, and any
+ * commands that were pushed or removed.
+ */
+void Document::updateUndoMemoryUsage()
+{
+    const QUndoStack &undo = *undoStack();
+    const int index = undo.index();
+    const int count = undo.count();
+
+    // Start over when the stack was cleared or lost its oldest commands
+    int first = qMax(0, qMin(mUndoMemoryIndex, index) - 1);
+    if (first > mUndoMemoryUsages.size() || first > count ||
+            (first > 0 && mUndoMemoryUsages.at(first - 1).command != undo.command(first - 1))) {
+        first = 0;
+    }
+
+    const int last = qMax(mUndoMemoryIndex, index);
+
+    for (int i = count; i < mUndoMemoryUsages.size(); ++i)
+        mUndoMemoryUsage -= mUndoMemoryUsages.at(i).usage;
+    if (mUndoMemoryUsages.size() > count)
+        mUndoMemoryUsages.resize(count);
+
+    for (int i = first; i < count; ++i) {
+        const QUndoCommand *command = undo.command(i);
+
+        if (i < mUndoMemoryUsages.size()) {
+            UndoMemoryUsage &entry = mUndoMemoryUsages[i];
+            if (i > last && entry.command == command)
+                continue;
+
+            const qint64 usage = undoMemoryUsage(command);
+            mUndoMemoryUsage += usage - entry.usage;
+            entry = { command, usage };
+        } else {
+            const qint64 usage = undoMemoryUsage(command);
+            mUndoMemoryUsage += usage;
+            mUndoMemoryUsages.append({ command, usage });
+        }
+    }
+
+    mUndoMemoryIndex = index;
+}
+
 QList<Object *> Document::currentObjects() const
 {
     QList<Object*> objects;
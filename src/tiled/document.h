@@ -27,9 +27,11 @@
 #include <QSharedPointer>
 #include <QString>
 #include <QVariant>
+#include <QVector>
 
 #include <memory>
 
+class QUndoCommand;
 class QUndoStack;
 
 namespace Tiled {
@@ -41,6 +43,8 @@ class Tile;
 class ChangeEvent;
 class EditableAsset;
 
+template<typename T> class Preference;
+
 /**
  * Keeps track of a file and its undo history.
  */
@@ -123,6 +127,12 @@ public:
 
     static const QHash<QString, Document *> &documentInstances();
 
+    /**
+     * The amount of memory in MB each document may use for its undo
+     * history before older commands are compressed. 0 means no limit.
+     */
+    static Preference<int> ourUndoMemoryLimit;
+
 signals:
     void changed(const ChangeEvent &change);
     void saved();
@@ -165,6 +175,8 @@ private:
     void currentObjectDocumentDestroyed();
 
     void updateModifiedChanged();
+    void limitUndoMemory();
+    void updateUndoMemoryUsage();
 
     const DocumentType mType;
 
@@ -173,6 +185,16 @@ private:
 
     QUndoStack * const mUndoStack;
 
+    // Memory used by each command in the undo stack, updated incrementally
+    struct UndoMemoryUsage
+    {
+        const QUndoCommand *command;
+        qint64 usage;
+    };
+    QVector<UndoMemoryUsage> mUndoMemoryUsages;
+    qint64 mUndoMemoryUsage = 0;
+    int mUndoMemoryIndex = 0;
+
     bool mModified = false;
     bool mChangedOnDisk = false;
     bool mIgnoreBrokenLinks = false;
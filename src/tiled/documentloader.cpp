@@ -0,0 +1,304 @@
+/*
+ * documentloader.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "documentloader.h"
+
+#include "documentmanager.h"
+#include "map.h"
+#include "mapdocument.h"
+#include "tilesetdocument.h"
+#include "tmxmapformat.h"
+
+#include <QCoreApplication>
+#include <QRunnable>
+
+#include <atomic>
+#include <memory>
+
+namespace Tiled {
+
+/**
+ * The state of a single file being loaded. Owned by the loader, and deleted
+ * on the main thread once finished.
+ */
+struct DocumentLoader::Task
+{
+    QString fileName;
+    FileFormat *format = nullptr;
+    QVector<const QObject*> owners;     // only used on the main thread
+    std::atomic<bool> canceled { false };
+
+    // Set when the file was already loaded
+    DocumentPtr document;
+
+    // Set by read()
+    std::unique_ptr<Map> map;
+    SharedTileset tileset;
+    QString error;
+};
+
+class DocumentLoader::ReadRunnable : public QRunnable
+{
+public:
+    ReadRunnable(DocumentLoader *loader, Task *task)
+        : mLoader(loader)
+        , mTask(task)
+    {}
+
+    void run() override
+    {
+        DocumentLoader::read(mTask);
+        mLoader->readFinished(mTask);
+    }
+
+private:
+    DocumentLoader * const mLoader;
+    Task * const mTask;
+};
+
+
+DocumentLoader::DocumentLoader(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DocumentLoader::~DocumentLoader()
+{
+    for (Task *task : qAsConst(mPendingTasks))
+        task->canceled = true;
+
+    mThreadPool.waitForDone();
+
+    qDeleteAll(mMainThreadTasks);
+    qDeleteAll(mFinishedTasks);
+}
+
+/**
+ * Requests the given file to be loaded. The documentLoaded() signal is
+ * emitted once it has been loaded.
+ *
+ * When no \a fileFormat is given, the format is detected based on the file.
+ *
+ * Files with a higher \a priority are read first, when they are read in the
+ * background.
+ *
+ * The \a owner identifies the requester, allowing it to cancel its requests
+ * without affecting those of others.
+ */
+void DocumentLoader::load(const QString &fileName, FileFormat *fileFormat,
+                          int priority, const QObject *owner)
+{
+    if (Task *task = mPendingTasks.value(fileName)) {
+        if (!task->owners.contains(owner))
+            task->owners.append(owner);
+        return;
+    }
+
+    auto task = new Task;
+    task->fileName = fileName;
+    task->format = fileFormat;
+    task->owners.append(owner);
+
+    mPendingTasks.insert(fileName, task);
+    ++mTotalCount;
+    emit progressChanged(mFinishedCount, mTotalCount);
+
+    auto documentManager = DocumentManager::instance();
+    task->document = documentManager->findLoadedDocument(fileName);
+
+    if (!task->document && !task->format)
+        task->format = DocumentManager::findReadFormat(fileName);
+
+    if (task->document || !task->format) {
+        if (!task->format)
+            task->error = QCoreApplication::translate("Tiled::DocumentManager", "Unrecognized file format.");
+
+        readFinished(task);
+    } else if (canReadInBackground(task->format)) {
+        mThreadPool.start(new ReadRunnable(this, task), priority);
+    } else {
+        mMainThreadTasks.enqueue(task);
+        if (mMainThreadTasks.size() == 1)
+            QMetaObject::invokeMethod(this, &DocumentLoader::readNextOnMainThread, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Cancels loading of the files requested by the given \a owner. Files that
+ * were also requested by others continue to load. Files that are currently
+ * being parsed are finished in the background, but their results are
+ * discarded.
+ */
+void DocumentLoader::cancel(const QObject *owner)
+{
+    int canceledCount = 0;
+
+    // The tasks are deleted when they come back from the thread pool or the
+    // main thread queue. Reading is skipped when it didn't start yet.
+    for (auto it = mPendingTasks.begin(); it != mPendingTasks.end(); ) {
+        Task *task = it.value();
+        task->owners.removeOne(owner);
+
+        if (task->owners.isEmpty()) {
+            task->canceled = true;
+            it = mPendingTasks.erase(it);
+            ++canceledCount;
+        } else {
+            ++it;
+        }
+    }
+
+    if (canceledCount == 0)
+        return;
+
+    mTotalCount -= canceledCount;
+    updateProgress();
+}
+
+/**
+ * Only the built-in formats are known to be safe to use from worker threads.
+ * They are stateless apart from their error string, so each read uses its own
+ * instance.
+ */
+bool DocumentLoader::canReadInBackground(FileFormat *format)
+{
+    return qobject_cast<TmxMapFormat*>(format) || qobject_cast<TsxTilesetFormat*>(format);
+}
+
+/**
+ * Reads the file of the given \a task. Called from a worker thread for the
+ * formats supporting this, and on the main thread otherwise.
+ */
+void DocumentLoader::read(Task *task)
+{
+    if (task->canceled)
+        return;
+
+    if (qobject_cast<TmxMapFormat*>(task->format)) {
+        TmxMapFormat format;
+        task->map = format.read(task->fileName);
+        if (!task->map)
+            task->error = format.errorString();
+    } else if (qobject_cast<TsxTilesetFormat*>(task->format)) {
+        TsxTilesetFormat format;
+        task->tileset = format.read(task->fileName);
+        if (!task->tileset)
+            task->error = format.errorString();
+    } else if (auto mapFormat = qobject_cast<MapFormat*>(task->format)) {
+        task->map = mapFormat->read(task->fileName);
+        if (!task->map)
+            task->error = mapFormat->errorString();
+    } else if (auto tilesetFormat = qobject_cast<TilesetFormat*>(task->format)) {
+        task->tileset = tilesetFormat->read(task->fileName);
+        if (!task->tileset)
+            task->error = tilesetFormat->errorString();
+    }
+}
+
+/**
+ * Called when the given \a task has been read. May be called from any
+ * thread, the task is finished on the main thread.
+ */
+void DocumentLoader::readFinished(Task *task)
+{
+    QMutexLocker locker(&mFinishedMutex);
+    mFinishedTasks.append(task);
+
+    if (mFinishedTasks.size() == 1)
+        QMetaObject::invokeMethod(this, &DocumentLoader::processFinishedTasks, Qt::QueuedConnection);
+}
+
+void DocumentLoader::readNextOnMainThread()
+{
+    if (mMainThreadTasks.isEmpty())
+        return;
+
+    Task *task = mMainThreadTasks.dequeue();
+
+    // Keep the event loop going between files
+    if (!mMainThreadTasks.isEmpty())
+        QMetaObject::invokeMethod(this, &DocumentLoader::readNextOnMainThread, Qt::QueuedConnection);
+
+    read(task);
+    finishTask(task);
+}
+
+void DocumentLoader::processFinishedTasks()
+{
+    QVector<Task*> finishedTasks;
+    {
+        QMutexLocker locker(&mFinishedMutex);
+        finishedTasks.swap(mFinishedTasks);
+    }
+
+    for (Task *task : qAsConst(finishedTasks))
+        finishTask(task);
+}
+
+/**
+ * Creates the document for the given \a task, reports it and deletes the
+ * task.
+ */
+void DocumentLoader::finishTask(Task *task)
+{
+    std::unique_ptr<Task> taskOwner(task);
+
+    if (task->canceled)
+        return;
+
+    mPendingTasks.remove(task->fileName);
+    ++mFinishedCount;
+
+    DocumentPtr document = task->document;
+
+    // The file may have been loaded by other means in the meantime
+    if (!document && (task->map || task->tileset))
+        document = DocumentManager::instance()->findLoadedDocument(task->fileName);
+
+    if (!document) {
+        if (task->map) {
+            document = MapDocument::fromLoadedMap(std::move(task->map),
+                                                  task->fileName,
+                                                  static_cast<MapFormat*>(task->format));
+        } else if (task->tileset) {
+            document = TilesetDocument::fromLoadedTileset(task->tileset,
+                                                          task->fileName,
+                                                          static_cast<TilesetFormat*>(task->format));
+        }
+    }
+
+    emit documentLoaded(task->fileName, document, task->error);
+    updateProgress();
+}
+
+void DocumentLoader::updateProgress()
+{
+    emit progressChanged(mFinishedCount, mTotalCount);
+
+    if (mPendingTasks.isEmpty() && mTotalCount > 0) {
+        mFinishedCount = 0;
+        mTotalCount = 0;
+        emit finished();
+    }
+}
+
+} // namespace Tiled
+
+#include "moc_documentloader.cpp"
@@ -0,0 +1,147 @@
+/*
+ * documentloader.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "document.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QThreadPool>
+#include <QVector>
+
+namespace Tiled {
+
+class FileFormat;
+
+/**
+ * Loads map and tileset documents in the background.
+ *
+ * Files in the built-in TMX and TSX formats are parsed on a thread pool.
+ * Other formats are not known to be thread-safe, so those files are read on
+ * the main thread, one file per event loop iteration. In both cases the
+ * documents are created on the main thread and reported by the
+ * documentLoaded() signal.
+ *
+ * A file that is already loaded is reported as soon as control returns to
+ * the event loop. Requesting a file that is still being loaded does not load
+ * it again.
+ */
+class DocumentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentLoader(QObject *parent = nullptr);
+    ~DocumentLoader() override;
+
+    void load(const QString &fileName,
+              FileFormat *fileFormat = nullptr,
+              int priority = 0,
+              const QObject *owner = nullptr);
+    void cancel(const QObject *owner);
+
+    bool isLoading() const;
+    bool isLoading(const QString &fileName) const;
+
+    int finishedCount() const;
+    int totalCount() const;
+
+signals:
+    /**
+     * Emitted when a file has been loaded. The \a document is null when
+     * loading failed, in which case \a error describes the problem.
+     */
+    void documentLoaded(const QString &fileName,
+                        const DocumentPtr &document,
+                        const QString &error);
+
+    /**
+     * Emitted whenever a file was requested or finished loading. Both counts
+     * are reset once all requested files have been loaded.
+     */
+    void progressChanged(int finished, int total);
+
+    /**
+     * Emitted when all requested files have been loaded, or when loading was
+     * canceled.
+     */
+    void finished();
+
+private:
+    struct Task;
+    class ReadRunnable;
+
+    static bool canReadInBackground(FileFormat *format);
+    static void read(Task *task);
+
+    void readFinished(Task *task);
+    void readNextOnMainThread();
+    void processFinishedTasks();
+    void finishTask(Task *task);
+    void updateProgress();
+
+    QThreadPool mThreadPool;
+    QHash<QString, Task*> mPendingTasks;
+    QQueue<Task*> mMainThreadTasks;
+
+    QMutex mFinishedMutex;
+    QVector<Task*> mFinishedTasks;
+
+    int mFinishedCount = 0;
+    int mTotalCount = 0;
+};
+
+/**
+ * Returns whether any of the requested files are still being loaded.
+ */
+inline bool DocumentLoader::isLoading() const
+{
+    return !mPendingTasks.isEmpty();
+}
+
+/**
+ * Returns whether the given file is still being loaded.
+ */
+inline bool DocumentLoader::isLoading(const QString &fileName) const
+{
+    return mPendingTasks.contains(fileName);
+}
+
+/**
+ * Returns the number of files that finished loading since the loader was
+ * last idle.
+ */
+inline int DocumentLoader::finishedCount() const
+{
+    return mFinishedCount;
+}
+
+/**
+ * Returns the number of files requested since the loader was last idle.
+ */
+inline int DocumentLoader::totalCount() const
+{
+    return mTotalCount;
+}
+
+} // namespace Tiled
@@ -25,6 +25,7 @@
 #include "adjusttileindexes.h"
 #include "brokenlinks.h"
 #include "containerhelpers.h"
+#include "documentloader.h"
 #include "editableasset.h"
 #include "editor.h"
 #include "filechangedwarning.h"
@@ -95,6 +96,7 @@ DocumentManager::DocumentManager(QObject *parent)
     , mMapEditor(nullptr) // todo: look into removing this
     , mUndoGroup(new QUndoGroup(this))
     , mFileSystemWatcher(new FileSystemWatcher(this))
+    , mDocumentLoader(new DocumentLoader(this))
     , mMultiDocumentClose(false)
 {
     Q_ASSERT(!mInstance);
@@ -629,21 +631,24 @@ static bool isDocumentChangedOnDisk(Document *document)
     return document->changedOnDisk();
 }
 
+/**
+ * Loads the document with the given \a fileName, or returns the already
+ * loaded document for this file.
+ *
+ * When no \a fileFormat is given, the format is detected based on the file.
+ *
+ * \sa DocumentLoader for loading documents in the background.
+ */
 DocumentPtr DocumentManager::loadDocument(const QString &fileName,
                                           FileFormat *fileFormat,
                                           QString *error)
 {
     // Try to find it in already loaded documents
-    QString canonicalFilePath = QFileInfo(fileName).canonicalFilePath();
-    if (Document *doc = Document::documentInstances().value(canonicalFilePath))
-        return doc->sharedFromThis();
+    if (DocumentPtr document = findLoadedDocument(fileName))
+        return document;
 
-    if (!fileFormat) {
-        // Try to find a plugin that implements support for this format
-        fileFormat = PluginManager::find<FileFormat>([&](FileFormat *format) {
-            return format->hasCapabilities(FileFormat::Read) && format->supportsFile(fileName);
-        });
-    }
+    if (!fileFormat)
+        fileFormat = findReadFormat(fileName);
 
     if (!fileFormat) {
         if (error)
@@ -653,20 +658,43 @@ DocumentPtr DocumentManager::loadDocument(const QString &fileName,
 
     DocumentPtr document;
 
-    if (MapFormat *mapFormat = qobject_cast<MapFormat*>(fileFormat)) {
+    if (MapFormat *mapFormat = qobject_cast<MapFormat*>(fileFormat))
         document = MapDocument::load(fileName, mapFormat, error);
-    } else if (TilesetFormat *tilesetFormat = qobject_cast<TilesetFormat*>(fileFormat)) {
-        // It could be, that we have already loaded this tileset while loading some map.
-        if (auto tilesetDocument = findTilesetDocument(fileName)) {
-            document = tilesetDocument->sharedFromThis();
-        } else {
-            document = TilesetDocument::load(fileName, tilesetFormat, error);
-        }
-    }
+    else if (TilesetFormat *tilesetFormat = qobject_cast<TilesetFormat*>(fileFormat))
+        document = TilesetDocument::load(fileName, tilesetFormat, error);
 
     return document;
 }
 
+/**
+ * Returns the already loaded document for the given \a fileName, or null
+ * when this file hasn't been loaded.
+ */
+DocumentPtr DocumentManager::findLoadedDocument(const QString &fileName) const
+{
+    QString canonicalFilePath = QFileInfo(fileName).canonicalFilePath();
+    if (Document *doc = Document::documentInstances().value(canonicalFilePath))
+        return doc->sharedFromThis();
+
+    // It could be, that we have already loaded this tileset while loading some map.
+    if (auto tilesetDocument = findTilesetDocument(fileName))
+        return tilesetDocument->sharedFromThis();
+
+    return DocumentPtr();
+}
+
+/**
+ * Returns a map or tileset format that supports reading the given file, or
+ * null when no such format is available.
+ */
+FileFormat *DocumentManager::findReadFormat(const QString &fileName)
+{
+    // Try to find a plugin that implements support for this format
+    return PluginManager::find<FileFormat>([&](FileFormat *format) {
+        return format->hasCapabilities(FileFormat::Read) && format->supportsFile(fileName);
+    });
+}
+
 /**
  * Save the given document with the given file name.
  *
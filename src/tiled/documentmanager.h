@@ -44,6 +44,7 @@ class AbstractTool;
 class BrokenLinksModel;
 class BrokenLinksWidget;
 class Document;
+class DocumentLoader;
 class Editor;
 class FileChangedWarning;
 class MainWindow;
@@ -108,6 +109,10 @@ public:
     DocumentPtr loadDocument(const QString &fileName,
                              FileFormat *fileFormat = nullptr,
                              QString *error = nullptr);
+    DocumentPtr findLoadedDocument(const QString &fileName) const;
+    static FileFormat *findReadFormat(const QString &fileName);
+
+    DocumentLoader *documentLoader() const;
 
     bool saveDocument(Document *document, const QString &fileName);
     bool saveDocumentAs(Document *document);
@@ -238,6 +243,7 @@ private:
 
     QUndoGroup *mUndoGroup;
     FileSystemWatcher *mFileSystemWatcher;
+    DocumentLoader *mDocumentLoader;
 
     static DocumentManager *mInstance;
 
@@ -255,6 +261,14 @@ inline QUndoGroup *DocumentManager::undoGroup() const
     return mUndoGroup;
 }
 
+/**
+ * Returns the loader used for loading documents in the background.
+ */
+inline DocumentLoader *DocumentManager::documentLoader() const
+{
+    return mDocumentLoader;
+}
+
 /**
  * Returns all open documents.
  */
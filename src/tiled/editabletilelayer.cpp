@@ -23,10 +23,16 @@
 #include "changelayer.h"
 #include "editablemanager.h"
 #include "editablemap.h"
+#include "gidmapper.h"
 #include "resizetilelayer.h"
+#include "scriptmanager.h"
 #include "tilelayeredit.h"
 #include "tilesetdocument.h"
 
+#include <QCoreApplication>
+
+#include <limits>
+
 namespace Tiled {
 
 EditableTileLayer::EditableTileLayer(const QString &name, QSize size, QObject *parent)
@@ -96,6 +102,32 @@ EditableTile *EditableTileLayer::tileAt(int x, int y) const
     return EditableManager::instance().editableTile(cellAt(x, y).tile());
 }
 
+/**
+ * Returns the global tile IDs of the cells in the given rectangle, in
+ * row-major order, as a buffer of 32-bit unsigned integers. The GIDs include
+ * the flip flags and are the same as used when saving the map.
+ *
+ * Allows scripts to read large areas in one call, for example using
+ * `new Uint32Array(layer.gids(0, 0, layer.width, layer.height))`.
+ */
+QByteArray EditableTileLayer::gids(int x, int y, int width, int height) const
+{
+    const qint64 cellCount = qint64(qMax(width, 0)) * qMax(height, 0);
+    if (width < 0 || height < 0 || cellCount * qint64(sizeof(quint32)) > std::numeric_limits<int>::max()) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid size"));
+        return QByteArray();
+    }
+
+    const Map *map = tileLayer()->map();
+    if (!map) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Layer is not part of a map"));
+        return QByteArray();
+    }
+
+    const GidMapper gidMapper(map->tilesets());
+    return gidMapper.encodeGids(*tileLayer(), QRect(x, y, width, height));
+}
+
 TileLayerEdit *EditableTileLayer::edit()
 {
     return new TileLayerEdit(this);
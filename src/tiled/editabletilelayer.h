@@ -62,6 +62,7 @@ public:
     Q_INVOKABLE Tiled::Cell cellAt(int x, int y) const;
     Q_INVOKABLE int flagsAt(int x, int y) const;
     Q_INVOKABLE Tiled::EditableTile *tileAt(int x, int y) const;
+    Q_INVOKABLE QByteArray gids(int x, int y, int width, int height) const;
 
     Q_INVOKABLE Tiled::TileLayerEdit *edit();
 
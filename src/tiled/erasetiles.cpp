@@ -40,40 +40,35 @@ EraseTiles::EraseTiles(MapDocument *mapDocument,
 
     // Store the tiles that are to be erased
     const QRegion r = region.translated(-tileLayer->position());
-    data.mErasedCells = tileLayer->copy(r).release();
+    data.mErasedCells = tileLayer->copy(r);
 }
 
 EraseTiles::~EraseTiles()
 {
-    for (LayerData &data : mLayerData)
-        delete data.mErasedCells;
 }
 
 void EraseTiles::undo()
 {
-    QHashIterator<TileLayer*, LayerData> it(mLayerData);
-    while (it.hasNext()) {
-        const LayerData &data = it.next().value();
+    for (const std::pair<TileLayer* const, LayerData> &entry : mLayerData) {
+        const LayerData &data = entry.second;
         const QRect bounds = data.mRegion.boundingRect();
-        TilePainter painter(mMapDocument, it.key());
-        painter.drawCells(bounds.x(), bounds.y(), data.mErasedCells);
+        TilePainter painter(mMapDocument, entry.first);
+        painter.drawCells(bounds.x(), bounds.y(), data.mErasedCells.get());
     }
 }
 
 void EraseTiles::redo()
 {
-    QHashIterator<TileLayer*, LayerData> it(mLayerData);
-    while (it.hasNext()) {
-        const LayerData &data = it.next().value();
-        TilePainter painter(mMapDocument, it.key());
-        painter.erase(data.mRegion);
+    for (const std::pair<TileLayer* const, LayerData> &entry : mLayerData) {
+        TilePainter painter(mMapDocument, entry.first);
+        painter.erase(entry.second.mRegion);
     }
 }
 
 void EraseTiles::LayerData::mergeWith(const EraseTiles::LayerData &o)
 {
     if (!mErasedCells) {
-        mErasedCells = o.mErasedCells->clone();
+        mErasedCells = std::unique_ptr<TileLayer>(o.mErasedCells->clone());
         mRegion = o.mRegion;
         return;
     }
@@ -92,7 +87,7 @@ void EraseTiles::LayerData::mergeWith(const EraseTiles::LayerData &o)
         // Copy the newly erased tiles over
         const QRect otherBounds = o.mRegion.boundingRect();
         const QPoint pos = otherBounds.topLeft() - combinedBounds.topLeft();
-        mErasedCells->merge(pos, o.mErasedCells);
+        mErasedCells->merge(pos, o.mErasedCells.get());
 
         mRegion = combinedRegion;
     }
@@ -106,11 +101,30 @@ bool EraseTiles::mergeWith(const QUndoCommand *other)
     if (!cloneChildren(other, this))
         return false;
 
-    QHashIterator<TileLayer*, LayerData> it(o->mLayerData);
-    while (it.hasNext()) {
-        it.next();
-        mLayerData[it.key()].mergeWith(it.value());
-    }
+    for (const std::pair<TileLayer* const, LayerData> &entry : o->mLayerData)
+        mLayerData[entry.first].mergeWith(entry.second);
 
     return true;
 }
+
+qint64 EraseTiles::memoryUsage() const
+{
+    qint64 usage = 0;
+    for (const std::pair<TileLayer* const, LayerData> &entry : mLayerData)
+        usage += entry.second.mErasedCells.memoryUsage();
+    return usage;
+}
+
+bool EraseTiles::compress()
+{
+    bool compressed = false;
+
+    // The erased cells are stored relative to the top-left of the region
+    for (std::pair<TileLayer* const, LayerData> &entry : mLayerData) {
+        LayerData &data = entry.second;
+        const QPoint origin = data.mRegion.boundingRect().topLeft();
+        compressed |= data.mErasedCells.pack(data.mRegion.translated(-origin));
+    }
+
+    return compressed;
+}
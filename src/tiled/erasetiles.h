@@ -20,12 +20,14 @@
 
 #pragma once
 
+#include "tilelayersnapshot.h"
 #include "undocommands.h"
 
-#include <QHash>
 #include <QRegion>
 #include <QUndoCommand>
 
+#include <unordered_map>
+
 namespace Tiled {
 
 class Tile;
@@ -33,7 +35,7 @@ class TileLayer;
 
 class MapDocument;
 
-class EraseTiles : public QUndoCommand
+class EraseTiles : public QUndoCommand, public CompressibleUndoCommand
 {
 public:
     EraseTiles(MapDocument *mapDocument,
@@ -53,17 +55,20 @@ public:
     int id() const override { return Cmd_EraseTiles; }
     bool mergeWith(const QUndoCommand *other) override;
 
+    qint64 memoryUsage() const override;
+    bool compress() override;
+
 private:
     struct LayerData
     {
         void mergeWith(const LayerData &o);
 
-        TileLayer *mErasedCells = nullptr;
+        TileLayerSnapshot mErasedCells;
         QRegion mRegion;
     };
 
     MapDocument *mMapDocument;
-    QHash<TileLayer*, LayerData> mLayerData;
+    std::unordered_map<TileLayer*, LayerData> mLayerData;
     bool mMergeable;
 };
 
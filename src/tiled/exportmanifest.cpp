@@ -0,0 +1,258 @@
+/*
+ * exportmanifest.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exportmanifest.h"
+
+#include "dependencyindex.h"
+#include "mapformat.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+
+namespace Tiled {
+
+// The minimum age of a file in msecs, for its hash to be reused when its
+// modification time and size did not change
+static constexpr qint64 MinimumCachedAge = 2000;
+
+static constexpr quint32 ExportManifestMagic = 0x54454d46;     // "TEMF"
+static constexpr quint32 ExportManifestVersion = 1;
+
+static QDataStream &operator<<(QDataStream &out, const ExportManifest::FileState &file)
+{
+    return out << file.lastModified << file.size << file.hash << file.dependencies;
+}
+
+static QDataStream &operator>>(QDataStream &in, ExportManifest::FileState &file)
+{
+    return in >> file.lastModified >> file.size >> file.hash >> file.dependencies;
+}
+
+static QDataStream &operator<<(QDataStream &out, const ExportManifest::Entry &entry)
+{
+    return out << entry.hash << entry.targetFile;
+}
+
+static QDataStream &operator>>(QDataStream &in, ExportManifest::Entry &entry)
+{
+    return in >> entry.hash >> entry.targetFile;
+}
+
+static QString manifestFileName(const QString &projectFileName)
+{
+    if (projectFileName.isEmpty())
+        return QString();
+
+    const QByteArray hash = QCryptographicHash::hash(projectFileName.toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    path += QLatin1String("/export-manifests/");
+    path += QString::fromLatin1(hash);
+    path += QLatin1String(".cache");
+    return path;
+}
+
+static QString cleanFilePath(const QString &fileName)
+{
+    return QDir::cleanPath(QFileInfo(fileName).absoluteFilePath());
+}
+
+
+ExportManifest::ExportManifest(const QString &projectFileName)
+    : mFileName(manifestFileName(projectFileName))
+{
+    if (!projectFileName.isEmpty())
+        mProjectFileName = cleanFilePath(projectFileName);
+
+    QFile file(mFileName);
+    if (mFileName.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic;
+    quint32 version;
+    in >> magic >> version;
+    if (magic != ExportManifestMagic || version != ExportManifestVersion)
+        return;
+
+    in >> mFiles >> mEntries;
+    if (in.status() != QDataStream::Ok) {
+        mFiles.clear();
+        mEntries.clear();
+    }
+}
+
+/**
+ * Returns a hash identifying the state of the given source file when it is
+ * exported to \a targetFile using \a format and \a options. The hash covers
+ * the contents of the source file and of all files it refers to, directly
+ * or through its tilesets and templates, as well as the project file, since
+ * the exported data can depend on the project's custom property types.
+ *
+ * The \a targetFile and \a format may be left empty when the map's own
+ * export settings are used, since those are part of the source file.
+ */
+QByteArray ExportManifest::sourceHash(const QString &sourceFile,
+                                      const QString &targetFile,
+                                      const MapFormat *format,
+                                      Preferences::ExportOptions options)
+{
+    QSet<QString> files;
+    collectFiles(cleanFilePath(sourceFile), files);
+
+    QStringList sortedFiles = files.values();
+    std::sort(sortedFiles.begin(), sortedFiles.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(static_cast<int>(options)));
+    hash.addData(targetFile.toUtf8());
+    if (format)
+        hash.addData(format->shortName().toUtf8());
+    if (!mProjectFileName.isEmpty())
+        hash.addData(fileState(mProjectFileName).hash);
+
+    for (const QString &fileName : qAsConst(sortedFiles)) {
+        hash.addData(fileName.toUtf8());
+        hash.addData(mFiles.value(fileName).hash);
+    }
+
+    return hash.result();
+}
+
+/**
+ * Returns whether the given source file was exported with the same \a hash,
+ * and its target file still exists.
+ */
+bool ExportManifest::isUpToDate(const QString &sourceFile, const QByteArray &hash) const
+{
+    const auto it = mEntries.constFind(cleanFilePath(sourceFile));
+    if (it == mEntries.constEnd() || it->hash != hash)
+        return false;
+
+    return it->targetFile.isEmpty() || QFileInfo::exists(it->targetFile);
+}
+
+/**
+ * Records that the given source file was exported to \a targetFile. An empty
+ * \a targetFile records that the map has nothing to export to.
+ */
+void ExportManifest::setExported(const QString &sourceFile,
+                                 const QString &targetFile,
+                                 const QByteArray &hash)
+{
+    Entry &entry = mEntries[cleanFilePath(sourceFile)];
+    entry.hash = hash;
+    entry.targetFile = targetFile;
+    mModified = true;
+}
+
+/**
+ * Writes the manifest to the cache directory, when it was changed.
+ */
+bool ExportManifest::save()
+{
+    if (!mModified || mFileName.isEmpty())
+        return true;
+    if (!QDir().mkpath(QFileInfo(mFileName).path()))
+        return false;
+
+    QSaveFile file(mFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << ExportManifestMagic << ExportManifestVersion << mFiles << mEntries;
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        return false;
+
+    mModified = false;
+    return true;
+}
+
+/**
+ * Returns the state of the given file, hashing its contents when it changed
+ * since it was last seen. Each file is only checked once per manifest.
+ */
+const ExportManifest::FileState &ExportManifest::fileState(const QString &fileName)
+{
+    FileState &state = mFiles[fileName];
+    if (mCheckedFiles.contains(fileName))
+        return state;
+
+    mCheckedFiles.insert(fileName);
+
+    const QFileInfo fileInfo(fileName);
+    const qint64 lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size = fileInfo.exists() ? fileInfo.size() : -1;
+
+    if (state.lastModified != 0 && state.lastModified == lastModified && state.size == size)
+        return state;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    state.lastModified = now - lastModified > MinimumCachedAge ? lastModified : 0;
+    state.size = size;
+    state.hash.clear();
+    state.dependencies.clear();
+
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly)) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(&file);
+        state.hash = hash.result();
+
+        if (DependencyIndex::isIndexed(fileName))
+            state.dependencies = DependencyIndex::readDependencies(fileName);
+    }
+
+    mModified = true;
+    return state;
+}
+
+/**
+ * Adds the given file and the files it depends on to \a files.
+ */
+void ExportManifest::collectFiles(const QString &fileName, QSet<QString> &files)
+{
+    if (files.contains(fileName))
+        return;
+
+    files.insert(fileName);
+
+    // Copy, since the reference may be invalidated by the recursion
+    const QStringList dependencies = fileState(fileName).dependencies;
+    for (const QString &dependency : dependencies)
+        collectFiles(dependency, files);
+}
+
+} // namespace Tiled
@@ -0,0 +1,91 @@
+/*
+ * exportmanifest.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "preferences.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+namespace Tiled {
+
+class MapFormat;
+
+/**
+ * Remembers which maps of a project were exported, and what their source
+ * files looked like at the time, so that only the maps that changed need to
+ * be exported again.
+ *
+ * A map is considered changed when its own file or any of the files it
+ * (indirectly) refers to changed, or when it is exported with different
+ * options, or when the project file changed (it defines the custom property
+ * types). Files are compared by the hash of their contents, which is only
+ * computed again when their size or modification time changed.
+ *
+ * The manifest is stored in the cache directory, per project.
+ */
+class ExportManifest
+{
+public:
+    struct FileState
+    {
+        qint64 lastModified = 0;    // msecs since epoch
+        qint64 size = -1;
+        QByteArray hash;
+        QStringList dependencies;
+    };
+
+    struct Entry
+    {
+        QByteArray hash;
+        QString targetFile;         // empty when the map has no export target
+    };
+
+    explicit ExportManifest(const QString &projectFileName);
+
+    QByteArray sourceHash(const QString &sourceFile,
+                          const QString &targetFile,
+                          const MapFormat *format,
+                          Preferences::ExportOptions options);
+
+    bool isUpToDate(const QString &sourceFile, const QByteArray &hash) const;
+    void setExported(const QString &sourceFile,
+                     const QString &targetFile,
+                     const QByteArray &hash);
+
+    bool save();
+
+private:
+    const FileState &fileState(const QString &fileName);
+    void collectFiles(const QString &fileName, QSet<QString> &files);
+
+    QString mFileName;
+    QString mProjectFileName;
+    QHash<QString, FileState> mFiles;
+    QHash<QString, Entry> mEntries;
+    QSet<QString> mCheckedFiles;
+    bool mModified = false;
+};
+
+} // namespace Tiled
@@ -0,0 +1,241 @@
+/*
+ * filesearch.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filesearch.h"
+
+#include "utils.h"
+
+#include <QRunnable>
+
+#include <algorithm>
+
+namespace Tiled {
+
+// The number of files searched before reporting the matches found so far
+static constexpr int BatchSize = 4096;
+
+class FileSearch::SearchRunnable : public QRunnable
+{
+public:
+    SearchRunnable(FileSearch *search,
+                   int generation,
+                   const QVector<ProjectModel::IndexedFile> &files,
+                   const QStringList &words,
+                   const QVector<int> &candidates,
+                   bool useCandidates)
+        : mSearch(search)
+        , mGeneration(generation)
+        , mFiles(files)
+        , mWords(words)
+        , mCandidates(candidates)
+        , mUseCandidates(useCandidates)
+    {}
+
+    void run() override;
+
+private:
+    bool isCanceled() const { return mSearch->mGeneration != mGeneration; }
+    void report(bool finished);
+
+    FileSearch * const mSearch;
+    const int mGeneration;
+    const QVector<ProjectModel::IndexedFile> mFiles;
+    const QStringList mWords;
+    const QVector<int> mCandidates;
+    const bool mUseCandidates;
+
+    QVector<ProjectModel::Match> mMatches;
+    QVector<int> mMatchingFiles;
+};
+
+void FileSearch::SearchRunnable::run()
+{
+    const quint64 wordsMask = Utils::characterMask(mWords);
+    const int count = mUseCandidates ? mCandidates.size() : mFiles.size();
+
+    for (int i = 0; i < count; ++i) {
+        if (i > 0 && i % BatchSize == 0) {
+            if (isCanceled())
+                return;
+            report(false);
+        }
+
+        const int fileIndex = mUseCandidates ? mCandidates.at(i) : i;
+        const ProjectModel::IndexedFile &file = mFiles.at(fileIndex);
+
+        // Quickly skip files that lack any of the searched characters
+        if ((file.characterMask & wordsMask) != wordsMask)
+            continue;
+
+        const int score = Utils::matchingScore(mWords, file.relativePath());
+        if (score > 0) {
+            mMatches.append(ProjectModel::Match { score, file.offset, file.path });
+            mMatchingFiles.append(fileIndex);
+        }
+    }
+
+    if (!isCanceled())
+        report(true);
+}
+
+/**
+ * Reports the matches found since the last report to the main thread.
+ */
+void FileSearch::SearchRunnable::report(bool finished)
+{
+    if (mMatches.isEmpty() && !finished)
+        return;
+
+    std::stable_sort(mMatches.begin(), mMatches.end(), &FileSearch::lessThan);
+
+    QMetaObject::invokeMethod(mSearch,
+                              [search = mSearch,
+                               generation = mGeneration,
+                               matches = std::move(mMatches),
+                               matchingFiles = std::move(mMatchingFiles),
+                               finished] {
+        search->resultsFound(generation, matches, matchingFiles, finished);
+    }, Qt::QueuedConnection);
+
+    mMatches.clear();
+    mMatchingFiles.clear();
+}
+
+
+FileSearch::FileSearch(ProjectModel *projectModel, QObject *parent)
+    : QObject(parent)
+    , mProjectModel(projectModel)
+{
+    // Only one search is relevant at a time
+    mThreadPool.setMaxThreadCount(1);
+
+    connect(projectModel, &ProjectModel::fileIndexChanged,
+            this, &FileSearch::invalidateLastSearch);
+}
+
+FileSearch::~FileSearch()
+{
+    ++mGeneration;
+    mThreadPool.waitForDone();
+}
+
+/**
+ * Starts searching for files matching the given \a words, canceling any
+ * search that is still running.
+ *
+ * \sa Utils::matchingScore
+ */
+void FileSearch::search(const QStringList &words)
+{
+    const int generation = ++mGeneration;
+    const bool useCandidates = mHasLastSearch && isRefinement(mLastWords, words);
+
+    mThreadPool.start(new SearchRunnable(this,
+                                         generation,
+                                         mProjectModel->fileIndex(),
+                                         words,
+                                         useCandidates ? mLastMatchingFiles : QVector<int>(),
+                                         useCandidates));
+
+    mSearching = true;
+    mSearchIndexValid = true;
+    mWords = words;
+    mMatchingFiles.clear();
+}
+
+/**
+ * Cancels the current search. No more matches will be reported for it.
+ */
+void FileSearch::cancel()
+{
+    ++mGeneration;
+    mSearching = false;
+}
+
+/**
+ * The order in which matches should be displayed. Matches with a higher
+ * score come first, and matches with the same score are sorted
+ * alphabetically.
+ */
+bool FileSearch::lessThan(const ProjectModel::Match &a,
+                          const ProjectModel::Match &b)
+{
+    if (a.score != b.score)
+        return a.score > b.score;
+
+    return a.relativePath().compare(b.relativePath(), Qt::CaseInsensitive) < 0;
+}
+
+void FileSearch::resultsFound(int generation,
+                              const QVector<ProjectModel::Match> &matches,
+                              const QVector<int> &matchingFiles,
+                              bool finished)
+{
+    if (generation != mGeneration)
+        return;
+
+    mMatchingFiles.append(matchingFiles);
+
+    if (!matches.isEmpty())
+        emit matchesFound(matches);
+
+    if (finished) {
+        mSearching = false;
+
+        // The matching files can only be used for refining the next search
+        // when they refer to the current file index
+        mHasLastSearch = mSearchIndexValid;
+        mLastWords = mWords;
+        mLastMatchingFiles.swap(mMatchingFiles);
+        mMatchingFiles.clear();
+
+        emit this->finished();
+    }
+}
+
+void FileSearch::invalidateLastSearch()
+{
+    mHasLastSearch = false;
+    mSearchIndexValid = false;
+    mLastWords.clear();
+    mLastMatchingFiles.clear();
+}
+
+/**
+ * Returns whether any file matching \a words is also matched by
+ * \a previousWords. This is the case when each of the previous words is the
+ * start of the word at the same position.
+ */
+bool FileSearch::isRefinement(const QStringList &previousWords,
+                              const QStringList &words)
+{
+    if (previousWords.size() > words.size())
+        return false;
+
+    for (int i = 0; i < previousWords.size(); ++i)
+        if (!words.at(i).startsWith(previousWords.at(i), Qt::CaseInsensitive))
+            return false;
+
+    return true;
+}
+
+} // namespace Tiled
+
+#include "moc_filesearch.cpp"
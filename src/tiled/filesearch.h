@@ -0,0 +1,106 @@
+/*
+ * filesearch.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "projectmodel.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+
+namespace Tiled {
+
+/**
+ * Searches the file index of a ProjectModel on a worker thread.
+ *
+ * The matches are reported in sorted batches while the search is running.
+ * Starting a new search cancels the previous one. When the new words refine
+ * the words of the last finished search, only the files that matched before
+ * are searched again.
+ */
+class FileSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileSearch(ProjectModel *projectModel, QObject *parent = nullptr);
+    ~FileSearch() override;
+
+    void search(const QStringList &words);
+    void cancel();
+
+    bool isSearching() const;
+
+    static bool lessThan(const ProjectModel::Match &a,
+                         const ProjectModel::Match &b);
+
+signals:
+    /**
+     * Emitted for each batch of matches found by the current search. Each
+     * batch is sorted using lessThan().
+     */
+    void matchesFound(const QVector<ProjectModel::Match> &matches);
+
+    /**
+     * Emitted when the current search has finished.
+     */
+    void finished();
+
+private:
+    class SearchRunnable;
+
+    void resultsFound(int generation,
+                      const QVector<ProjectModel::Match> &matches,
+                      const QVector<int> &matchingFiles,
+                      bool finished);
+    void invalidateLastSearch();
+
+    static bool isRefinement(const QStringList &previousWords,
+                             const QStringList &words);
+
+    ProjectModel *mProjectModel;
+    QThreadPool mThreadPool;
+    std::atomic<int> mGeneration { 0 };
+    bool mSearching = false;
+
+    // The current search
+    QStringList mWords;
+    QVector<int> mMatchingFiles;
+    bool mSearchIndexValid = false;
+
+    // The last finished search, used for refining the results
+    bool mHasLastSearch = false;
+    QStringList mLastWords;
+    QVector<int> mLastMatchingFiles;
+};
+
+/**
+ * Returns whether a search is currently running.
+ */
+inline bool FileSearch::isSearching() const
+{
+    return mSearching;
+}
+
+} // namespace Tiled
@@ -21,6 +21,7 @@
 #include "locatorwidget.h"
 
 #include "documentmanager.h"
+#include "filesearch.h"
 #include "filteredit.h"
 #include "projectmanager.h"
 #include "projectmodel.h"
@@ -313,6 +314,7 @@ LocatorWidget::LocatorWidget(QWidget *parent)
     , mResultsView(new ResultsView(this))
     , mListModel(new MatchesModel(this))
     , mDelegate(new MatchDelegate(this))
+    , mFileSearch(new FileSearch(ProjectManager::instance()->projectModel(), this))
 {
     setAttribute(Qt::WA_DeleteOnClose);
     setFrameStyle(QFrame::StyledPanel | QFrame::Plain);
@@ -344,7 +346,16 @@ LocatorWidget::LocatorWidget(QWidget *parent)
     verticalLayout->addStretch(0);
     setLayout(verticalLayout);
 
+    auto projectModel = ProjectManager::instance()->projectModel();
+
     connect(mFilterEdit, &QLineEdit::textChanged, this, &LocatorWidget::setFilterText);
+    connect(mFileSearch, &FileSearch::matchesFound, this, &LocatorWidget::matchesFound);
+    connect(mFileSearch, &FileSearch::finished, this, &LocatorWidget::searchFinished);
+    connect(projectModel, &ProjectModel::fileIndexChanged, this, [this] {
+        // Search again when files were found while the locator is open
+        if (isVisible())
+            setFilterText(mFilterEdit->text());
+    });
     connect(mResultsView, &QAbstractItemView::activated, this, [this] (const QModelIndex &index) {
         const QString file = mListModel->matches().at(index.row()).path;
         close();
@@ -370,32 +381,57 @@ void LocatorWidget::setFilterText(const QString &text)
 {
     // TODO: Only consider previously selected when user explicitly selected it
     // (rather than leaving at default selected first entry)
-    QString previousSelected;
+    mPreviousSelected.clear();
 
     const QModelIndex currentIndex = mResultsView->currentIndex();
     if (currentIndex.isValid())
-        previousSelected = mListModel->data(currentIndex).toString();
+        mPreviousSelected = mListModel->data(currentIndex).toString();
 
     const QString normalized = QDir::fromNativeSeparators(text);
 #if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    const QStringList words = normalized.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    mWords = normalized.split(QLatin1Char(' '), QString::SkipEmptyParts);
 #else
-    const QStringList words = normalized.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    mWords = normalized.split(QLatin1Char(' '), Qt::SkipEmptyParts);
 #endif
 
-    auto projectModel = ProjectManager::instance()->projectModel();
-    auto matches = projectModel->findFiles(words);
+    // The previous matches remain visible until the first new matches are found
+    mReplaceMatches = true;
+    mFileSearch->search(mWords);
+}
+
+void LocatorWidget::matchesFound(const QVector<ProjectModel::Match> &matches)
+{
+    if (mReplaceMatches) {
+        mReplaceMatches = false;
+        mDelegate->setWords(mWords);
+        setMatches(matches);
+        return;
+    }
 
-    std::stable_sort(matches.begin(), matches.end(), [] (const ProjectModel::Match &a, const ProjectModel::Match &b) {
-        // Sort based on score first
-        if (a.score != b.score)
-            return a.score > b.score;
+    // Merge the new matches with the ones found before, which are all sorted
+    QVector<ProjectModel::Match> merged = mListModel->matches();
+    const int previousCount = merged.size();
+    merged.append(matches);
+    std::inplace_merge(merged.begin(),
+                       merged.begin() + previousCount,
+                       merged.end(),
+                       &FileSearch::lessThan);
 
-        // If score is the same, sort alphabetically
-        return a.relativePath().compare(b.relativePath(), Qt::CaseInsensitive) < 0;
-    });
+    setMatches(merged);
+}
+
+void LocatorWidget::searchFinished()
+{
+    // No matches were found at all
+    if (mReplaceMatches) {
+        mReplaceMatches = false;
+        mDelegate->setWords(mWords);
+        setMatches(QVector<ProjectModel::Match>());
+    }
+}
 
-    mDelegate->setWords(words);
+void LocatorWidget::setMatches(const QVector<ProjectModel::Match> &matches)
+{
     mListModel->setMatches(matches);
 
     mResultsView->updateGeometry();
@@ -405,9 +441,9 @@ void LocatorWidget::setFilterText(const QString &text)
     if (!matches.isEmpty()) {
         int row = 0;
 
-        if (!previousSelected.isEmpty()) {
+        if (!mPreviousSelected.isEmpty()) {
             auto it = std::find_if(matches.cbegin(), matches.cend(), [&] (const ProjectModel::Match &match) {
-                return match.relativePath() == previousSelected;
+                return match.relativePath() == mPreviousSelected;
             });
             if (it != matches.cend())
                 row = std::distance(matches.cbegin(), it);
@@ -20,10 +20,13 @@
 
 #pragma once
 
+#include "projectmodel.h"
+
 #include <QFrame>
 
 namespace Tiled {
 
+class FileSearch;
 class FilterEdit;
 class MatchDelegate;
 class MatchesModel;
@@ -40,11 +43,19 @@ public:
 
 private:
     void setFilterText(const QString &text);
+    void matchesFound(const QVector<ProjectModel::Match> &matches);
+    void searchFinished();
+    void setMatches(const QVector<ProjectModel::Match> &matches);
 
     FilterEdit *mFilterEdit;
     ResultsView *mResultsView;
     MatchesModel *mListModel;
     MatchDelegate *mDelegate;
+    FileSearch *mFileSearch;
+
+    QStringList mWords;
+    QString mPreviousSelected;
+    bool mReplaceMatches = false;
 };
 
 } // namespace Tiled
@@ -20,8 +20,10 @@
  * this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "batchmapexporter.h"
 #include "commandlineparser.h"
 #include "exporthelper.h"
+#include "exportmanifest.h"
 #include "languagemanager.h"
 #include "mainwindow.h"
 #include "mapdocument.h"
@@ -29,14 +31,18 @@
 #include "mapreader.h"
 #include "pluginmanager.h"
 #include "preferences.h"
+#include "project.h"
 #include "scriptmanager.h"
 #include "sentryhelper.h"
 #include "stylehelper.h"
 #include "tiledapplication.h"
 #include "tileset.h"
 #include "tmxmapformat.h"
+#include "utils.h"
 
 #include <QDebug>
+#include <QDirIterator>
+#include <QFile>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -85,6 +91,7 @@ public:
     bool showedVersion = false;
     bool disableOpenGL = false;
     bool exportMap = false;
+    bool exportChanged = false;
     bool exportTileset = false;
     bool newInstance = false;
     Preferences::ExportOptions exportOptions;
@@ -94,6 +101,7 @@ private:
     void justQuit();
     void setDisableOpenGL();
     void setExportMap();
+    void setExportChanged();
     void setExportTileset();
     void setExportEmbedTilesets();
     void setExportDetachTemplateInstances();
@@ -171,6 +179,39 @@ inline T *findExportFormat(const QString *filter,
     return outputFormat;
 }
 
+/**
+ * Replaces any arguments starting with '@' by the lines of the file they
+ * refer to. This allows passing a large amount of source and target files
+ * to --export-map. Empty lines and lines starting with '#' are ignored.
+ *
+ * Returns false when a file could not be read.
+ */
+static bool expandResponseFiles(const QStringList &arguments, QStringList &expanded)
+{
+    for (const QString &argument : arguments) {
+        if (!argument.startsWith(QLatin1Char('@'))) {
+            expanded.append(argument);
+            continue;
+        }
+
+        QFile file(argument.mid(1));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to read '%1': %2")
+                                    .arg(file.fileName(), file.errorString());
+            return false;
+        }
+
+        QTextStream stream(&file);
+        while (!stream.atEnd()) {
+            const QString line = stream.readLine().trimmed();
+            if (!line.isEmpty() && !line.startsWith(QLatin1Char('#')))
+                expanded.append(line);
+        }
+    }
+
+    return true;
+}
+
 
 } // anonymous namespace
 
@@ -195,7 +236,12 @@ CommandLineHandler::CommandLineHandler()
     option<&CommandLineHandler::setExportMap>(
                 QChar(),
                 QLatin1String("--export-map"),
-                tr("Export the specified map file to target"));
+                tr("Export the specified map files to their targets"));
+
+    option<&CommandLineHandler::setExportChanged>(
+                QChar(),
+                QLatin1String("--export-changed"),
+                tr("Export the maps in the specified project that changed since their last export"));
 
     option<&CommandLineHandler::setExportTileset>(
                 QChar(),
@@ -258,6 +304,11 @@ void CommandLineHandler::setExportMap()
     exportMap = true;
 }
 
+void CommandLineHandler::setExportChanged()
+{
+    exportChanged = true;
+}
+
 void CommandLineHandler::setExportTileset()
 {
     exportTileset = true;
@@ -383,49 +434,100 @@ int main(int argc, char *argv[])
         Preferences::instance()->setUseOpenGL(false);
 
     if (commandLine.exportMap) {
-        // Get the path to the source file and target file
-        if (commandLine.exportTileset || commandLine.filesToOpen().length() < 2) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-map [format] <source> <target>");
+        QStringList exportArguments;
+        if (!expandResponseFiles(commandLine.filesToOpen(), exportArguments))
+            return 1;
+
+        // Get the path to the source files and target files
+        if (commandLine.exportTileset || exportArguments.length() < 2) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-map [format] <source> <target> [<source> <target>...]");
             return 1;
         }
 
         initializePluginsAndExtensions();
 
+        // An odd number of arguments means the format was specified
         int index = 0;
-        const QString *filter = commandLine.filesToOpen().length() > 2 ? &commandLine.filesToOpen().at(index++) : nullptr;
-        const QString &sourceFile = commandLine.filesToOpen().at(index++);
-        const QString &targetFile = commandLine.filesToOpen().at(index++);
+        const QString *filter = exportArguments.length() % 2 ? &exportArguments.at(index++) : nullptr;
 
-        QString errorMsg;
-        MapFormat *outputFormat = findExportFormat<MapFormat>(filter, targetFile, errorMsg);
-        if (!outputFormat) {
-            Q_ASSERT(!errorMsg.isEmpty());
-            qWarning().noquote() << errorMsg;
+        QVector<BatchMapExporter::Job> jobs;
+
+        for (; index + 1 < exportArguments.length(); index += 2) {
+            BatchMapExporter::Job job;
+            job.sourceFile = exportArguments.at(index);
+            job.targetFile = exportArguments.at(index + 1);
+
+            QString errorMsg;
+            job.format = findExportFormat<MapFormat>(filter, job.targetFile, errorMsg);
+            if (!job.format) {
+                Q_ASSERT(!errorMsg.isEmpty());
+                qWarning().noquote() << errorMsg;
+                return 1;
+            }
+
+            jobs.append(job);
+        }
+
+        BatchMapExporter exporter(commandLine.exportOptions);
+        exporter.setReportTimings(jobs.size() > 1);
+
+        return exporter.exportMaps(jobs) > 0 ? 1 : 0;
+    }
+
+    if (commandLine.exportChanged) {
+        if (commandLine.exportMap || commandLine.exportTileset || commandLine.filesToOpen().length() != 1) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Export syntax is --export-changed <project>");
             return 1;
         }
 
-        // Load the source file
-        const std::unique_ptr<Map> sourceMap(readMap(sourceFile, &errorMsg));
-        if (!sourceMap) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load source map.");
-            if (!errorMsg.isEmpty())
-                qWarning().noquote() << errorMsg;
+        const QString projectFile = QDir::cleanPath(QFileInfo(commandLine.filesToOpen().first()).absoluteFilePath());
+
+        Project project;
+        if (!project.load(projectFile)) {
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to load project '%1'.").arg(projectFile);
             return 1;
         }
 
-        // Apply export options
-        std::unique_ptr<Map> exportMap;
-        ExportHelper exportHelper(commandLine.exportOptions);
-        const Map *map = exportHelper.prepareExportMap(sourceMap.get(), exportMap);
+        Preferences::instance()->setPropertyTypes(project.propertyTypes());
 
-        // Write out the file
-        bool success = outputFormat->write(map, targetFile, exportHelper.formatOptions());
+        initializePluginsAndExtensions();
 
-        if (!success) {
-            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to export map to target file.");
-            return 1;
+        QStringList nameFilters;
+        const auto mapFormats = PluginManager::objects<MapFormat>();
+        for (MapFormat *format : mapFormats)
+            if (format->hasCapabilities(MapFormat::Read))
+                nameFilters.append(Utils::cleanFilterList(format->nameFilter()));
+        nameFilters.removeDuplicates();
+
+        // The maps are exported using the export settings stored in each map
+        QVector<BatchMapExporter::Job> jobs;
+
+        for (const QString &folder : project.folders()) {
+            QDirIterator it(folder, nameFilters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                const QString fileName = it.next();
+                if (findSupportingMapFormat(fileName)) {
+                    BatchMapExporter::Job job;
+                    job.sourceFile = fileName;
+                    jobs.append(job);
+                }
+            }
         }
-        return 0;
+
+        ExportManifest manifest(projectFile);
+
+        BatchMapExporter exporter(commandLine.exportOptions);
+        exporter.setManifest(&manifest);
+        exporter.setReportTimings(true);
+
+        const int failures = exporter.exportMaps(jobs);
+
+        qInfo().noquote() << QCoreApplication::translate("Command line", "%n map(s) up to date", "", exporter.upToDateCount());
+
+        if (!manifest.save())
+            qWarning().noquote() << QCoreApplication::translate("Command line", "Failed to save the export manifest.");
+
+        return failures > 0 ? 1 : 0;
     }
 
     if (commandLine.exportTileset) {
@@ -32,13 +32,16 @@
 #include "actionmanager.h"
 #include "addremovetileset.h"
 #include "automappingmanager.h"
+#include "batchmapexporter.h"
 #include "commandbutton.h"
 #include "commandmanager.h"
 #include "consoledock.h"
+#include "documentloader.h"
 #include "documentmanager.h"
 #include "donationpopup.h"
 #include "exportasimagedialog.h"
 #include "exporthelper.h"
+#include "exportmanifest.h"
 #include "issuescounter.h"
 #include "issuesdock.h"
 #include "languagemanager.h"
@@ -63,6 +66,7 @@
 #include "offsetmapdialog.h"
 #include "projectdock.h"
 #include "projectmanager.h"
+#include "projectmodel.h"
 #include "projectpropertiesdialog.h"
 #include "resizedialog.h"
 #include "scriptmanager.h"
@@ -90,9 +94,12 @@
 #include <QCloseEvent>
 #include <QDesktopServices>
 #include <QFileDialog>
+#include <QHBoxLayout>
 #include <QLabel>
 #include <QMessageBox>
 #include <QMimeData>
+#include <QProgressBar>
+#include <QProgressDialog>
 #include <QRegularExpression>
 #include <QShortcut>
 #include <QStandardPaths>
@@ -114,6 +121,8 @@
 #endif
 #endif // Q_OS_WIN
 
+#include <algorithm>
+
 using namespace Tiled;
 using namespace Tiled::Utils;
 
@@ -277,6 +286,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     ActionManager::registerAction(mUi->actionExport, "Export");
     ActionManager::registerAction(mUi->actionExportAs, "ExportAs");
     ActionManager::registerAction(mUi->actionExportAsImage, "ExportAsImage");
+    ActionManager::registerAction(mUi->actionExportChangedMaps, "ExportChangedMaps");
     ActionManager::registerAction(mUi->actionFitInView, "FitInView");
     ActionManager::registerAction(mUi->actionFullScreen, "FullScreen");
     ActionManager::registerAction(mUi->actionHighlightCurrentLayer, "HighlightCurrentLayer");
@@ -687,6 +697,7 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mUi->actionCloseProject, &QAction::triggered, this, &MainWindow::closeProject);
     connect(mUi->actionAddFolderToProject, &QAction::triggered, mProjectDock, &ProjectDock::addFolderToProject);
     connect(mUi->actionRefreshProjectFolders, &QAction::triggered, mProjectDock, &ProjectDock::refreshProjectFolders);
+    connect(mUi->actionExportChangedMaps, &QAction::triggered, this, &MainWindow::exportChangedMaps);
     connect(mUi->actionClearRecentProjects, &QAction::triggered, preferences, &Preferences::clearRecentProjects);
     connect(mUi->actionProjectProperties, &QAction::triggered, this, &MainWindow::projectProperties);
 
@@ -779,6 +790,21 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     myStatusBar->addWidget(consoleToggleButton);
     myStatusBar->addWidget(issuesCounter);
 
+    // Shown while documents are being loaded in the background
+    mLoadingIndicator = new QWidget(myStatusBar);
+    mLoadingProgressBar = new QProgressBar(mLoadingIndicator);
+    mLoadingProgressBar->setMaximumWidth(Utils::dpiScaled(200));
+    auto cancelLoadingButton = new QToolButton(mLoadingIndicator);
+    cancelLoadingButton->setText(tr("Cancel"));
+    cancelLoadingButton->setToolTip(tr("Cancel loading"));
+    cancelLoadingButton->setAutoRaise(true);
+    auto loadingLayout = new QHBoxLayout(mLoadingIndicator);
+    loadingLayout->setContentsMargins(0, 0, 0, 0);
+    loadingLayout->addWidget(mLoadingProgressBar);
+    loadingLayout->addWidget(cancelLoadingButton);
+    mLoadingIndicator->setVisible(false);
+    myStatusBar->addPermanentWidget(mLoadingIndicator);
+
     // Add the 'Views and Toolbars' submenu. This needs to happen after all
     // the dock widgets and toolbars have been added to the main window.
     mViewsAndToolbarsMenu = new QMenu(this);
@@ -850,6 +876,16 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     connect(mDocumentManager, &DocumentManager::currentEditorChanged,
             this, &MainWindow::currentEditorChanged);
 
+    DocumentLoader *documentLoader = mDocumentManager->documentLoader();
+    connect(documentLoader, &DocumentLoader::documentLoaded,
+            this, &MainWindow::documentLoaded);
+    connect(documentLoader, &DocumentLoader::finished,
+            this, &MainWindow::documentLoadingFinished);
+    connect(documentLoader, &DocumentLoader::progressChanged,
+            this, &MainWindow::updateLoadingIndicator);
+    connect(cancelLoadingButton, &QToolButton::clicked,
+            this, &MainWindow::cancelLoading);
+
     connect(mResetToDefaultLayout, &QAction::triggered, this, &MainWindow::resetToDefaultLayout);
     connect(mLockLayout, &QAction::toggled, this, &MainWindow::setLayoutLocked);
 
@@ -998,13 +1034,14 @@ void MainWindow::dragEnterEvent(QDragEnterEvent *e)
 void MainWindow::dropEvent(QDropEvent *e)
 {
     const auto urls = e->mimeData()->urls();
+    QStringList fileNames;
     for (const QUrl &url : urls) {
         const QString localFile = url.toLocalFile();
-        if (localFile.isEmpty())
-            continue;
-
-        openFile(localFile);
+        if (!localFile.isEmpty())
+            fileNames.append(localFile);
     }
+
+    openFiles(fileNames);
 }
 
 void MainWindow::resizeEvent(QResizeEvent *e)
@@ -1087,7 +1124,48 @@ bool MainWindow::openFile(const QString &fileName, FileFormat *fileFormat)
 
     QString error;
     DocumentPtr document = mDocumentManager->loadDocument(fileName, fileFormat, &error);
+    return addLoadedDocument(fileName, document, error);
+}
+
+/**
+ * Opens the given files, loading them in the background. Each document is
+ * added once it and all documents requested before it have been loaded, so
+ * that the tabs appear in the given order.
+ *
+ * Project and world files, as well as files that are already open, are
+ * handled immediately by openFile().
+ */
+void MainWindow::openFiles(const QStringList &fileNames, FileFormat *fileFormat)
+{
+    DocumentLoader *documentLoader = mDocumentManager->documentLoader();
+
+    for (const QString &fileName : fileNames) {
+        if (fileName.isEmpty())
+            continue;
+
+        if (fileName.endsWith(QLatin1String(".tiled-project")) ||
+                fileName.endsWith(QLatin1String(".world")) ||
+                mDocumentManager->findDocument(fileName) != -1) {
+            openFile(fileName, fileFormat);
+            continue;
+        }
+
+        PendingFile pendingFile;
+        pendingFile.fileName = fileName;
+        mPendingFiles.append(pendingFile);
+
+        documentLoader->load(fileName, fileFormat, 0, this);
+    }
+}
 
+/**
+ * Adds a document that was loaded from the given file, or reports the
+ * \a error when the document could not be loaded.
+ */
+bool MainWindow::addLoadedDocument(const QString &fileName,
+                                   const DocumentPtr &document,
+                                   const QString &error)
+{
     if (!document) {
         // HACK: Templates can't open as documents, but we can instead show
         // them in the Template Editor.
@@ -1102,6 +1180,10 @@ bool MainWindow::openFile(const QString &fileName, FileFormat *fileFormat)
         return false;
     }
 
+    // The document may have been opened while it was loading
+    if (mDocumentManager->switchToDocument(document.data()))
+        return true;
+
     mDocumentManager->addDocument(document);
 
     if (auto mapDocument = qobject_cast<MapDocument*>(document.data())) {
@@ -1143,8 +1225,7 @@ void MainWindow::openFileDialog()
 
     lastUsedOpenFilter = selectedFilter;
 
-    for (const QString &fileName : fileNames)
-        openFile(fileName, fileFormat);
+    openFiles(fileNames, fileFormat);
 }
 
 void MainWindow::openFileInProject()
@@ -1531,12 +1612,20 @@ void MainWindow::restoreSession()
     const auto &session = Session::current();
 
     // Copy values because the session will get changed while restoring it
-    const auto openFiles = session.openFiles;
+    const auto sessionFiles = session.openFiles;
     const auto activeFile = session.activeFile;
 
-    for (const QString &file : openFiles)
-        openFile(file);
-    mDocumentManager->switchToDocument(activeFile);
+    // Drop any files still being loaded for the previous session
+    mPendingFiles.clear();
+    mPendingActiveFile.clear();
+    mDocumentManager->documentLoader()->cancel(this);
+
+    openFiles(sessionFiles);
+
+    if (mPendingFiles.isEmpty())
+        mDocumentManager->switchToDocument(activeFile);
+    else
+        mPendingActiveFile = activeFile;
 
     WorldManager::instance().loadWorlds(mLoadedWorlds);
 
@@ -1559,6 +1648,129 @@ void MainWindow::projectProperties()
     }
 }
 
+/**
+ * Exports the maps in the project that changed since they were last exported
+ * by this action or by the --export-changed command-line option. Maps without
+ * an export target are skipped.
+ *
+ * The maps are read from disk, so unsaved changes are not exported.
+ */
+void MainWindow::exportChangedMaps()
+{
+    const Project &project = ProjectManager::instance()->project();
+    if (project.fileName().isEmpty())
+        return;
+
+    QVector<BatchMapExporter::Job> jobs;
+
+    const auto &fileIndex = ProjectManager::instance()->projectModel()->fileIndex();
+    for (const ProjectModel::IndexedFile &file : fileIndex) {
+        if (findSupportingMapFormat(file.path)) {
+            BatchMapExporter::Job job;
+            job.sourceFile = file.path;
+            jobs.append(job);
+        }
+    }
+
+    ExportManifest manifest(project.fileName());
+
+    // Maps need to be read on the main thread, so the events are processed
+    // by the progress dialog while the maps are checked and exported
+    QProgressDialog progress(tr("Exporting changed maps..."), tr("Cancel"),
+                             0, jobs.size(), this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(500);
+
+    BatchMapExporter exporter(Preferences::instance()->exportOptions());
+    exporter.setManifest(&manifest);
+    exporter.setProgressCallback([&progress] (int finished, int) {
+        progress.setValue(finished);
+        return !progress.wasCanceled();
+    });
+
+    const int failures = exporter.exportMaps(jobs);
+    progress.setValue(jobs.size());
+
+    // Also remembers the maps exported before canceling
+    manifest.save();
+
+    const int exported = exporter.exportedCount();
+
+    if (failures > 0) {
+        QMessageBox::critical(this, tr("Error Exporting Maps"),
+                              tr("Failed to export %n map(s). See the console for details.",
+                                 "", failures));
+    }
+
+    statusBar()->showMessage(tr("Exported %n changed map(s)", "", exported), 3000);
+}
+
+void MainWindow::documentLoaded(const QString &fileName,
+                                const DocumentPtr &document,
+                                const QString &error)
+{
+    for (PendingFile &pendingFile : mPendingFiles) {
+        if (!pendingFile.loaded && pendingFile.fileName == fileName) {
+            pendingFile.loaded = true;
+            pendingFile.document = document;
+            pendingFile.error = error;
+        }
+    }
+
+    addLoadedPendingFiles();
+}
+
+/**
+ * Called when the document loader is idle. Any files that are still pending
+ * at this point were canceled.
+ */
+void MainWindow::documentLoadingFinished()
+{
+    mPendingFiles.erase(std::remove_if(mPendingFiles.begin(),
+                                       mPendingFiles.end(),
+                                       [] (const PendingFile &pendingFile) { return !pendingFile.loaded; }),
+                        mPendingFiles.end());
+
+    addLoadedPendingFiles();
+}
+
+/**
+ * Cancels loading of the files opened by this window. Neighboring maps
+ * loaded by the map scene are not affected.
+ */
+void MainWindow::cancelLoading()
+{
+    mDocumentManager->documentLoader()->cancel(this);
+    documentLoadingFinished();
+}
+
+/**
+ * Adds the loaded documents at the front of the pending files. Once all
+ * pending files have been handled, switches to the active file of the
+ * restored session.
+ */
+void MainWindow::addLoadedPendingFiles()
+{
+    while (!mPendingFiles.isEmpty() && mPendingFiles.first().loaded) {
+        // Take the file first, since reporting an error enters an event loop
+        const PendingFile pendingFile = mPendingFiles.takeFirst();
+        addLoadedDocument(pendingFile.fileName, pendingFile.document, pendingFile.error);
+    }
+
+    if (mPendingFiles.isEmpty() && !mPendingActiveFile.isEmpty()) {
+        mDocumentManager->switchToDocument(mPendingActiveFile);
+        mPendingActiveFile.clear();
+    }
+}
+
+void MainWindow::updateLoadingIndicator(int finished, int total)
+{
+    mLoadingProgressBar->setMaximum(total);
+    mLoadingProgressBar->setValue(finished);
+    mLoadingProgressBar->setFormat(tr("Loading %1 of %2").arg(finished + 1).arg(total));
+    mLoadingIndicator->setVisible(finished < total);
+}
+
 void MainWindow::cut()
 {
     if (auto editor = mDocumentManager->currentEditor())
@@ -2225,6 +2437,7 @@ void MainWindow::updateActions()
 
     const bool hasProject = !project.fileName().isEmpty();
     mUi->actionCloseProject->setEnabled(hasProject);
+    mUi->actionExportChangedMaps->setEnabled(hasProject && projectHasFolders);
 }
 
 void MainWindow::updateZoomable()
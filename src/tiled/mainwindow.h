@@ -33,9 +33,11 @@
 #include <QMainWindow>
 #include <QPointer>
 #include <QSessionManager>
+#include <QVector>
 
 class QComboBox;
 class QLabel;
+class QProgressBar;
 
 namespace Ui {
 class MainWindow;
@@ -93,6 +95,7 @@ public:
      * @return whether the file was successfully opened
      */
     bool openFile(const QString &fileName, FileFormat *fileFormat = nullptr);
+    void openFiles(const QStringList &fileNames, FileFormat *fileFormat = nullptr);
 
     bool addRecentProjectsActions(QMenu *menu) const;
 
@@ -134,6 +137,18 @@ private:
     bool switchProject(Project project);
     void restoreSession();
     void projectProperties();
+    void exportChangedMaps();
+
+    bool addLoadedDocument(const QString &fileName,
+                           const DocumentPtr &document,
+                           const QString &error);
+    void documentLoaded(const QString &fileName,
+                        const DocumentPtr &document,
+                        const QString &error);
+    void documentLoadingFinished();
+    void cancelLoading();
+    void addLoadedPendingFiles();
+    void updateLoadingIndicator(int finished, int total);
 
     void cut();
     void copy();
@@ -262,6 +277,23 @@ private:
     TilesetEditor *mTilesetEditor;
     QList<QWidget*> mEditorStatusBarWidgets;
 
+    /**
+     * A file requested through openFiles(), which is added once it and all
+     * files requested before it have been loaded.
+     */
+    struct PendingFile
+    {
+        QString fileName;
+        bool loaded = false;
+        DocumentPtr document;
+        QString error;
+    };
+
+    QVector<PendingFile> mPendingFiles;
+    QString mPendingActiveFile;
+    QWidget *mLoadingIndicator;
+    QProgressBar *mLoadingProgressBar;
+
     QPointer<PreferencesDialog> mPreferencesDialog;
 
     QMap<QMainWindow*, QByteArray> mMainWindowStates;
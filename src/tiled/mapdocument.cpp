@@ -166,6 +166,17 @@ MapDocumentPtr MapDocument::load(const QString &fileName,
         return MapDocumentPtr();
     }
 
+    return fromLoadedMap(std::move(map), fileName, format);
+}
+
+/**
+ * Creates a MapDocument for a \a map that was read from \a fileName using
+ * the given \a format. Used when the map was read in the background.
+ */
+MapDocumentPtr MapDocument::fromLoadedMap(std::unique_ptr<Map> map,
+                                          const QString &fileName,
+                                          MapFormat *format)
+{
     map->fileName = fileName;
 
     MapDocumentPtr document = MapDocumentPtr::create(std::move(map));
@@ -393,7 +404,7 @@ void MapDocument::autocropMap()
 
     TileLayer *tileLayer = static_cast<TileLayer*>(mCurrentLayer);
 
-    const QRect bounds = tileLayer->region().boundingRect();
+    const QRect bounds = tileLayer->tileBounds();
     if (bounds.isNull())
         return;
 
@@ -97,6 +97,9 @@ public:
     static MapDocumentPtr load(const QString &fileName,
                                MapFormat *format,
                                QString *error = nullptr);
+    static MapDocumentPtr fromLoadedMap(std::unique_ptr<Map> map,
+                                        const QString &fileName,
+                                        MapFormat *format);
 
     MapFormat *readerFormat() const;
     void setReaderFormat(MapFormat *format);
@@ -32,6 +32,7 @@
 #include "maprenderer.h"
 #include "mapscene.h"
 #include "mapview.h"
+#include "movingobjectsitem.h"
 #include "objectgroupitem.h"
 #include "objectselectionitem.h"
 #include "preferences.h"
@@ -258,6 +259,62 @@ void MapItem::setShowTileCollisionShapes(bool enabled)
             item->update();
 }
 
+/**
+ * Starts previewing a move of the given \a objects. Their items are grouped
+ * together per object layer, so that the move can be previewed by only
+ * moving these groups.
+ *
+ * The objects themselves should not be changed until the move is finished.
+ */
+void MapItem::startMovingObjects(const QList<MapObject *> &objects)
+{
+    finishMovingObjects();
+
+    for (MapObject *object : objects) {
+        MapObjectItem *item = mObjectItems.value(object);
+        if (!item)
+            continue;
+
+        MovingObjectsItem *&movingItem = mMovingObjectsItems[item->parentItem()];
+        if (!movingItem)
+            movingItem = new MovingObjectsItem(item->parentItem());
+
+        movingItem->addItem(item);
+    }
+
+    if (mObjectSelectionItem)
+        mObjectSelectionItem->startMovingObjects(objects);
+}
+
+/**
+ * Displays the moving objects at the given \a offset (in screen
+ * coordinates) from their current position.
+ */
+void MapItem::setMovingObjectsOffset(const QPointF &offset)
+{
+    for (MovingObjectsItem *movingItem : qAsConst(mMovingObjectsItems))
+        movingItem->setPos(offset);
+
+    if (mObjectSelectionItem)
+        mObjectSelectionItem->setMovingObjectsOffset(offset);
+}
+
+/**
+ * Returns the items of the moving objects to their layers, at the position of
+ * their objects.
+ */
+void MapItem::finishMovingObjects()
+{
+    for (MovingObjectsItem *movingItem : qAsConst(mMovingObjectsItems)) {
+        movingItem->releaseItems();
+        delete movingItem;
+    }
+    mMovingObjectsItems.clear();
+
+    if (mObjectSelectionItem)
+        mObjectSelectionItem->finishMovingObjects();
+}
+
 void MapItem::updateLayerPositions()
 {
     const MapScene *mapScene = static_cast<MapScene*>(scene());
@@ -764,7 +821,9 @@ void MapItem::deleteLayerItems(Layer *layer)
         break;
     }
 
-    delete mLayerItems.take(layer);
+    LayerItem *layerItem = mLayerItems.take(layer);
+    mMovingObjectsItems.remove(layerItem);     // deleted along with its parent
+    delete layerItem;
 }
 
 void MapItem::updateBoundingRect()
@@ -23,6 +23,7 @@
 #include "mapdocument.h"
 
 #include <QGraphicsObject>
+#include <QHash>
 #include <QMap>
 
 #include <memory>
@@ -42,6 +43,7 @@ class LayerChangeEvent;
 class LayerItem;
 class MapObjectItem;
 class MapScene;
+class MovingObjectsItem;
 class ObjectSelectionItem;
 class TileGridItem;
 class TileSelectionItem;
@@ -74,6 +76,10 @@ public:
     void setDisplayMode(DisplayMode displayMode);
     void setShowTileCollisionShapes(bool enabled);
 
+    void startMovingObjects(const QList<MapObject*> &objects);
+    void setMovingObjectsOffset(const QPointF &offset);
+    void finishMovingObjects();
+
     void updateLayerPositions();
 
     // QGraphicsItem
@@ -142,6 +148,7 @@ private:
     std::unique_ptr<ObjectSelectionItem> mObjectSelectionItem;
     QMap<Layer*, LayerItem*> mLayerItems;
     QMap<MapObject*, MapObjectItem*> mObjectItems;
+    QHash<QGraphicsItem*, MovingObjectsItem*> mMovingObjectsItems;
     DisplayMode mDisplayMode;
     QRectF mBoundingRect;
     bool mIsHovered = false;
@@ -0,0 +1,135 @@
+/*
+ * mappreviewcache.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mappreviewcache.h"
+
+#include "mapdocument.h"
+#include "minimaprenderer.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+namespace Tiled {
+
+// The maximum width or height of a preview, in pixels
+static constexpr int PreviewSize = 256;
+
+// The amount of memory used for keeping previews in memory, in KB
+static constexpr int MemoryCacheSize = 64 * 1024;
+
+MapPreviewCache &MapPreviewCache::instance()
+{
+    static MapPreviewCache cache;
+    return cache;
+}
+
+MapPreviewCache::MapPreviewCache()
+    : mPreviews(MemoryCacheSize)
+{
+}
+
+/**
+ * Returns the preview of the map with the given \a fileName, or a null image
+ * when no up-to-date preview is available.
+ */
+QImage MapPreviewCache::preview(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString canonicalFilePath = fileInfo.canonicalFilePath();
+    if (canonicalFilePath.isEmpty())
+        return QImage();
+
+    const QDateTime lastModified = fileInfo.lastModified();
+
+    if (Preview *preview = mPreviews.object(canonicalFilePath))
+        if (preview->lastModified >= lastModified)
+            return preview->image;
+
+    const QString previewFilePath = cacheFilePath(canonicalFilePath);
+    const QFileInfo previewFileInfo(previewFilePath);
+    if (!previewFileInfo.exists() || previewFileInfo.lastModified() < lastModified)
+        return QImage();
+
+    QImage image(previewFilePath);
+    if (image.isNull())
+        return QImage();
+
+    mPreviews.insert(canonicalFilePath,
+                     new Preview { image, previewFileInfo.lastModified() },
+                     qMax(1, static_cast<int>(image.sizeInBytes() / 1024)));
+
+    return image;
+}
+
+/**
+ * Renders a new preview for the given map. Nothing is done when the map has
+ * unsaved changes, since the preview would not match the file.
+ */
+void MapPreviewCache::updatePreview(const MapDocument *mapDocument)
+{
+    // A preview of unsaved changes would not match the file
+    if (mapDocument->isModified())
+        return;
+
+    const QString canonicalFilePath = mapDocument->canonicalFilePath();
+    if (canonicalFilePath.isEmpty())
+        return;
+
+    const MiniMapRenderer renderer(mapDocument->map());
+    QSize size = renderer.mapSize();
+    if (size.isEmpty())
+        return;
+
+    size.scale(QSize(PreviewSize, PreviewSize), Qt::KeepAspectRatio);
+    size = size.expandedTo(QSize(1, 1));
+
+    const QImage image = renderer.render(size,
+                                         MiniMapRenderer::DrawTileLayers |
+                                         MiniMapRenderer::DrawMapObjects |
+                                         MiniMapRenderer::DrawImageLayers |
+                                         MiniMapRenderer::IgnoreInvisibleLayer |
+                                         MiniMapRenderer::SmoothPixmapTransform);
+
+    // The preview matches the file as it was last modified, rather than the
+    // current time, so it is not used for later changes made to the file
+    mPreviews.insert(canonicalFilePath,
+                     new Preview { image, QFileInfo(canonicalFilePath).lastModified() },
+                     qMax(1, static_cast<int>(image.sizeInBytes() / 1024)));
+
+    const QString previewFilePath = cacheFilePath(canonicalFilePath);
+    if (QDir().mkpath(QFileInfo(previewFilePath).path()))
+        image.save(previewFilePath, "PNG");
+}
+
+QString MapPreviewCache::cacheFilePath(const QString &canonicalFilePath)
+{
+    const QByteArray hash = QCryptographicHash::hash(canonicalFilePath.toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    path += QLatin1String("/map-previews/");
+    path += QString::fromLatin1(hash);
+    path += QLatin1String(".png");
+    return path;
+}
+
+} // namespace Tiled
@@ -0,0 +1,62 @@
+/*
+ * mappreviewcache.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QDateTime>
+#include <QImage>
+#include <QString>
+
+namespace Tiled {
+
+class MapDocument;
+
+/**
+ * Keeps low-resolution previews of maps, used to display the maps of a world
+ * that are not loaded.
+ *
+ * The previews are kept in memory as well as in the cache directory, so they
+ * are also available after restarting. A preview is only used while it is
+ * newer than the map file.
+ */
+class MapPreviewCache
+{
+public:
+    static MapPreviewCache &instance();
+
+    QImage preview(const QString &fileName);
+    void updatePreview(const MapDocument *mapDocument);
+
+private:
+    MapPreviewCache();
+
+    struct Preview
+    {
+        QImage image;
+        QDateTime lastModified;
+    };
+
+    static QString cacheFilePath(const QString &canonicalFilePath);
+
+    QCache<QString, Preview> mPreviews;
+};
+
+} // namespace Tiled
@@ -27,29 +27,38 @@
 #include "addremovemapobject.h"
 #include "containerhelpers.h"
 #include "debugdrawitem.h"
+#include "documentloader.h"
 #include "documentmanager.h"
 #include "map.h"
 #include "mapobject.h"
+#include "mappreviewcache.h"
 #include "maprenderer.h"
 #include "objectgroup.h"
 #include "objecttemplate.h"
 #include "preferences.h"
 #include "stylehelper.h"
 #include "templatemanager.h"
+#include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "toolmanager.h"
 #include "worldmanager.h"
 
 #include <QApplication>
 #include <QFileInfo>
+#include <QGraphicsPixmapItem>
 #include <QGraphicsSceneMouseEvent>
 #include <QKeyEvent>
 #include <QMimeData>
 #include <QPalette>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 using namespace Tiled;
 
 SessionOption<bool> MapScene::enableWorlds { "mapScene.enableWorlds", true };
+Preference<int> MapScene::worldMapMemoryLimit { "Worlds/MapMemoryLimit", 512 };
 
 MapScene::MapScene(QObject *parent)
     : QGraphicsScene(parent)
@@ -69,6 +78,13 @@ MapScene::MapScene(QObject *parent)
     WorldManager &worldManager = WorldManager::instance();
     connect(&worldManager, &WorldManager::worldsChanged, this, &MapScene::refreshScene);
 
+    connect(DocumentManager::instance()->documentLoader(), &DocumentLoader::documentLoaded,
+            this, &MapScene::documentLoaded);
+
+    mNeighborUpdateTimer.setSingleShot(true);
+    mNeighborUpdateTimer.setInterval(100);
+    connect(&mNeighborUpdateTimer, &QTimer::timeout, this, &MapScene::refreshScene);
+
     // Install an event filter so that we can get key events on behalf of the
     // active tool without having to have the current focus.
     qApp->installEventFilter(this);
@@ -186,6 +202,10 @@ void MapScene::setViewRect(const QRectF &rect)
 
     if (mParallaxEnabled)
         emit parallaxParametersChanged();
+
+    // Load and unload neighboring maps once the view settles
+    if (mMapDocument && !WorldManager::instance().worlds().isEmpty())
+        mNeighborUpdateTimer.start();
 }
 
 void MapScene::setOverrideBackgroundColor(QColor backgroundColor)
@@ -237,16 +257,61 @@ QPointF MapScene::parallaxOffset(const Layer &layer) const
                    (1.0 - parallaxFactor.y()) * viewCenter.y());
 }
 
+/**
+ * Returns the distance from \a point to the nearest point of \a rect, or 0
+ * when the point is inside the rect.
+ */
+static qreal distanceToRect(QPointF point, const QRectF &rect)
+{
+    const qreal dx = qMax(qMax(rect.left() - point.x(), point.x() - rect.right()), qreal(0));
+    const qreal dy = qMax(qMax(rect.top() - point.y(), point.y() - rect.bottom()), qreal(0));
+    return std::hypot(dx, dy);
+}
+
+/**
+ * Returns a rough estimate of the memory used by the given map, used to
+ * decide how many neighboring maps to keep loaded.
+ */
+static qint64 estimatedMemoryUsage(const Map *map)
+{
+    qint64 memoryUsage = 0;
+
+    for (const Layer *layer : map->tileLayers()) {
+        const auto tileLayer = static_cast<const TileLayer*>(layer);
+        memoryUsage += qint64(tileLayer->chunkCount()) * CHUNK_SIZE * CHUNK_SIZE * sizeof(Cell);
+    }
+
+    for (const Layer *layer : map->objectGroups())
+        memoryUsage += static_cast<const ObjectGroup*>(layer)->objectCount() * qint64(sizeof(MapObject));
+
+    return memoryUsage;
+}
+
 /**
  * Refreshes the map scene.
+ *
+ * When the map is part of a world, only the neighboring maps near the view
+ * are loaded, closest ones first. Maps near the view that are not loaded
+ * yet are displayed using their cached preview, if available. Loaded maps
+ * further away are kept only while they fit within the worldMapMemoryLimit.
+ * Other maps are not displayed.
  */
 void MapScene::refreshScene()
 {
+    // Released once map items have been created for the loaded documents
+    QVector<DocumentPtr> loadedDocuments;
+    loadedDocuments.swap(mLoadedDocuments);
+
     QHash<MapDocument*, MapItem*> mapItems;
+    QHash<QString, QGraphicsPixmapItem*> previewItems;
+
+    mWorldRect = QRectF();
 
     if (!mMapDocument) {
         mMapItems.swap(mapItems);
         qDeleteAll(mapItems);
+        mPreviewItems.swap(previewItems);
+        qDeleteAll(previewItems);
         updateSceneRect();
         return;
     }
@@ -258,26 +323,100 @@ void MapScene::refreshScene()
         const QPoint currentMapPosition = world->mapRect(currentMapFile).topLeft();
         auto const contextMaps = world->contextMaps(currentMapFile);
 
-        for (const World::MapEntry &mapEntry : contextMaps) {
+        // Neighboring maps are loaded when they are within half a view of
+        // the visible area
+        const QRectF viewRect = mViewRect.translated(currentMapPosition);
+        const QRectF loadRect = viewRect.adjusted(-viewRect.width() / 2, -viewRect.height() / 2,
+                                                  viewRect.width() / 2, viewRect.height() / 2);
+
+        struct LoadedNeighbor
+        {
+            const World::MapEntry *mapEntry;
             MapDocumentPtr mapDocument;
+            qreal distance;
+            bool nearView;
+        };
+        QVector<LoadedNeighbor> loadedNeighbors;
+        QVector<const World::MapEntry*> previewedNeighbors;
+
+        DocumentManager *documentManager = DocumentManager::instance();
+        DocumentLoader *documentLoader = documentManager->documentLoader();
+
+        for (const World::MapEntry &mapEntry : contextMaps) {
+            mWorldRect |= QRectF(mapEntry.rect.translated(-currentMapPosition));
 
             if (mapEntry.fileName == currentMapFile) {
-                mapDocument = mMapDocument->sharedFromThis();
-            } else {
-                auto doc = DocumentManager::instance()->loadDocument(mapEntry.fileName);
-                mapDocument = doc.objectCast<MapDocument>();
+                auto mapItem = takeOrCreateMapItem(mMapDocument->sharedFromThis(), MapItem::Editable);
+                mapItem->setPos(mapEntry.rect.topLeft() - currentMapPosition);
+                mapItem->setVisible(true);
+                mapItems.insert(mMapDocument, mapItem);
+                continue;
             }
 
-            if (mapDocument) {
-                MapItem::DisplayMode displayMode = MapItem::ReadOnly;
-                if (mapDocument == mMapDocument)
-                    displayMode = MapItem::Editable;
+            const qreal distance = distanceToRect(viewRect.center(), mapEntry.rect);
+            const bool nearView = loadRect.intersects(mapEntry.rect);
 
-                auto mapItem = takeOrCreateMapItem(mapDocument, displayMode);
-                mapItem->setPos(mapEntry.rect.topLeft() - currentMapPosition);
-                mapItem->setVisible(mWorldsEnabled || mapDocument == mMapDocument);
-                mapItems.insert(mapDocument.data(), mapItem);
+            auto doc = documentManager->findLoadedDocument(mapEntry.fileName);
+            if (auto mapDocument = doc.objectCast<MapDocument>()) {
+                loadedNeighbors.append({ &mapEntry, mapDocument, distance, nearView });
+                continue;
             }
+
+            if (!nearView)
+                continue;
+
+            // Load in the background, closest maps first (see documentLoaded)
+            if (mWorldsEnabled) {
+                const int priority = -static_cast<int>(qMin(distance, qreal(std::numeric_limits<int>::max())));
+                documentLoader->load(mapEntry.fileName, nullptr, priority, this);
+            }
+
+            previewedNeighbors.append(&mapEntry);
+        }
+
+        std::sort(loadedNeighbors.begin(), loadedNeighbors.end(),
+                  [] (const LoadedNeighbor &a, const LoadedNeighbor &b) { return a.distance < b.distance; });
+
+        const qint64 memoryLimit = qint64(worldMapMemoryLimit) * 1024 * 1024;
+        qint64 memoryUsage = 0;
+
+        for (const LoadedNeighbor &neighbor : qAsConst(loadedNeighbors)) {
+            // Maps open elsewhere stay loaded regardless of this scene
+            const bool openAsTab = documentManager->findDocument(neighbor.mapDocument.data()) != -1;
+            if (!openAsTab)
+                memoryUsage += estimatedMemoryUsage(neighbor.mapDocument->map());
+
+            // Evict the map. It is away from the view, so it needs no preview.
+            if (!neighbor.nearView && !openAsTab && memoryUsage > memoryLimit)
+                continue;
+
+            auto mapItem = takeOrCreateMapItem(neighbor.mapDocument, MapItem::ReadOnly);
+            mapItem->setPos(neighbor.mapEntry->rect.topLeft() - currentMapPosition);
+            mapItem->setVisible(mWorldsEnabled);
+            mapItems.insert(neighbor.mapDocument.data(), mapItem);
+        }
+
+        MapPreviewCache &previewCache = MapPreviewCache::instance();
+
+        for (const World::MapEntry *mapEntry : qAsConst(previewedNeighbors)) {
+            QGraphicsPixmapItem *previewItem = mPreviewItems.take(mapEntry->fileName);
+
+            if (!previewItem) {
+                const QImage preview = previewCache.preview(mapEntry->fileName);
+                if (preview.isNull())
+                    continue;
+
+                previewItem = new QGraphicsPixmapItem(QPixmap::fromImage(preview));
+                previewItem->setTransformationMode(Qt::SmoothTransformation);
+                previewItem->setTransform(QTransform::fromScale(qreal(mapEntry->rect.width()) / preview.width(),
+                                                                qreal(mapEntry->rect.height()) / preview.height()));
+                previewItem->setZValue(-1);
+                addItem(previewItem);
+            }
+
+            previewItem->setPos(mapEntry->rect.topLeft() - currentMapPosition);
+            previewItem->setVisible(mWorldsEnabled);
+            previewItems.insert(mapEntry->fileName, previewItem);
         }
     } else {
         auto mapItem = takeOrCreateMapItem(mMapDocument->sharedFromThis(), MapItem::Editable);
@@ -287,12 +426,41 @@ void MapScene::refreshScene()
     mMapItems.swap(mapItems);
     qDeleteAll(mapItems);       // delete all map items that didn't get reused
 
+    mPreviewItems.swap(previewItems);
+    qDeleteAll(previewItems);   // delete previews of maps loaded or out of view
+
     updateBackgroundColor();
     updateSceneRect();
 
     emit sceneRefreshed();
 }
 
+/**
+ * Refreshes the scene when a neighboring map in the current world has been
+ * loaded in the background.
+ */
+void MapScene::documentLoaded(const QString &, const DocumentPtr &document)
+{
+    if (!mMapDocument || !document || document->type() != Document::MapDocumentType)
+        return;
+
+    const World *world = WorldManager::instance().worldForMap(mMapDocument->canonicalFilePath());
+    if (!world || !world->containsMap(document->canonicalFilePath()))
+        return;
+
+    auto mapDocument = static_cast<MapDocument*>(document.data());
+    MapPreviewCache &previewCache = MapPreviewCache::instance();
+    if (previewCache.preview(mapDocument->fileName()).isNull())
+        previewCache.updatePreview(mapDocument);
+
+    // The document is kept alive until the scene is refreshed, which creates
+    // a map item for it. The refresh is shared by maps loaded in quick
+    // succession.
+    mLoadedDocuments.append(document);
+    if (!mNeighborUpdateTimer.isActive())
+        mNeighborUpdateTimer.start();
+}
+
 void MapScene::updateDefaultBackgroundColor()
 {
     const QColor darkColor = QGuiApplication::palette().dark().color();
@@ -322,7 +490,8 @@ void MapScene::updateBackgroundColor()
 
 void MapScene::updateSceneRect()
 {
-    QRectF sceneRect;
+    // Include the maps of the world that are not loaded
+    QRectF sceneRect = mWorldRect;
 
     for (MapItem *mapItem : qAsConst(mMapItems))
         sceneRect |= mapItem->boundingRect().translated(mapItem->pos());
@@ -339,6 +508,12 @@ void MapScene::setWorldsEnabled(bool enabled)
 
     for (MapItem *mapItem : qAsConst(mMapItems))
         mapItem->setVisible(mWorldsEnabled || mapItem->mapDocument() == mMapDocument);
+    for (QGraphicsPixmapItem *previewItem : qAsConst(mPreviewItems))
+        previewItem->setVisible(mWorldsEnabled);
+
+    // Load the neighboring maps that were skipped while worlds were disabled
+    if (mWorldsEnabled)
+        refreshScene();
 }
 
 MapItem *MapScene::takeOrCreateMapItem(const MapDocumentPtr &mapDocument, MapItem::DisplayMode displayMode)
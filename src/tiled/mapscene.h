@@ -30,9 +30,15 @@
 #include <QColor>
 #include <QGraphicsScene>
 #include <QHash>
+#include <QTimer>
+#include <QVector>
+
+class QGraphicsPixmapItem;
 
 namespace Tiled {
 
+template<typename T> class Preference;
+
 class Layer;
 class MapObject;
 class ObjectGroup;
@@ -84,6 +90,12 @@ public:
 
     static SessionOption<bool> enableWorlds;
 
+    /**
+     * The amount of memory in MB that may be used by loaded neighboring maps
+     * outside of the view, before they are unloaded.
+     */
+    static Preference<int> worldMapMemoryLimit;
+
 signals:
     void mapDocumentChanged(MapDocument *mapDocument);
 
@@ -107,6 +119,7 @@ protected:
 
 private:
     void refreshScene();
+    void documentLoaded(const QString &fileName, const DocumentPtr &document);
 
     void changeEvent(const ChangeEvent &change);
     void mapChanged();
@@ -127,6 +140,10 @@ private:
 
     MapDocument *mMapDocument = nullptr;
     QHash<MapDocument*, MapItem*> mMapItems;
+    QHash<QString, QGraphicsPixmapItem*> mPreviewItems;
+    QRectF mWorldRect;
+    QVector<DocumentPtr> mLoadedDocuments;
+    QTimer mNeighborUpdateTimer;
     AbstractTool *mSelectedTool = nullptr;
     DebugDrawItem *mDebugDrawItem = nullptr;
     bool mUnderMouse = false;
@@ -0,0 +1,66 @@
+/*
+ * movingobjectsitem.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "movingobjectsitem.h"
+
+#include <limits>
+
+using namespace Tiled;
+
+MovingObjectsItem::MovingObjectsItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+{
+    setFlag(QGraphicsItem::ItemHasNoContents);
+
+    // Display the moving objects on top of their siblings
+    setZValue(std::numeric_limits<qreal>::max());
+}
+
+/**
+ * Moves the given \a item into this group. The item needs to be a sibling of
+ * this group, so that it keeps its position while this group is not moved.
+ */
+void MovingObjectsItem::addItem(QGraphicsItem *item)
+{
+    Q_ASSERT(item->parentItem() == parentItem());
+    item->setParentItem(this);
+}
+
+/**
+ * Returns all items in this group to the parent of this group. Their
+ * positions are not adjusted for the offset of this group.
+ */
+void MovingObjectsItem::releaseItems()
+{
+    const auto items = childItems();
+    for (QGraphicsItem *item : items)
+        item->setParentItem(parentItem());
+}
+
+QRectF MovingObjectsItem::boundingRect() const
+{
+    return QRectF();
+}
+
+void MovingObjectsItem::paint(QPainter *,
+                              const QStyleOptionGraphicsItem *,
+                              QWidget *)
+{
+}
@@ -0,0 +1,47 @@
+/*
+ * movingobjectsitem.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QGraphicsItem>
+
+namespace Tiled {
+
+/**
+ * A graphics item that temporarily groups together the items of the objects
+ * that are being moved. While dragging, only this item is moved, rather than
+ * changing the objects and updating each of their items.
+ */
+class MovingObjectsItem : public QGraphicsItem
+{
+public:
+    explicit MovingObjectsItem(QGraphicsItem *parent);
+
+    void addItem(QGraphicsItem *item);
+    void releaseItems();
+
+    // QGraphicsItem
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter,
+               const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+};
+
+} // namespace Tiled
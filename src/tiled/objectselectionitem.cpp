@@ -28,6 +28,7 @@
 #include "mapobjectitem.h"
 #include "maprenderer.h"
 #include "mapscene.h"
+#include "movingobjectsitem.h"
 #include "objectgroup.h"
 #include "objectreferenceitem.h"
 #include "preferences.h"
@@ -314,6 +315,48 @@ ObjectSelectionItem::~ObjectSelectionItem()
 {
 }
 
+/**
+ * Groups together the overlay items of the given \a objects, so that they
+ * can be moved along with the objects while previewing a move. References
+ * are only updated once the move is finished.
+ */
+void ObjectSelectionItem::startMovingObjects(const QList<MapObject *> &objects)
+{
+    finishMovingObjects();
+
+    mMovingObjectsItem = new MovingObjectsItem(this);
+
+    for (MapObject *object : objects) {
+        if (MapObjectOutline *outlineItem = mObjectOutlines.value(object))
+            mMovingObjectsItem->addItem(outlineItem);
+
+        if (MapObjectOutline *outlineItem = mObjectHoverItems.value(object))
+            mMovingObjectsItem->addItem(outlineItem);
+
+        if (MapObjectLabel *labelItem = mObjectLabels.value(object))
+            mMovingObjectsItem->addItem(labelItem);
+
+        if (mHoveredMapObjectItem && mHoveredMapObjectItem->mapObject() == object)
+            mMovingObjectsItem->addItem(mHoveredMapObjectItem.get());
+    }
+}
+
+void ObjectSelectionItem::setMovingObjectsOffset(const QPointF &offset)
+{
+    if (mMovingObjectsItem)
+        mMovingObjectsItem->setPos(offset);
+}
+
+void ObjectSelectionItem::finishMovingObjects()
+{
+    if (!mMovingObjectsItem)
+        return;
+
+    mMovingObjectsItem->releaseItems();
+    delete mMovingObjectsItem;
+    mMovingObjectsItem = nullptr;
+}
+
 void ObjectSelectionItem::updateItemPositions()
 {
     // A bit of a heavy function, should be called when something changes that
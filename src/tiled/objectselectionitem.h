@@ -39,6 +39,7 @@ class Tileset;
 class MapDocument;
 class MapObjectItem;
 class MapObjectOutline;
+class MovingObjectsItem;
 class ObjectReferenceItem;
 
 class MapObjectLabel : public QGraphicsItem
@@ -79,6 +80,10 @@ public:
 
     void updateItemPositions();
 
+    void startMovingObjects(const QList<MapObject*> &objects);
+    void setMovingObjectsOffset(const QPointF &offset);
+    void finishMovingObjects();
+
     const MapRenderer &mapRenderer() const;
 
     // QGraphicsItem interface
@@ -122,6 +127,7 @@ private:
     QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesBySourceObject;
     QHash<MapObject*, QList<ObjectReferenceItem*>> mReferencesByTargetObject;
     std::unique_ptr<MapObjectItem> mHoveredMapObjectItem;
+    MovingObjectsItem *mMovingObjectsItem = nullptr;
 };
 
 } // namespace Tiled
@@ -21,23 +21,20 @@
 #include "objectselectiontool.h"
 
 #include "changeevents.h"
-#include "changepolygon.h"
 #include "editpolygontool.h"
 #include "geometry.h"
 #include "layer.h"
 #include "map.h"
 #include "mapdocument.h"
+#include "mapitem.h"
 #include "mapobject.h"
 #include "mapobjectitem.h"
 #include "mapobjectmodel.h"
 #include "maprenderer.h"
 #include "mapscene.h"
-#include "movemapobject.h"
 #include "objectgroup.h"
 #include "preferences.h"
 #include "raiselowerhelper.h"
-#include "resizemapobject.h"
-#include "rotatemapobject.h"
 #include "selectionrectangle.h"
 #include "snaphelper.h"
 #include "tile.h"
@@ -457,16 +454,18 @@ void ObjectSelectionTool::keyPressed(QKeyEvent *event)
             moveBy /= Preferences::instance()->gridFine();
     }
 
-    QUndoStack *undoStack = mapDocument()->undoStack();
-    undoStack->beginMacro(tr("Move %n Object(s)", "", objects.size()));
-    int i = 0;
+    QVector<TransformState> oldStates;
+    oldStates.reserve(objects.size());
+
     for (MapObject *object : objects) {
-        const QPointF oldPos = object->position();
-        const QPointF newPos = oldPos + moveBy;
-        undoStack->push(new MoveMapObject(mapDocument(), object, newPos, oldPos));
-        ++i;
+        oldStates.append(TransformState(object));
+        object->setPosition(object->position() + moveBy);
     }
-    undoStack->endMacro();
+
+    mapDocument()->undoStack()->push(new TransformMapObjects(mapDocument(),
+                                                             objects,
+                                                             oldStates,
+                                                             MapObject::PositionProperty));
 }
 
 void ObjectSelectionTool::mouseEntered()
@@ -1218,34 +1217,36 @@ void ObjectSelectionTool::startMoving(const QPointF &pos,
 
     mStart = pos;
     mAction = Moving;
-    mAlignPosition = mMovingObjects.first().oldPosition;
+    mAlignPosition = mMovingObjects.first().oldState.position;
     mOriginPos = mOriginIndicator->pos();
 
     for (const MovingObject &object : qAsConst(mMovingObjects)) {
-        const QPointF &pos = object.oldPosition;
+        const QPointF &pos = object.oldState.position;
         if (pos.x() < mAlignPosition.x())
             mAlignPosition.setX(pos.x());
         if (pos.y() < mAlignPosition.y())
             mAlignPosition.setY(pos.y());
     }
 
+    // The move is previewed by moving the items of the objects as a group,
+    // since changing each object on every mouse move is too slow for large
+    // selections. The objects are only changed once the move is finished.
+    mMovingOffset = QPointF();
+    mMovingMapItem = mapScene()->mapItem(mapDocument());
+    if (mMovingMapItem)
+        mMovingMapItem->startMovingObjects(changingObjects());
+
     updateHandleVisibility();
 }
 
 void ObjectSelectionTool::updateMovingItems(const QPointF &pos,
                                             Qt::KeyboardModifiers modifiers)
 {
-    const MapRenderer *renderer = mapDocument()->renderer();
     const QPointF diff = snapToGrid(pos - mStart, modifiers);
 
-    for (const MovingObject &object : qAsConst(mMovingObjects)) {
-        const QPointF newPixelPos = object.oldScreenPosition + diff;
-        const QPointF newPos = renderer->screenToPixelCoords(newPixelPos);
-
-        object.mapObject->setPosition(newPos);
-    }
-
-    emit mapDocument()->changed(MapObjectsChangeEvent(changingObjects(), MapObject::PositionProperty));
+    mMovingOffset = diff;
+    if (mMovingMapItem)
+        mMovingMapItem->setMovingObjectsOffset(diff);
 
     mOriginIndicator->setPos(mOriginPos + diff);
 }
@@ -1254,21 +1255,30 @@ void ObjectSelectionTool::finishMoving(const QPointF &pos)
 {
     Q_ASSERT(mAction == Moving);
     mAction = NoAction;
-    updateHandles();
+    finishMovingPreview();
 
-    if (mStart == pos) // Move is a no-op
-        return;
+    if (mStart != pos) { // Move is not a no-op
+        const MapRenderer *renderer = mapDocument()->renderer();
 
-    QUndoStack *undoStack = mapDocument()->undoStack();
-    undoStack->beginMacro(tr("Move %n Object(s)", "", mMovingObjects.size()));
-    for (const MovingObject &object : qAsConst(mMovingObjects)) {
-        undoStack->push(new MoveMapObject(mapDocument(),
-                                          object.mapObject,
-                                          object.oldPosition));
+        for (const MovingObject &object : qAsConst(mMovingObjects)) {
+            const QPointF newPixelPos = object.oldScreenPosition + mMovingOffset;
+            object.mapObject->setPosition(renderer->screenToPixelCoords(newPixelPos));
+        }
+
+        pushTransformCommand(MapObject::PositionProperty);
     }
-    undoStack->endMacro();
 
-    mMovingObjects.clear();
+    updateHandles();
+}
+
+/**
+ * Returns the items of the moved objects to their layers.
+ */
+void ObjectSelectionTool::finishMovingPreview()
+{
+    if (mMovingMapItem)
+        mMovingMapItem->finishMovingObjects();
+    mMovingMapItem.clear();
 }
 
 void ObjectSelectionTool::startMovingOrigin(const QPointF &pos)
@@ -1337,7 +1347,7 @@ void ObjectSelectionTool::updateRotatingItems(const QPointF &pos,
         const QPointF newPixelPos = mOriginPos + newRelPos - offset;
         const QPointF newPos = renderer->screenToPixelCoords(newPixelPos);
 
-        const qreal newRotation = normalizeRotation(object.oldRotation + angleDiff * 180 / M_PI);
+        const qreal newRotation = normalizeRotation(object.oldState.rotation + angleDiff * 180 / M_PI);
 
         mapObject->setPosition(newPos);
         if (mapObject->canRotate())
@@ -1359,18 +1369,10 @@ void ObjectSelectionTool::finishRotating(const QPointF &pos)
     if (mStart == pos) // No rotation at all
         return;
 
-    QUndoStack *undoStack = mapDocument()->undoStack();
-    undoStack->beginMacro(tr("Rotate %n Object(s)", "", mMovingObjects.size()));
-
-    for (const MovingObject &object : qAsConst(mMovingObjects)) {
-        MapObject *mapObject = object.mapObject;
-        undoStack->push(new MoveMapObject(mapDocument(), mapObject, object.oldPosition));
-        undoStack->push(new RotateMapObject(mapDocument(), mapObject, object.oldRotation));
-    }
-
-    undoStack->endMacro();
-
-    mMovingObjects.clear();
+    pushTransformCommand(MapObject::ChangedProperties {
+                             MapObject::PositionProperty,
+                             MapObject::RotationProperty,
+                         });
 }
 
 
@@ -1447,7 +1449,7 @@ void ObjectSelectionTool::updateResizingItems(const QPointF &pos,
                                    oldRelPos.y() * scale);
         const QPointF newScreenPos = resizingOrigin + scaledRelPos - offset;
         const QPointF newPos = renderer->screenToPixelCoords(newScreenPos);
-        const QSizeF origSize = object.oldSize;
+        const QSizeF origSize = object.oldState.size;
         const QSizeF newSize(origSize.width() * scale,
                              origSize.height() * scale);
 
@@ -1457,7 +1459,7 @@ void ObjectSelectionTool::updateResizingItems(const QPointF &pos,
             const qreal sn = std::sin(rotation);
             const qreal cs = std::cos(rotation);
 
-            const QPolygonF &oldPolygon = object.oldPolygon;
+            const QPolygonF &oldPolygon = object.oldState.polygon;
             QPolygonF newPolygon(oldPolygon.size());
             for (int n = 0; n < oldPolygon.size(); ++n) {
                 const QPointF oldPoint(oldPolygon[n]);
@@ -1499,8 +1501,8 @@ void ObjectSelectionTool::updateResizingSingleItem(const QPointF &resizingOrigin
     /* These transformations undo and redo the object rotation, which is always
      * applied in screen space.
      */
-    const QTransform unrotate = rotateAt(object.oldScreenPosition, -object.oldRotation);
-    const QTransform rotate = rotateAt(object.oldScreenPosition, object.oldRotation);
+    const QTransform unrotate = rotateAt(object.oldScreenPosition, -object.oldState.rotation);
+    const QTransform rotate = rotateAt(object.oldScreenPosition, object.oldState.rotation);
 
     QPointF origin = (resizingOrigin - offset) * unrotate;
     QPointF pos = (screenPos - offset) * unrotate;
@@ -1518,11 +1520,11 @@ void ObjectSelectionTool::updateResizingSingleItem(const QPointF &resizingOrigin
         origin = renderer->screenToPixelCoords(origin);
         pos = renderer->screenToPixelCoords(pos);
         start = renderer->screenToPixelCoords(start);
-        oldPos = object.oldPosition;
+        oldPos = object.oldState.position;
     }
 
     QPointF newPos = oldPos;
-    QSizeF newSize = object.oldSize;
+    QSizeF newSize = object.oldState.size;
 
     /* In case one of the anchors was used as-is, the desired size can be
      * derived directly from the distance from the origin for rectangle
@@ -1599,10 +1601,10 @@ void ObjectSelectionTool::updateResizingSingleItem(const QPointF &resizingOrigin
         newSize.rwidth() *= scalingFactor.width();
         newSize.rheight() *= scalingFactor.height();
 
-        if (!object.oldPolygon.isEmpty()) {
-            QPolygonF newPolygon(object.oldPolygon.size());
-            for (int n = 0; n < object.oldPolygon.size(); ++n) {
-                const QPointF &point = object.oldPolygon[n];
+        if (!object.oldState.polygon.isEmpty()) {
+            QPolygonF newPolygon(object.oldState.polygon.size());
+            for (int n = 0; n < object.oldState.polygon.size(); ++n) {
+                const QPointF &point = object.oldState.polygon[n];
                 newPolygon[n] = QPointF(point.x() * scalingFactor.width(),
                                         point.y() * scalingFactor.height());
             }
@@ -1634,20 +1636,33 @@ void ObjectSelectionTool::finishResizing(const QPointF &pos)
     if (mStart == pos) // No scaling at all
         return;
 
-    QUndoStack *undoStack = mapDocument()->undoStack();
-    undoStack->beginMacro(tr("Resize %n Object(s)", "", mMovingObjects.size()));
+    pushTransformCommand(MapObject::ChangedProperties {
+                             MapObject::PositionProperty,
+                             MapObject::SizeProperty,
+                             MapObject::ShapeProperty,
+                         });
+}
 
-    for (const MovingObject &object : qAsConst(mMovingObjects)) {
-        MapObject *mapObject = object.mapObject;
-        undoStack->push(new MoveMapObject(mapDocument(), mapObject, object.oldPosition));
-        undoStack->push(new ResizeMapObject(mapDocument(), mapObject, object.oldSize));
+/**
+ * Pushes a single command changing the given \a properties of all moving
+ * objects from their saved state to their current state.
+ */
+void ObjectSelectionTool::pushTransformCommand(MapObject::ChangedProperties properties)
+{
+    QList<MapObject*> mapObjects;
+    QVector<TransformState> oldStates;
+    mapObjects.reserve(mMovingObjects.size());
+    oldStates.reserve(mMovingObjects.size());
 
-        if (!object.oldPolygon.isEmpty())
-            undoStack->push(new ChangePolygon(mapDocument(), mapObject, object.oldPolygon));
+    for (const MovingObject &object : qAsConst(mMovingObjects)) {
+        mapObjects.append(object.mapObject);
+        oldStates.append(object.oldState);
     }
 
-    undoStack->endMacro();
-
+    mapDocument()->undoStack()->push(new TransformMapObjects(mapDocument(),
+                                                             mapObjects,
+                                                             oldStates,
+                                                             properties));
     mMovingObjects.clear();
 }
 
@@ -1670,10 +1685,7 @@ void ObjectSelectionTool::saveSelectionState()
         MovingObject object = {
             mapObject,
             renderer->pixelToScreenCoords(mapObject->position()),
-            mapObject->position(),
-            mapObject->size(),
-            mapObject->polygon(),
-            mapObject->rotation()
+            TransformState(mapObject)
         };
         mMovingObjects.append(object);
     }
@@ -1698,31 +1710,32 @@ void ObjectSelectionTool::abortCurrentAction(AbortReason reason, const QList<Map
         break;
     case Moving:
     case Rotating:
-    case Resizing:
+    case Resizing: {
+        finishMovingPreview();
+
         // Return the origin indicator to its initial position
         mOriginIndicator->setPos(mOriginPos);
 
+        const MapObject::ChangedProperties properties {
+            MapObject::PositionProperty,
+            MapObject::SizeProperty,
+            MapObject::RotationProperty,
+            MapObject::ShapeProperty,
+        };
+
         // Reset objects to their old transform
-        for (const MovingObject &object : qAsConst(mMovingObjects)) {
-            object.mapObject->setPosition(object.oldPosition);
-            object.mapObject->setSize(object.oldSize);
-            object.mapObject->setPolygon(object.oldPolygon);
-            object.mapObject->setRotation(object.oldRotation);
-        }
+        for (const MovingObject &object : qAsConst(mMovingObjects))
+            object.oldState.apply(object.mapObject, properties);
 
         // Don't emit changed for removed objects
         for (int i = mMovingObjects.size() - 1; i >= 0; --i)
             if (removedObjects.contains(mMovingObjects.at(i).mapObject))
                 mMovingObjects.remove(i);
 
-        emit mapDocument()->changed(MapObjectsChangeEvent(changingObjects(), MapObject::ChangedProperties {
-                                                              MapObject::PositionProperty,
-                                                              MapObject::SizeProperty,
-                                                              MapObject::RotationProperty,
-                                                              MapObject::ShapeProperty,
-                                                          }));
+        emit mapDocument()->changed(MapObjectsChangeEvent(changingObjects(), properties));
         break;
     }
+    }
 
     mMousePressed = false;
     mClickedObject = nullptr;
@@ -21,8 +21,10 @@
 #pragma once
 
 #include "abstractobjecttool.h"
+#include "transformmapobjects.h"
 
 #include <QList>
+#include <QPointer>
 #include <QSet>
 #include <QVector>
 
@@ -34,6 +36,7 @@ class QGraphicsItem;
 namespace Tiled {
 
 class Handle;
+class MapItem;
 class OriginIndicator;
 class ResizeHandle;
 class RotateHandle;
@@ -105,6 +108,7 @@ private:
     void updateMovingItems(const QPointF &pos,
                            Qt::KeyboardModifiers modifiers);
     void finishMoving(const QPointF &pos);
+    void finishMovingPreview();
 
     void startMovingOrigin(const QPointF &pos);
     void updateMovingOrigin(const QPointF &pos, Qt::KeyboardModifiers modifiers);
@@ -124,6 +128,7 @@ private:
     void finishResizing(const QPointF &pos);
 
     void setMode(Mode mode);
+    void pushTransformCommand(MapObject::ChangedProperties properties);
     void saveSelectionState();
 
     enum AbortReason {
@@ -162,17 +167,15 @@ private:
     {
         MapObject *mapObject;
         QPointF oldScreenPosition;
-
-        QPointF oldPosition;
-        QSizeF oldSize;
-        QPolygonF oldPolygon;
-        qreal oldRotation;
+        TransformState oldState;
     };
 
     QVector<MovingObject> mMovingObjects;
 
     QPointF mAlignPosition;
     QPointF mOriginPos;
+    QPointF mMovingOffset;
+    QPointer<MapItem> mMovingMapItem;
     bool mResizingLimitHorizontal = false;
     bool mResizingLimitVertical = false;
     Qt::ItemSelectionMode mSelectionMode;
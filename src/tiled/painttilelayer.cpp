@@ -57,8 +57,8 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
 {
     auto &data = mLayerData[target];
 
-    data.mSource.reset(source->clone());
-    data.mErased.reset(new TileLayer);
+    data.mSource = std::unique_ptr<TileLayer>(source->clone());
+    data.mErased = std::make_unique<TileLayer>();
     data.mErased->setCells(target->x(), target->y(), target, paintRegion);
     data.mX = x;
     data.mY = y;
@@ -96,8 +96,8 @@ void PaintTileLayer::redo()
 void PaintTileLayer::LayerData::mergeWith(const PaintTileLayer::LayerData &o)
 {
     if (!mSource) {
-        mSource.reset(o.mSource->clone());
-        mErased.reset(o.mErased->clone());
+        mSource = std::unique_ptr<TileLayer>(o.mSource->clone());
+        mErased = std::unique_ptr<TileLayer>(o.mErased->clone());
         mX = o.mX;
         mY = o.mY;
         mPaintedRegion = o.mPaintedRegion;
@@ -134,3 +134,24 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
 
     return true;
 }
+
+qint64 PaintTileLayer::memoryUsage() const
+{
+    qint64 usage = 0;
+    for (const std::pair<TileLayer* const, LayerData> &entry : mLayerData)
+        usage += entry.second.mSource.memoryUsage() + entry.second.mErased.memoryUsage();
+    return usage;
+}
+
+bool PaintTileLayer::compress()
+{
+    bool compressed = false;
+
+    for (std::pair<TileLayer* const, LayerData> &entry : mLayerData) {
+        LayerData &data = entry.second;
+        compressed |= data.mSource.pack(data.mPaintedRegion.translated(-data.mX, -data.mY));
+        compressed |= data.mErased.pack(data.mPaintedRegion);
+    }
+
+    return compressed;
+}
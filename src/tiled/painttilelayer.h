@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "tilelayersnapshot.h"
 #include "undocommands.h"
 
 #include <QRegion>
@@ -40,7 +41,7 @@ class MapDocument;
  * Can merge with additional commands, even when they paint on different
  * tile layers.
  */
-class PaintTileLayer : public QUndoCommand
+class PaintTileLayer : public QUndoCommand, public CompressibleUndoCommand
 {
 public:
     /**
@@ -88,13 +89,16 @@ public:
     int id() const override { return Cmd_PaintTileLayer; }
     bool mergeWith(const QUndoCommand *other) override;
 
+    qint64 memoryUsage() const override;
+    bool compress() override;
+
 private:
     struct LayerData
     {
         void mergeWith(const LayerData &o);
 
-        std::unique_ptr<TileLayer> mSource;
-        std::unique_ptr<TileLayer> mErased;
+        TileLayerSnapshot mSource;
+        TileLayerSnapshot mErased;
         int mX, mY;
         QRegion mPaintedRegion;
     };
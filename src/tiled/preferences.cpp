@@ -24,6 +24,7 @@
 #include "documentmanager.h"
 #include "languagemanager.h"
 #include "mapdocument.h"
+#include "mapreader.h"
 #include "pluginmanager.h"
 #include "savefile.h"
 #include "session.h"
@@ -90,6 +91,7 @@ void Preferences::initialize()
             this, &Preferences::objectTypesFileChangedOnDisk);
 
     SaveFile::setSafeSavingEnabled(safeSavingEnabled());
+    MapReader::setLazyChunkLoadingEnabled(lazyChunkLoadingEnabled());
 
     // Backwards compatibility check since 'FusionStyle' was removed from the
     // preferences dialog.
@@ -437,6 +439,17 @@ void Preferences::setExportOnSave(bool enabled)
     setValue(QLatin1String("Storage/ExportOnSave"), enabled);
 }
 
+bool Preferences::lazyChunkLoadingEnabled() const
+{
+    return get("Storage/LazyChunkLoading", false);
+}
+
+void Preferences::setLazyChunkLoadingEnabled(bool enabled)
+{
+    setValue(QLatin1String("Storage/LazyChunkLoading"), enabled);
+    MapReader::setLazyChunkLoadingEnabled(enabled);
+}
+
 Preferences::ExportOptions Preferences::exportOptions() const
 {
     ExportOptions options;
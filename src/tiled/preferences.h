@@ -113,6 +113,9 @@ public:
     bool exportOnSave() const;
     void setExportOnSave(bool enabled);
 
+    bool lazyChunkLoadingEnabled() const;
+    void setLazyChunkLoadingEnabled(bool enabled);
+
     enum ExportOption {
         EmbedTilesets                   = 0x1,
         DetachTemplateInstances         = 0x2,
@@ -22,6 +22,7 @@
 #include "ui_preferencesdialog.h"
 
 #include "abstractobjecttool.h"
+#include "document.h"
 #include "languagemanager.h"
 #include "mapview.h"
 #include "pluginlistmodel.h"
@@ -89,6 +90,10 @@ PreferencesDialog::PreferencesDialog(QWidget *parent)
             preferences, &Preferences::setSafeSavingEnabled);
     connect(mUi->exportOnSave, &QCheckBox::toggled,
             preferences, &Preferences::setExportOnSave);
+    connect(mUi->lazyChunkLoading, &QCheckBox::toggled,
+            preferences, &Preferences::setLazyChunkLoadingEnabled);
+    connect(mUi->undoMemoryLimit, static_cast<void(QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            this, [] (int value) { Document::ourUndoMemoryLimit = value; });
 
     connect(mUi->embedTilesets, &QCheckBox::toggled, preferences, [preferences] (bool value) {
         preferences->setExportOption(Preferences::EmbedTilesets, value);
@@ -197,6 +202,8 @@ void PreferencesDialog::fromPreferences()
     mUi->restoreSession->setChecked(prefs->restoreSessionOnStartup());
     mUi->safeSaving->setChecked(prefs->safeSavingEnabled());
     mUi->exportOnSave->setChecked(prefs->exportOnSave());
+    mUi->lazyChunkLoading->setChecked(prefs->lazyChunkLoadingEnabled());
+    mUi->undoMemoryLimit->setValue(Document::ourUndoMemoryLimit);
 
     mUi->embedTilesets->setChecked(prefs->exportOption(Preferences::EmbedTilesets));
     mUi->detachTemplateInstances->setChecked(prefs->exportOption(Preferences::DetachTemplateInstances));
@@ -22,6 +22,7 @@
 
 #include "actionmanager.h"
 #include "addremovetileset.h"
+#include "dependencyindex.h"
 #include "documentmanager.h"
 #include "mapdocumentactionhandler.h"
 #include "mapeditor.h"
@@ -36,6 +37,7 @@
 #include "utils.h"
 
 #include <QBoxLayout>
+#include <QDir>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMenu>
@@ -77,6 +79,7 @@ protected:
     void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
+    void addUsedByMenu(QMenu &menu, const QString &filePath);
     void onActivated(const QModelIndex &index);
     void onRowsInserted(const QModelIndex &parent);
 
@@ -267,6 +270,8 @@ void ProjectView::contextMenuEvent(QContextMenuEvent *event)
         if (QFileInfo { filePath }.isFile()) {
             Utils::addOpenWithSystemEditorAction(menu, filePath);
 
+            addUsedByMenu(menu, filePath);
+
             auto mapDocumentActionHandler = MapDocumentActionHandler::instance();
             auto mapDocument = mapDocumentActionHandler->mapDocument();
 
@@ -321,6 +326,36 @@ void ProjectView::contextMenuEvent(QContextMenuEvent *event)
         menu.exec(event->globalPos());
 }
 
+/**
+ * Adds a menu listing the files in the project that reference the given
+ * file. Selecting one of them selects it in the view.
+ */
+void ProjectView::addUsedByMenu(QMenu &menu, const QString &filePath)
+{
+    // Avoid creating huge menus for commonly used files
+    constexpr int maximumEntries = 50;
+
+    const auto dependencyIndex = ProjectManager::instance()->dependencyIndex();
+    const QStringList dependents = dependencyIndex->dependents(filePath);
+    const QDir dir = QFileInfo(filePath).dir();
+
+    QMenu *usedByMenu = menu.addMenu(tr("Used By"));
+    usedByMenu->setEnabled(!dependents.isEmpty());
+
+    for (int i = 0; i < dependents.size() && i < maximumEntries; ++i) {
+        const QString &dependent = dependents.at(i);
+        usedByMenu->addAction(dir.relativeFilePath(dependent), [=] {
+            selectPath(dependent);
+            scrollTo(currentIndex());
+        });
+    }
+
+    if (dependents.size() > maximumEntries) {
+        const int remaining = dependents.size() - maximumEntries;
+        usedByMenu->addAction(tr("(%n more)", nullptr, remaining))->setEnabled(false);
+    }
+}
+
 void ProjectView::onActivated(const QModelIndex &index)
 {
     const QString path = model()->filePath(index);
@@ -20,6 +20,7 @@
 
 #include "projectmanager.h"
 
+#include "dependencyindex.h"
 #include "preferences.h"
 #include "projectmodel.h"
 
@@ -30,6 +31,7 @@ ProjectManager *ProjectManager::ourInstance;
 ProjectManager::ProjectManager(QObject *parent)
     : QObject(parent)
     , mProjectModel(new ProjectModel(this))
+    , mDependencyIndex(new DependencyIndex(mProjectModel, this))
 {
     Q_ASSERT(!ourInstance);
     ourInstance = this;
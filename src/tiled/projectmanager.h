@@ -26,6 +26,7 @@
 
 namespace Tiled {
 
+class DependencyIndex;
 class ProjectModel;
 
 /**
@@ -46,12 +47,14 @@ public:
     Project &project();
 
     ProjectModel *projectModel();
+    DependencyIndex *dependencyIndex();
 
 signals:
     void projectChanged();
 
 private:
     ProjectModel *mProjectModel;
+    DependencyIndex *mDependencyIndex;
 
     static ProjectManager *ourInstance;
 };
@@ -67,4 +70,9 @@ inline ProjectModel *ProjectManager::projectModel()
     return mProjectModel;
 }
 
+inline DependencyIndex *ProjectManager::dependencyIndex()
+{
+    return mDependencyIndex;
+}
+
 } // namespace Tiled
@@ -25,29 +25,69 @@
 #include "pluginmanager.h"
 #include "utils.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
 #include <QMimeData>
+#include <QSaveFile>
 #include <QSet>
+#include <QStandardPaths>
 #include <QUrl>
 
+#include <algorithm>
+#include <iterator>
+
 namespace Tiled {
 
+/**
+ * The contents of a directory, as remembered between sessions to display
+ * the project folders before they have been scanned, and to avoid listing
+ * directories that did not change.
+ */
+struct DirectoryListing
+{
+    qint64 lastModified = 0;    // msecs since epoch
+    QStringList directories;
+    QStringList files;
+};
+
+using DirectoryCache = QHash<QString, DirectoryListing>;
+
+static QDataStream &operator<<(QDataStream &out, const DirectoryListing &listing)
+{
+    return out << listing.lastModified << listing.directories << listing.files;
+}
+
+static QDataStream &operator>>(QDataStream &in, DirectoryListing &listing)
+{
+    return in >> listing.lastModified >> listing.directories >> listing.files;
+}
+
 class FolderScanner : public QObject
 {
     Q_OBJECT
 
 public:
     void setNameFilters(const QStringList &nameFilters);
+    void setCache(const QString &fileName,
+                  const QStringList &nameFilters,
+                  const DirectoryCache &cache);
     void scanFolder(const QString &folder);
 
 signals:
     void scanFinished(FolderEntry *entry);
 
 private:
-    void scan(FolderEntry &folder, QSet<QString> &visitedFolders) const;
+    void scan(FolderEntry &folder,
+              QSet<QString> &visitedFolders,
+              DirectoryCache &listings) const;
+    void saveCache() const;
 
     QStringList mNameFilters;
+    QString mCacheFileName;
+    DirectoryCache mCache;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -78,7 +118,110 @@ static void collectDirectories(const FolderEntry &entry, QStringList &filePaths)
     }
 }
 
-static void findFiles(const FolderEntry &entry, int offset, const QStringList &words, QVector<ProjectModel::Match> &result)
+static bool sameEntries(const FolderEntry &a, const FolderEntry &b)
+{
+    if (a.filePath != b.filePath || a.entries.size() != b.entries.size())
+        return false;
+
+    for (size_t i = 0; i < a.entries.size(); ++i)
+        if (!sameEntries(*a.entries[i], *b.entries[i]))
+            return false;
+
+    return true;
+}
+
+static QStringList sortedDifference(QStringList a, QStringList b)
+{
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+
+    QStringList result;
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(),
+                        std::back_inserter(result));
+    return result;
+}
+
+static QString directoryCacheFileName(const Project &project)
+{
+    if (project.fileName().isEmpty())
+        return QString();
+
+    const QByteArray hash = QCryptographicHash::hash(project.fileName().toUtf8(),
+                                                     QCryptographicHash::Sha1).toHex();
+
+    QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    path += QLatin1String("/project-folders/");
+    path += QString::fromLatin1(hash);
+    path += QLatin1String(".cache");
+    return path;
+}
+
+// The minimum age of a directory listing in msecs, for it to be reused when
+// the directory's modification time did not change
+static constexpr qint64 MinimumCachedAge = 2000;
+
+static constexpr quint32 DirectoryCacheMagic = 0x54504643;  // "TPFC"
+static constexpr quint32 DirectoryCacheVersion = 1;
+
+/**
+ * Loads the directory listings saved by FolderScanner::saveCache. Returns an
+ * empty cache when it was saved using different name filters.
+ */
+static DirectoryCache loadDirectoryCache(const QString &fileName,
+                                         const QStringList &nameFilters)
+{
+    DirectoryCache cache;
+
+    QFile file(fileName);
+    if (fileName.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return cache;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic;
+    quint32 version;
+    QStringList cachedNameFilters;
+
+    in >> magic >> version;
+    if (magic != DirectoryCacheMagic || version != DirectoryCacheVersion)
+        return cache;
+
+    in >> cachedNameFilters;
+    if (cachedNameFilters != nameFilters)
+        return cache;
+
+    in >> cache;
+    if (in.status() != QDataStream::Ok)
+        cache.clear();
+
+    return cache;
+}
+
+/**
+ * Fills the given \a folder based on the cached directory listings, without
+ * accessing the file system. Empty directories are left out, like when
+ * scanning.
+ */
+static void populateFromCache(FolderEntry &folder, const DirectoryCache &cache)
+{
+    const auto it = cache.constFind(folder.filePath);
+    if (it == cache.constEnd())
+        return;
+
+    const QDir dir(folder.filePath);
+
+    for (const QString &name : it->directories) {
+        auto entry = std::make_unique<FolderEntry>(dir.filePath(name), &folder);
+        populateFromCache(*entry, cache);
+        if (!entry->entries.empty())
+            folder.entries.push_back(std::move(entry));
+    }
+
+    for (const QString &name : it->files)
+        folder.entries.push_back(std::make_unique<FolderEntry>(dir.filePath(name), &folder));
+}
+
+static void collectFiles(const FolderEntry &entry, int offset, QVector<ProjectModel::IndexedFile> &result)
 {
     for (const auto &childEntry : entry.entries) {
         if (childEntry->entries.empty()) {
@@ -87,17 +230,13 @@ static void findFiles(const FolderEntry &entry, int offset, const QStringList &w
 #else
             const auto relativePath = childEntry->filePath.midRef(offset);
 #endif
-            const int totalScore = Utils::matchingScore(words, relativePath);
-
-            if (totalScore > 0) {
-                result.append(ProjectModel::Match {
-                                   totalScore,
-                                   offset,
-                                   childEntry->filePath
-                               });
-            }
+            result.append(ProjectModel::IndexedFile {
+                              childEntry->filePath,
+                              offset,
+                              Utils::characterMask(relativePath)
+                          });
         } else {
-            findFiles(*childEntry, offset, words, result);
+            collectFiles(*childEntry, offset, result);
         }
     }
 }
@@ -106,13 +245,13 @@ static void findFiles(const FolderEntry &entry, int offset, const QStringList &w
 
 ProjectModel::ProjectModel(QObject *parent)
     : QAbstractItemModel(parent)
+    , mScanner(new FolderScanner)
 {
-    FolderScanner *scanner = new FolderScanner;
-    scanner->moveToThread(&mScanningThread);
-    connect(&mScanningThread, &QThread::finished, scanner, &QObject::deleteLater);
-    connect(this, &ProjectModel::nameFiltersChanged, scanner, &FolderScanner::setNameFilters);
-    connect(this, &ProjectModel::scanFolder, scanner, &FolderScanner::scanFolder);
-    connect(scanner, &FolderScanner::scanFinished, this, &ProjectModel::folderScanned);
+    mScanner->moveToThread(&mScanningThread);
+    connect(&mScanningThread, &QThread::finished, mScanner, &QObject::deleteLater);
+    connect(this, &ProjectModel::nameFiltersChanged, mScanner, &FolderScanner::setNameFilters);
+    connect(this, &ProjectModel::scanFolder, mScanner, &FolderScanner::scanFolder);
+    connect(mScanner, &FolderScanner::scanFinished, this, &ProjectModel::folderScanned);
     mScanningThread.start();
 
     mFileIconProvider.setOptions(QFileIconProvider::DontUseCustomDirectoryIcons);
@@ -151,16 +290,37 @@ void ProjectModel::setProject(Project project)
     mProject = std::move(project);
     mFolders.clear();
     mFoldersPendingScan.clear();
+    mWatcher.clear();
+    mWatcher.addPaths(mProject.folders());
+
+    // Display the folders as they were last scanned, while they are being
+    // scanned again
+    const QString cacheFileName = directoryCacheFileName(mProject);
+    const DirectoryCache cache = loadDirectoryCache(cacheFileName, mNameFilters);
 
     for (const QString &folder : mProject.folders()) {
-        mFolders.push_back(std::make_unique<FolderEntry>(folder));
-        scheduleFolderScan(folder);
+        auto entry = std::make_unique<FolderEntry>(folder);
+        populateFromCache(*entry, cache);
+
+        QStringList directories;
+        collectDirectories(*entry, directories);
+        mWatcher.addPaths(directories);
+
+        mFolders.push_back(std::move(entry));
     }
 
-    mWatcher.clear();
-    mWatcher.addPaths(mProject.folders());
+    // The scanner uses the cache to skip listing directories that did not
+    // change. This needs to happen before any folder scan is requested.
+    QMetaObject::invokeMethod(mScanner, [scanner = mScanner, cacheFileName, nameFilters = mNameFilters, cache] {
+        scanner->setCache(cacheFileName, nameFilters, cache);
+    }, Qt::QueuedConnection);
+
+    for (const QString &folder : mProject.folders())
+        scheduleFolderScan(folder);
 
     endResetModel();
+
+    updateFileIndex();
 }
 
 void ProjectModel::addFolder(const QString &folder)
@@ -193,6 +353,8 @@ void ProjectModel::removeFolder(int row)
     mWatcher.removePaths(watchedFilePaths);
     endRemoveRows();
 
+    updateFileIndex();
+
     emit folderRemoved(folder);
 }
 
@@ -209,14 +371,6 @@ void ProjectModel::refreshFolders()
                      index(int(mFolders.size() - 1), 0), { Qt::DisplayRole });
 }
 
-QVector<ProjectModel::Match> ProjectModel::findFiles(const QStringList &words) const
-{
-    QVector<Match> result;
-    for (const auto &entry : mFolders)
-        Tiled::findFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, words, result);
-    return result;
-}
-
 QString ProjectModel::filePath(const QModelIndex &index) const
 {
     if (!index.isValid())
@@ -416,20 +570,26 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
     if (it == mFolders.end())
         return;
 
-    // There appears to be no way to reset a subset of the model, so signal the
-    // removal of all previous rows and re-add the new rows instead.
-
     const std::unique_ptr<FolderEntry> &entry = *it;
     const QModelIndex index = indexForEntry(entry.get());
 
+    // Commonly nothing changed since the folder was loaded from the cache
+    if (sameEntries(*entry, *result)) {
+        finishFolderScan(index);
+        return;
+    }
+
     QStringList previousDirectories;
     QStringList newDirectories;
     collectDirectories(*entry, previousDirectories);
     collectDirectories(*result, newDirectories);
 
-    // First add the new paths to avoid needlessly unwatching/watching paths
-    mWatcher.addPaths(newDirectories);
-    mWatcher.removePaths(previousDirectories);
+    // Only (un)watch the directories that were added or removed
+    mWatcher.addPaths(sortedDifference(newDirectories, previousDirectories));
+    mWatcher.removePaths(sortedDifference(previousDirectories, newDirectories));
+
+    // There appears to be no way to reset a subset of the model, so signal the
+    // removal of all previous rows and re-add the new rows instead.
 
     emit aboutToRefresh();
 
@@ -452,6 +612,12 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
 
     emit refreshed();
 
+    updateFileIndex();
+    finishFolderScan(index);
+}
+
+void ProjectModel::finishFolderScan(const QModelIndex &index)
+{
     if (!mFoldersPendingScan.isEmpty()) {
         mScanningFolder = mFoldersPendingScan.takeFirst();
         emit scanFolder(mScanningFolder);
@@ -462,52 +628,147 @@ void ProjectModel::folderScanned(FolderEntry *resultPointer)
     emit dataChanged(index, index, { Qt::DisplayRole });
 }
 
+void ProjectModel::updateFileIndex()
+{
+    mFileIndex.clear();
+
+    for (const auto &entry : mFolders)
+        collectFiles(*entry, entry->filePath.lastIndexOf(QLatin1Char('/')) + 1, mFileIndex);
+
+    emit fileIndexChanged();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void FolderScanner::setNameFilters(const QStringList &nameFilters)
 {
+    if (mNameFilters == nameFilters)
+        return;
+
     mNameFilters = nameFilters;
+
+    // The cached listings were made with the previous name filters
+    mCache.clear();
+}
+
+void FolderScanner::setCache(const QString &fileName,
+                             const QStringList &nameFilters,
+                             const DirectoryCache &cache)
+{
+    mCacheFileName = fileName;
+    mCache = cache;
+
+    // The listed files depend on the name filters
+    if (nameFilters != mNameFilters)
+        mCache.clear();
 }
 
 void FolderScanner::scanFolder(const QString &folder)
 {
     QSet<QString> visitedFolders;
+    DirectoryCache listings;
     auto entry = std::make_unique<FolderEntry>(folder);
-    scan(*entry, visitedFolders);
+    scan(*entry, visitedFolders, listings);
 
     emit scanFinished(entry.release());
+
+#ifndef Q_OS_WASM
+    if (QThread::currentThread()->isInterruptionRequested())
+        return;
+#endif
+
+    // Replace the listings of the scanned folder
+    const QString folderPrefix = folder + QLatin1Char('/');
+    for (auto it = mCache.begin(); it != mCache.end(); ) {
+        if (it.key() == folder || it.key().startsWith(folderPrefix))
+            it = mCache.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = listings.cbegin(); it != listings.cend(); ++it)
+        mCache.insert(it.key(), it.value());
+
+    saveCache();
 }
 
-void FolderScanner::scan(FolderEntry &folder, QSet<QString> &visitedFolders) const
+/**
+ * Scans the given \a folder recursively. Directories that were not modified
+ * since they were cached are not listed again. The listings of all scanned
+ * directories are stored in \a listings.
+ */
+void FolderScanner::scan(FolderEntry &folder,
+                         QSet<QString> &visitedFolders,
+                         DirectoryCache &listings) const
 {
 #ifndef Q_OS_WASM
     if (QThread::currentThread()->isInterruptionRequested())
         return;
 #endif
 
-    constexpr QDir::SortFlags sortFlags { QDir::Name | QDir::LocaleAware | QDir::DirsFirst };
-    constexpr QDir::Filters filters { QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot };
-    const auto list = QDir(folder.filePath).entryInfoList(mNameFilters, filters, sortFlags);
+    const QDir dir(folder.filePath);
+    const qint64 lastModified = QFileInfo(folder.filePath).lastModified().toMSecsSinceEpoch();
 
-    for (const auto &fileInfo : list) {
-        auto entry = std::make_unique<FolderEntry>(fileInfo.filePath(), &folder);
+    DirectoryListing listing;
 
-        if (fileInfo.isDir()) {
-            const QString canonicalPath = fileInfo.canonicalFilePath();
+    const auto cached = mCache.constFind(folder.filePath);
+    if (cached != mCache.constEnd() && cached->lastModified == lastModified) {
+        listing = cached.value();
+    } else {
+        constexpr QDir::SortFlags sortFlags { QDir::Name | QDir::LocaleAware | QDir::DirsFirst };
+        constexpr QDir::Filters filters { QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot };
+        const auto list = dir.entryInfoList(mNameFilters, filters, sortFlags);
+
+        // A directory modified just now may still change without its
+        // modification time changing, so it is not trusted next time
+        const qint64 age = QDateTime::currentMSecsSinceEpoch() - lastModified;
+        listing.lastModified = age > MinimumCachedAge ? lastModified : 0;
+
+        for (const auto &fileInfo : list) {
+            if (fileInfo.isDir())
+                listing.directories.append(fileInfo.fileName());
+            else
+                listing.files.append(fileInfo.fileName());
+        }
+    }
+
+    listings.insert(folder.filePath, listing);
 
-            // prevent potential endless symlink loop
-            if (!visitedFolders.contains(canonicalPath)) {
-                visitedFolders.insert(canonicalPath);
-                scan(*entry, visitedFolders);
-            }
+    for (const QString &name : qAsConst(listing.directories)) {
+        auto entry = std::make_unique<FolderEntry>(dir.filePath(name), &folder);
+        const QString canonicalPath = QFileInfo(entry->filePath).canonicalFilePath();
 
-            // Leave out empty directories
-            if (entry->entries.empty())
-                continue;
+        // prevent potential endless symlink loop
+        if (!visitedFolders.contains(canonicalPath)) {
+            visitedFolders.insert(canonicalPath);
+            scan(*entry, visitedFolders, listings);
         }
 
-        folder.entries.push_back(std::move(entry));
+        // Leave out empty directories
+        if (!entry->entries.empty())
+            folder.entries.push_back(std::move(entry));
     }
+
+    for (const QString &name : qAsConst(listing.files))
+        folder.entries.push_back(std::make_unique<FolderEntry>(dir.filePath(name), &folder));
+}
+
+void FolderScanner::saveCache() const
+{
+    if (mCacheFileName.isEmpty())
+        return;
+    if (!QDir().mkpath(QFileInfo(mCacheFileName).path()))
+        return;
+
+    QSaveFile file(mCacheFileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << DirectoryCacheMagic << DirectoryCacheVersion << mNameFilters << mCache;
+
+    if (out.status() == QDataStream::Ok)
+        file.commit();
 }
 
 } // namespace Tiled
@@ -33,6 +33,8 @@
 
 namespace Tiled {
 
+class FolderScanner;
+
 struct FolderEntry
 {
     explicit FolderEntry(const QString &filePath, FolderEntry *parent = nullptr)
@@ -75,7 +77,24 @@ public:
 #endif
     };
 
-    QVector<Match> findFiles(const QStringList &words) const;
+    /**
+     * A file in one of the project folders, as used for searching files by
+     * name.
+     */
+    struct IndexedFile {
+        QString path;
+        int offset;             // start of the path relative to its folder
+        quint64 characterMask;  // see Utils::characterMask
+
+        // Returns a QStringRef on Qt 5, as expected by Utils::matchingScore
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        QStringRef relativePath() const { return path.midRef(offset); }
+#else
+        QStringView relativePath() const { return QStringView(path).mid(offset); }
+#endif
+    };
+
+    const QVector<IndexedFile> &fileIndex() const;
 
     QString filePath(const QModelIndex &index) const;
 
@@ -103,6 +122,8 @@ signals:
     void aboutToRefresh();
     void refreshed();
 
+    void fileIndexChanged();
+
 private:
     FolderEntry *entryForIndex(const QModelIndex &index) const;
     QModelIndex indexForEntry(FolderEntry *entry) const;
@@ -113,6 +134,8 @@ private:
 
     void scheduleFolderScan(const QString &folder);
     void folderScanned(FolderEntry *entry);
+    void finishFolderScan(const QModelIndex &index);
+    void updateFileIndex();
 
     Project mProject;
     QFileIconProvider mFileIconProvider;
@@ -120,7 +143,9 @@ private:
     QTimer mUpdateNameFiltersTimer;
 
     std::vector<std::unique_ptr<FolderEntry>> mFolders;
+    QVector<IndexedFile> mFileIndex;
 
+    FolderScanner *mScanner;
     QThread mScanningThread;
     QString mScanningFolder;
     QStringList mFoldersPendingScan;
@@ -133,4 +158,14 @@ inline Project &ProjectModel::project()
     return mProject;
 }
 
+/**
+ * Returns a flat list of all files in the project folders. The index is
+ * updated whenever a folder has been scanned, after which the
+ * fileIndexChanged() signal is emitted.
+ */
+inline const QVector<ProjectModel::IndexedFile> &ProjectModel::fileIndex() const
+{
+    return mFileIndex;
+}
+
 } // namespace Tiled
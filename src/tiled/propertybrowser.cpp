@@ -196,6 +196,9 @@ void PropertyBrowser::setDocument(Document *document)
     mTilesetDocument = tilesetDocument;
     mCustomPropertiesHelper.setMapDocument(mapDocument);
 
+    mAggregatedProperties.clear();
+    mAggregatedObjects.clear();
+
     if (mapDocument) {
         connect(mapDocument, &MapDocument::mapChanged,
                 this, &PropertyBrowser::mapChanged);
@@ -394,13 +397,18 @@ void PropertyBrowser::wangSetChanged(WangSet *wangSet)
         updateProperties();
 }
 
-static bool anyObjectHasProperty(const QList<Object*> &objects, const QString &name)
+/**
+ * Returns the ID of the custom property type of the given value, or 0 when it
+ * isn't using a custom type.
+ */
+static int customPropertyTypeId(const QVariant &value)
 {
-    for (Object *obj : objects) {
-        if (obj->hasProperty(name))
-            return true;
+    if (value.userType() == propertyValueId()) {
+        const PropertyValue propertyValue = value.value<PropertyValue>();
+        if (propertyValue.type())
+            return propertyValue.typeId;
     }
-    return false;
+    return 0;
 }
 
 static bool propertyValueAffected(Object *currentObject,
@@ -420,7 +428,8 @@ static bool propertyValueAffected(Object *currentObject,
     return false;
 }
 
-static bool objectPropertiesRelevant(Document *document, Object *object)
+static bool objectPropertiesRelevant(Document *document, Object *object,
+                                     const QHash<Object*, Properties> &selectedObjects)
 {
     auto currentObject = document->currentObject();
     if (!currentObject)
@@ -433,7 +442,7 @@ static bool objectPropertiesRelevant(Document *document, Object *object)
         if (static_cast<MapObject*>(currentObject)->cell().tile() == object)
             return true;
 
-    if (document->currentObjects().contains(object))
+    if (selectedObjects.contains(object))
         return true;
 
     return false;
@@ -441,8 +450,10 @@ static bool objectPropertiesRelevant(Document *document, Object *object)
 
 void PropertyBrowser::propertyAdded(Object *object, const QString &name)
 {
-    if (!objectPropertiesRelevant(mDocument, object))
+    if (!objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
         return;
+
+    updateAggregatedProperties(object);
     if (QtVariantProperty *property = mCustomPropertiesHelper.property(name)) {
         if (propertyValueAffected(mObject, object, name))
             setCustomPropertyValue(property, object->property(name));
@@ -458,13 +469,14 @@ void PropertyBrowser::propertyRemoved(Object *object, const QString &name)
     auto property = mCustomPropertiesHelper.property(name);
     if (!property)
         return;
-    if (!objectPropertiesRelevant(mDocument, object))
+    if (!objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
         return;
 
+    updateAggregatedProperties(object);
+
     const QVariant resolvedValue = mObject->resolvedProperty(name);
 
-    if (!resolvedValue.isValid() &&
-            !anyObjectHasProperty(mDocument->currentObjects(), name)) {
+    if (!resolvedValue.isValid() && !mAggregatedProperties.contains(name)) {
         // It's not a predefined property and no selected object has this
         // property, so delete it.
 
@@ -503,13 +515,15 @@ void PropertyBrowser::propertyChanged(Object *object, const QString &name)
     if (propertyValueAffected(mObject, object, name))
         setCustomPropertyValue(property, object->property(name));
 
-    if (mDocument->currentObjects().contains(object))
+    if (mAggregatedObjects.contains(object)) {
+        updateAggregatedProperties(object);
         updateCustomPropertyColor(name);
+    }
 }
 
 void PropertyBrowser::propertiesChanged(Object *object)
 {
-    if (objectPropertiesRelevant(mDocument, object))
+    if (objectPropertiesRelevant(mDocument, object, mAggregatedObjects))
         updateCustomProperties();
 }
 
@@ -993,7 +1007,7 @@ void PropertyBrowser::applyMapValue(PropertyId id, const QVariant &val)
             LayerIterator iterator(mMapDocument->map());
             while (Layer *layer = iterator.next()) {
                 if (TileLayer *tileLayer = dynamic_cast<TileLayer*>(layer))
-                    mapBounds = mapBounds.united(tileLayer->region().boundingRect());
+                    mapBounds = mapBounds.united(tileLayer->tileBounds());
             }
 
             if (mapBounds.size() == QSize(0, 0))
@@ -1841,22 +1855,13 @@ void PropertyBrowser::updateCustomProperties()
 
     UpdatingProperties updatingProperties(this, mUpdating);
 
-    mCustomPropertiesHelper.clear();
+    updateAggregatedProperties();
 
     mCombinedProperties = mObject->properties();
     // Add properties from selected objects which mObject does not contain to mCombinedProperties.
-    const auto currentObjects = mDocument->currentObjects();
-    for (Object *obj : currentObjects) {
-        if (obj == mObject)
-            continue;
-
-        QMapIterator<QString,QVariant> it(obj->properties());
-
-        while (it.hasNext()) {
-            it.next();
-            if (!mCombinedProperties.contains(it.key()))
-                mCombinedProperties.insert(it.key(), QString());
-        }
+    for (auto it = mAggregatedProperties.constBegin(); it != mAggregatedProperties.constEnd(); ++it) {
+        if (!mCombinedProperties.contains(it.key()))
+            mCombinedProperties.insert(it.key(), QString());
     }
 
     QString objectType;
@@ -1916,22 +1921,126 @@ void PropertyBrowser::updateCustomProperties()
         }
     }
 
+    // Remove the properties that are no longer present
+    const QList<QtProperty *> properties = mCustomPropertiesGroup->subProperties();
+    for (QtProperty *property : properties)
+        if (!mCombinedProperties.contains(property->propertyName()))
+            mCustomPropertiesHelper.deleteProperty(property);
+
+    // Update the remaining properties in place, and add the new ones
     QMapIterator<QString,QVariant> it(mCombinedProperties);
 
     while (it.hasNext()) {
         it.next();
 
-        QtVariantProperty *property = createCustomProperty(it.key(), it.value());
-        mCustomPropertiesGroup->addSubProperty(property);
-
-        // Collapse custom color properties, to save space
-        if (property->valueType() == QMetaType::QColor)
-            setExpanded(items(property).constFirst(), false);
+        QtVariantProperty *property = mCustomPropertiesHelper.property(it.key());
+        if (!property)
+            addCustomProperty(it.key(), it.value());
+        else if (mCustomPropertiesHelper.propertyTypeId(property) != customPropertyTypeId(it.value()))
+            recreateProperty(property, it.value());
+        else
+            setCustomPropertyValue(property, it.value());
 
         updateCustomPropertyColor(it.key());
     }
 }
 
+/**
+ * Brings the aggregated custom properties up to date with the currently
+ * selected objects.
+ *
+ * Only the objects that were added to or removed from the selection, or of
+ * which the properties changed, are aggregated again. Removed objects are
+ * taken out based on the properties remembered for them, since they may
+ * have been deleted.
+ */
+void PropertyBrowser::updateAggregatedProperties()
+{
+    const auto &currentObjects = mDocument->currentObjects();
+
+    // Starting over is cheaper when most objects were deselected
+    if (currentObjects.size() < mAggregatedObjects.size() / 2) {
+        mAggregatedProperties.clear();
+        mAggregatedObjects.clear();
+    }
+
+    QHash<Object*, Properties> previousObjects;
+    previousObjects.swap(mAggregatedObjects);
+    mAggregatedObjects.reserve(currentObjects.size());
+
+    QStringList undetermined;
+
+    for (Object *object : currentObjects) {
+        if (mAggregatedObjects.contains(object))
+            continue;
+
+        const Properties &properties = object->properties();
+
+        auto it = previousObjects.find(object);
+        if (it != previousObjects.end()) {
+            // Usually the properties are still shared, making this cheap
+            if (it.value() == properties) {
+                mAggregatedObjects.insert(object, it.value());
+                previousObjects.erase(it);
+                continue;
+            }
+
+            undetermined.append(deaggregateProperties(mAggregatedProperties, it.value()));
+            previousObjects.erase(it);
+        }
+
+        aggregateProperties(mAggregatedProperties, properties);
+        mAggregatedObjects.insert(object, properties);
+    }
+
+    // Take out the objects that are no longer selected
+    for (const Properties &properties : qAsConst(previousObjects))
+        undetermined.append(deaggregateProperties(mAggregatedProperties, properties));
+
+    reaggregateProperties(undetermined);
+}
+
+/**
+ * Brings the aggregated custom properties up to date with the properties of
+ * the given \a object, in case it is selected.
+ */
+void PropertyBrowser::updateAggregatedProperties(Object *object)
+{
+    auto it = mAggregatedObjects.find(object);
+    if (it == mAggregatedObjects.end() || it.value() == object->properties())
+        return;
+
+    const QStringList undetermined = deaggregateProperties(mAggregatedProperties, it.value());
+    aggregateProperties(mAggregatedProperties, object->properties());
+    it.value() = object->properties();
+
+    reaggregateProperties(undetermined);
+}
+
+/**
+ * Aggregates the properties with the given \a names again from scratch.
+ */
+void PropertyBrowser::reaggregateProperties(QStringList names)
+{
+    names.removeDuplicates();
+
+    for (const QString &name : qAsConst(names)) {
+        mAggregatedProperties.remove(name);
+
+        for (const Properties &properties : qAsConst(mAggregatedObjects)) {
+            const auto it = properties.constFind(name);
+            if (it == properties.constEnd())
+                continue;
+
+            auto pit = mAggregatedProperties.find(name);
+            if (pit != mAggregatedProperties.end())
+                pit.value().aggregate(it.value());
+            else
+                mAggregatedProperties.insert(name, AggregatedPropertyData(it.value()));
+        }
+    }
+}
+
 // If there are other objects selected check if their properties are equal. If not give them a gray color.
 void PropertyBrowser::updateCustomPropertyColor(const QString &name)
 {
@@ -1941,32 +2050,24 @@ void PropertyBrowser::updateCustomPropertyColor(const QString &name)
     if (!property->isEnabled())
         return;
 
-    QString propertyName = property->propertyName();
-    QString propertyValue = property->valueText();
-
-    const auto &objects = mDocument->currentObjects();
-
     QColor textColor = palette().color(QPalette::Active, QPalette::WindowText);
     QColor disabledTextColor = palette().color(QPalette::Disabled, QPalette::WindowText);
 
+    const auto it = mAggregatedProperties.constFind(name);
+    const int presenceCount = it != mAggregatedProperties.constEnd() ? it->presenceCount() : 0;
+
     // If one of the objects doesn't have this property then gray out the name and value.
-    for (Object *obj : objects) {
-        if (!obj->hasProperty(propertyName)) {
-            property->setNameColor(disabledTextColor);
-            property->setValueColor(disabledTextColor);
-            return;
-        }
+    if (presenceCount < mAggregatedObjects.size()) {
+        property->setNameColor(disabledTextColor);
+        property->setValueColor(disabledTextColor);
+        return;
     }
 
     // If one of the objects doesn't have the same property value then gray out the value.
-    for (Object *obj : objects) {
-        if (obj == mObject)
-            continue;
-        if (obj->property(propertyName) != propertyValue) {
-            property->setNameColor(textColor);
-            property->setValueColor(disabledTextColor);
-            return;
-        }
+    if (presenceCount > 0 && !it->valueConsistent()) {
+        property->setNameColor(textColor);
+        property->setValueColor(disabledTextColor);
+        return;
     }
 
     property->setNameColor(textColor);
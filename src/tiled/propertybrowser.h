@@ -202,6 +202,9 @@ private:
     void updateProperties();
     void updateCustomProperties();
     void updateCustomPropertyColor(const QString &name);
+    void updateAggregatedProperties();
+    void updateAggregatedProperties(Object *object);
+    void reaggregateProperties(QStringList names);
 
     QVariant toDisplayValue(QVariant value) const;
     QVariant fromDisplayValue(QtProperty *property, QVariant value) const;
@@ -225,6 +228,11 @@ private:
 
     Properties mCombinedProperties;
 
+    // The custom properties of the selected objects, and the properties of
+    // each selected object at the time they were aggregated
+    AggregatedProperties mAggregatedProperties;
+    QHash<Object*, Properties> mAggregatedObjects;
+
     QStringList mStaggerAxisNames;
     QStringList mStaggerIndexNames;
     QStringList mOrientationNames;
@@ -22,11 +22,13 @@
 
 #include "actionmanager.h"
 #include "commandmanager.h"
+#include "dependencyindex.h"
 #include "editabletileset.h"
 #include "issuesmodel.h"
 #include "logginginterface.h"
 #include "mainwindow.h"
 #include "mapeditor.h"
+#include "projectmanager.h"
 #include "scriptedaction.h"
 #include "scriptedfileformat.h"
 #include "scriptedtool.h"
@@ -319,6 +321,16 @@ EditableAsset *ScriptModule::reload(EditableAsset *asset) const
     return nullptr;
 }
 
+QStringList ScriptModule::fileDependencies(const QString &fileName) const
+{
+    return ProjectManager::instance()->dependencyIndex()->dependencies(fileName);
+}
+
+QStringList ScriptModule::fileDependents(const QString &fileName) const
+{
+    return ProjectManager::instance()->dependencyIndex()->dependents(fileName);
+}
+
 ScriptedAction *ScriptModule::registerAction(const QByteArray &idName, QJSValue callback)
 {
     if (idName.isEmpty()) {
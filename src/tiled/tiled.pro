@@ -73,6 +73,7 @@ SOURCES += aboutdialog.cpp \
     automapperwrapper.cpp \
     automappingmanager.cpp \
     automappingutils.cpp  \
+    batchmapexporter.cpp \
     brokenlinks.cpp \
     brushitem.cpp \
     bucketfilltool.cpp \
@@ -120,7 +121,9 @@ SOURCES += aboutdialog.cpp \
     createtileobjecttool.cpp \
     custompropertieshelper.cpp \
     debugdrawitem.cpp \
+    dependencyindex.cpp \
     document.cpp \
+    documentloader.cpp \
     documentmanager.cpp \
     donationpopup.cpp \
     editableasset.cpp \
@@ -143,8 +146,10 @@ SOURCES += aboutdialog.cpp \
     erasetiles.cpp \
     exportasimagedialog.cpp \
     exporthelper.cpp \
+    exportmanifest.cpp \
     filechangedwarning.cpp \
     fileedit.cpp \
+    filesearch.cpp \
     filteredit.cpp \
     flexiblescrollbar.cpp \
     flipmapobjects.cpp \
@@ -170,6 +175,7 @@ SOURCES += aboutdialog.cpp \
     mapitem.cpp \
     mapobjectitem.cpp \
     mapobjectmodel.cpp \
+    mappreviewcache.cpp \
     mapscene.cpp \
     mapview.cpp \
     minimap.cpp \
@@ -177,6 +183,7 @@ SOURCES += aboutdialog.cpp \
     movelayer.cpp \
     movemapobject.cpp \
     movemapobjecttogroup.cpp \
+    movingobjectsitem.cpp \
     newmapdialog.cpp \
     newsbutton.cpp \
     newsfeed.cpp \
@@ -256,6 +263,7 @@ SOURCES += aboutdialog.cpp \
     tiledproxystyle.cpp \
     tilelayeredit.cpp \
     tilelayeritem.cpp \
+    tilelayersnapshot.cpp \
     tilepainter.cpp \
     tileselectionitem.cpp \
     tileselectiontool.cpp \
@@ -272,8 +280,10 @@ SOURCES += aboutdialog.cpp \
     tilestampmanager.cpp \
     tilestampmodel.cpp \
     tilestampsdock.cpp \
+    tilethumbnailcache.cpp \
     tmxmapformat.cpp \
     toolmanager.cpp \
+    transformmapobjects.cpp \
     treeviewcombobox.cpp \
     undocommands.cpp \
     undodock.cpp \
@@ -313,6 +323,7 @@ HEADERS += aboutdialog.h \
     automapperwrapper.h \
     automappingmanager.h \
     automappingutils.h \
+    batchmapexporter.h \
     brokenlinks.h \
     brushitem.h \
     bucketfilltool.h \
@@ -360,7 +371,9 @@ HEADERS += aboutdialog.h \
     createtileobjecttool.h \
     custompropertieshelper.h \
     debugdrawitem.h \
+    dependencyindex.h \
     document.h \
+    documentloader.h \
     documentmanager.h \
     donationpopup.h \
     editableasset.h \
@@ -383,8 +396,10 @@ HEADERS += aboutdialog.h \
     erasetiles.h \
     exportasimagedialog.h \
     exporthelper.h \
+    exportmanifest.h \
     filechangedwarning.h \
     fileedit.h \
+    filesearch.h \
     filteredit.h \
     flexiblescrollbar.h \
     flipmapobjects.h \
@@ -410,6 +425,7 @@ HEADERS += aboutdialog.h \
     mapitem.h \
     mapobjectitem.h \
     mapobjectmodel.h \
+    mappreviewcache.h \
     mapscene.h \
     mapview.h \
     minimapdock.h \
@@ -417,6 +433,7 @@ HEADERS += aboutdialog.h \
     movelayer.h \
     movemapobject.h \
     movemapobjecttogroup.h \
+    movingobjectsitem.h \
     newmapdialog.h \
     newsbutton.h \
     newsfeed.h \
@@ -499,6 +516,7 @@ HEADERS += aboutdialog.h \
     tiledproxystyle.h \
     tilelayeredit.h \
     tilelayeritem.h \
+    tilelayersnapshot.h \
     tilepainter.h \
     tileselectionitem.h \
     tileselectiontool.h \
@@ -515,8 +533,10 @@ HEADERS += aboutdialog.h \
     tilestampmanager.h \
     tilestampmodel.h \
     tilestampsdock.h \
+    tilethumbnailcache.h \
     tmxmapformat.h \
     toolmanager.h \
+    transformmapobjects.h \
     treeviewcombobox.h \
     undocommands.h \
     undodock.h \
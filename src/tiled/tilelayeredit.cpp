@@ -24,9 +24,12 @@
 #include "editablemap.h"
 #include "editabletile.h"
 #include "editabletilelayer.h"
+#include "gidmapper.h"
 #include "painttilelayer.h"
 #include "scriptmanager.h"
 
+#include <QCoreApplication>
+
 namespace Tiled {
 
 TileLayerEdit::TileLayerEdit(EditableTileLayer *tileLayer, QObject *parent)
@@ -58,6 +61,51 @@ void TileLayerEdit::setTile(int x, int y, EditableTile *tile, int flags)
     mChanges.setCell(x, y, cell);
 }
 
+/**
+ * Sets the cells in the given rectangle from a buffer of global tile IDs in
+ * row-major order, as returned by EditableTileLayer::gids(). A GID of 0
+ * erases the cell.
+ */
+void TileLayerEdit::setGids(int x, int y, int width, int height, const QByteArray &gids)
+{
+    const qint64 cellCount = qint64(qMax(width, 0)) * qMax(height, 0);
+    if (width < 0 || height < 0 || gids.size() != cellCount * qint64(sizeof(quint32))) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Buffer size does not match the given size"));
+        return;
+    }
+
+    const Map *map = mTargetLayer->tileLayer()->map();
+    if (!map) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Layer is not part of a map"));
+        return;
+    }
+
+    // The whole buffer is validated before any cell is changed
+    const GidMapper gidMapper(map->tilesets());
+    QVector<Cell> cells;
+    if (gidMapper.decodeGids(cells, gids, static_cast<int>(cellCount)) != GidMapper::NoError) {
+        ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid global tile ID: %1").arg(gidMapper.invalidTile()));
+        return;
+    }
+
+    for (int i = 0; i < cells.size(); ++i) {
+        const Cell &cell = cells.at(i);
+        if (!cell.isEmpty() && !cell.tile()) {
+            const quint32 gid = reinterpret_cast<const quint32*>(gids.constData())[i];
+            ScriptManager::instance().throwError(QCoreApplication::translate("Script Errors", "Invalid global tile ID: %1").arg(gid));
+            return;
+        }
+    }
+
+    auto cell = cells.begin();
+    for (int cellY = y; cellY < y + height; ++cellY) {
+        for (int cellX = x; cellX < x + width; ++cellX, ++cell) {
+            cell->setChecked(true);  // Used to find painted region later (allows erasing)
+            mChanges.setCell(cellX, cellY, *cell);
+        }
+    }
+}
+
 void TileLayerEdit::apply()
 {
     // Applying an edit automatically makes it mergeable, so that further
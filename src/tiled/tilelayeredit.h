@@ -54,6 +54,7 @@ public:
 
 public slots:
     void setTile(int x, int y, EditableTile *tile, int flags = 0);
+    void setGids(int x, int y, int width, int height, const QByteArray &gids);
     void apply();
 
 private:
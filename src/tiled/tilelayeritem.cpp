@@ -76,4 +76,7 @@ void TileLayerItem::paint(QPainter *painter,
     renderer->setPainterScale(scale);
     // TODO: Display a border around the layer when selected
     renderer->drawTileLayer(painter, tileLayer(), option->exposedRect);
+
+    // Release chunks of lazily loaded layers that haven't been drawn recently
+    tileLayer()->unloadColdChunks();
 }
@@ -0,0 +1,248 @@
+/*
+ * tilelayersnapshot.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilelayersnapshot.h"
+
+#include "compression.h"
+#include "logginginterface.h"
+#include "tilelayer.h"
+
+#include <QCoreApplication>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+
+namespace {
+
+#ifdef TILED_ZSTD_SUPPORT
+constexpr CompressionMethod PackCompression = Zstandard;
+#else
+constexpr CompressionMethod PackCompression = Zlib;
+#endif
+
+enum PackedFlags : quint8 {
+    PackedFlippedHorizontally   = 0x01,
+    PackedFlippedVertically     = 0x02,
+    PackedFlippedAntiDiagonally = 0x04,
+    PackedRotatedHexagonal120   = 0x08,
+    PackedChecked               = 0x10,
+};
+
+quint8 packFlags(const Cell &cell)
+{
+    quint8 flags = 0;
+    if (cell.flippedHorizontally())
+        flags |= PackedFlippedHorizontally;
+    if (cell.flippedVertically())
+        flags |= PackedFlippedVertically;
+    if (cell.flippedAntiDiagonally())
+        flags |= PackedFlippedAntiDiagonally;
+    if (cell.rotatedHexagonal120())
+        flags |= PackedRotatedHexagonal120;
+    if (cell.checked())
+        flags |= PackedChecked;
+    return flags;
+}
+
+void unpackFlags(Cell &cell, quint8 flags)
+{
+    cell.setFlippedHorizontally(flags & PackedFlippedHorizontally);
+    cell.setFlippedVertically(flags & PackedFlippedVertically);
+    cell.setFlippedAntiDiagonally(flags & PackedFlippedAntiDiagonally);
+    cell.setRotatedHexagonal120(flags & PackedRotatedHexagonal120);
+    cell.setChecked(flags & PackedChecked);
+}
+
+template<typename Function>
+void forEachCell(const QRegion &region, Function function)
+{
+    for (const QRect &rect : region)
+        for (int y = rect.top(); y <= rect.bottom(); ++y)
+            for (int x = rect.left(); x <= rect.right(); ++x)
+                function(x, y);
+}
+
+} // anonymous namespace
+
+
+TileLayerSnapshot::TileLayerSnapshot() = default;
+
+TileLayerSnapshot::TileLayerSnapshot(std::unique_ptr<TileLayer> layer)
+    : mLayer(std::move(layer))
+{
+}
+
+TileLayerSnapshot::TileLayerSnapshot(TileLayerSnapshot &&other) = default;
+
+TileLayerSnapshot::~TileLayerSnapshot() = default;
+
+TileLayerSnapshot &TileLayerSnapshot::operator=(TileLayerSnapshot &&other) = default;
+
+TileLayerSnapshot &TileLayerSnapshot::operator=(std::unique_ptr<TileLayer> layer)
+{
+    mLayer = std::move(layer);
+    mPacked.clear();
+    mPackedRegion = QRegion();
+    mTilesets.clear();
+    return *this;
+}
+
+/**
+ * Returns the layer, unpacking it first when necessary.
+ */
+TileLayer *TileLayerSnapshot::get() const
+{
+    if (isPacked())
+        unpack();
+    return mLayer.get();
+}
+
+/**
+ * Packs the cells within the given \a region, in local coordinates of the
+ * layer. Any cells outside of this region are dropped.
+ *
+ * The cells are stored as separate arrays of tileset indexes, tile IDs and
+ * flags, which compress well since neighboring cells tend to be similar.
+ *
+ * Returns whether the snapshot was packed.
+ */
+bool TileLayerSnapshot::pack(const QRegion &region)
+{
+    if (!mLayer || isPacked())
+        return false;
+
+    int cellCount = 0;
+    for (const QRect &rect : region)
+        cellCount += rect.width() * rect.height();
+
+    QVector<SharedTileset> tilesets;
+    QVector<quint32> tilesetIndexes;
+    QVector<qint32> tileIds;
+    QVector<quint8> flags;
+    tilesetIndexes.reserve(cellCount);
+    tileIds.reserve(cellCount);
+    flags.reserve(cellCount);
+
+    Tileset *lastTileset = nullptr;
+    quint32 lastIndex = 0;
+
+    forEachCell(region, [&] (int x, int y) {
+        const Cell &cell = mLayer->cellAt(x, y);
+
+        // Index 0 is used for cells without tileset
+        if (cell.tileset() != lastTileset) {
+            lastTileset = cell.tileset();
+            lastIndex = 0;
+            if (lastTileset) {
+                const SharedTileset tileset = lastTileset->sharedFromThis();
+                int index = tilesets.indexOf(tileset);
+                if (index == -1) {
+                    index = tilesets.size();
+                    tilesets.append(tileset);
+                }
+                lastIndex = static_cast<quint32>(index + 1);
+            }
+        }
+
+        tilesetIndexes.append(qToLittleEndian(lastIndex));
+        tileIds.append(qToLittleEndian(static_cast<qint32>(cell.tileId())));
+        flags.append(packFlags(cell));
+    });
+
+    QByteArray data;
+    data.reserve(cellCount * int(sizeof(quint32) + sizeof(qint32) + sizeof(quint8)));
+    data.append(reinterpret_cast<const char*>(tilesetIndexes.constData()), cellCount * int(sizeof(quint32)));
+    data.append(reinterpret_cast<const char*>(tileIds.constData()), cellCount * int(sizeof(qint32)));
+    data.append(reinterpret_cast<const char*>(flags.constData()), cellCount * int(sizeof(quint8)));
+
+    // The layer is only dropped when it can be restored from the packed data
+    QByteArray packed = compress(data, PackCompression);
+    if (packed.isNull() || decompress(packed, data.size(), PackCompression) != data)
+        return false;
+
+    mPacked = std::move(packed);
+    mPackedRegion = region;
+    mTilesets = std::move(tilesets);
+    mLayerRect = mLayer->rect();
+    mCellCount = cellCount;
+    mLayer.reset();
+    return true;
+}
+
+void TileLayerSnapshot::unpack() const
+{
+    const int dataSize = mCellCount * int(sizeof(quint32) + sizeof(qint32) + sizeof(quint8));
+    const QByteArray data = decompress(mPacked, dataSize, PackCompression);
+
+    auto layer = std::make_unique<TileLayer>(QString(),
+                                             mLayerRect.x(), mLayerRect.y(),
+                                             mLayerRect.width(), mLayerRect.height());
+
+    if (data.size() == dataSize) {
+        const char *tilesetIndexes = data.constData();
+        const char *tileIds = tilesetIndexes + mCellCount * sizeof(quint32);
+        const char *flags = tileIds + mCellCount * sizeof(qint32);
+
+        int i = 0;
+        forEachCell(mPackedRegion, [&] (int x, int y) {
+            const quint32 tilesetIndex = qFromLittleEndian<quint32>(tilesetIndexes + i * sizeof(quint32));
+            const qint32 tileId = qFromLittleEndian<qint32>(tileIds + i * sizeof(qint32));
+
+            Cell cell;
+            if (tilesetIndex > 0)
+                cell.setTile(mTilesets.at(tilesetIndex - 1).data(), tileId);
+            else
+                cell.setTile(nullptr, tileId);
+            unpackFlags(cell, static_cast<quint8>(flags[i]));
+
+            layer->setCell(x, y, cell);
+            ++i;
+        });
+    } else {
+        // Should not happen, since pack() verifies the packed data
+        ERROR(QCoreApplication::translate("Tiled::TileLayerSnapshot",
+                                          "Failed to restore tile layer data from the undo history"));
+    }
+
+    mLayer = std::move(layer);
+    mPacked.clear();
+    mPackedRegion = QRegion();
+    mTilesets.clear();
+}
+
+/**
+ * Returns the approximate amount of memory used by this snapshot, in bytes.
+ */
+qint64 TileLayerSnapshot::memoryUsage() const
+{
+    if (isPacked()) {
+        return mPacked.size() +
+                mPackedRegion.rectCount() * qint64(sizeof(QRect)) +
+                mTilesets.size() * qint64(sizeof(SharedTileset));
+    }
+
+    if (!mLayer)
+        return 0;
+
+    return qint64(sizeof(TileLayer)) +
+            qint64(mLayer->chunkCount()) * CHUNK_SIZE * CHUNK_SIZE * qint64(sizeof(Cell));
+}
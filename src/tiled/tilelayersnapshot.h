@@ -0,0 +1,78 @@
+/*
+ * tilelayersnapshot.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "tileset.h"
+
+#include <QByteArray>
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+#include <memory>
+
+namespace Tiled {
+
+class TileLayer;
+
+/**
+ * A copy of (part of) a tile layer, held on to by an undo command.
+ *
+ * To save memory while the command sits in the undo history, the snapshot
+ * can be packed. Only the cells within the region relevant to the command
+ * are kept, in compressed form. The layer is unpacked again when accessed.
+ */
+class TileLayerSnapshot
+{
+public:
+    TileLayerSnapshot();
+    TileLayerSnapshot(std::unique_ptr<TileLayer> layer);
+    TileLayerSnapshot(TileLayerSnapshot &&other);
+    ~TileLayerSnapshot();
+
+    TileLayerSnapshot &operator=(TileLayerSnapshot &&other);
+    TileLayerSnapshot &operator=(std::unique_ptr<TileLayer> layer);
+
+    explicit operator bool() const { return mLayer || isPacked(); }
+
+    TileLayer *get() const;
+    TileLayer *operator->() const { return get(); }
+    TileLayer &operator*() const { return *get(); }
+
+    bool isPacked() const { return !mPacked.isNull(); }
+    bool pack(const QRegion &region);
+
+    qint64 memoryUsage() const;
+
+private:
+    void unpack() const;
+
+    mutable std::unique_ptr<TileLayer> mLayer;
+
+    // Only used while packed
+    mutable QByteArray mPacked;
+    mutable QRegion mPackedRegion;
+    mutable QVector<SharedTileset> mTilesets;
+    QRect mLayerRect;
+    int mCellCount = 0;
+};
+
+} // namespace Tiled
@@ -24,8 +24,6 @@
 #include "mapdocument.h"
 #include "map.h"
 
-#include <QQueue>
-
 using namespace Tiled;
 
 namespace {
@@ -186,131 +184,6 @@ void TilePainter::erase(const QRegion &region)
     emit mMapDocument->regionChanged(paintable, mTileLayer);
 }
 
-static QRegion fillRegion(const TileLayer *layer,
-                          const QRegion &region,
-                          QPoint fillOrigin,
-                          Map::Orientation orientation,
-                          Map::StaggerAxis staggerAxis,
-                          Map::StaggerIndex staggerIndex)
-{
-    // Return empty region when the bounds do not contain the fill origin
-    if (!region.contains(fillOrigin))
-        return QRegion();
-
-    // Cache cell that we will match other cells against
-    const Cell matchCell = layer->cellAt(fillOrigin);
-
-    const QRect bounds = region.boundingRect();
-    const int width = bounds.width();
-    const int height = bounds.height();
-    const int indexOffset = -(bounds.left() + bounds.top() * width);
-
-    const bool isStaggered = orientation == Map::Hexagonal || orientation == Map::Staggered;
-
-    // Create a queue to hold cells that need filling
-    QQueue<QPoint> fillPositions;
-    fillPositions.enqueue(fillOrigin);
-
-    // Create an array that will store which cells have been processed
-    // This is faster than checking if a given cell is in the region/list
-    QVector<bool> processedCellsVec(width * height);
-    bool *processedCells = processedCellsVec.data();
-    QRegion fillRegion;
-
-    // Loop through queued positions and fill them, while at the same time
-    // checking adjacent positions to see if they should be added
-    while (!fillPositions.isEmpty()) {
-        const QPoint currentPoint = fillPositions.dequeue();
-        const int startOfLine = currentPoint.y() * width;
-
-        // Seek as far left as we can
-        int left = currentPoint.x();
-        while (left > bounds.left() && layer->cellAt(left - 1, currentPoint.y()) == matchCell) {
-            --left;
-            processedCells[indexOffset + startOfLine + left] = true;
-        }
-
-        // Seek as far right as we can
-        int right = currentPoint.x();
-        while (right < bounds.right() && layer->cellAt(right + 1, currentPoint.y()) == matchCell) {
-            ++right;
-            processedCells[indexOffset + startOfLine + right] = true;
-        }
-
-        // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
-
-        bool leftColumnIsStaggered = false;
-        bool rightColumnIsStaggered = false;
-
-        // For hexagonal maps with a staggered Y-axis, we may need to extend the search range
-        if (isStaggered) {
-            if (staggerAxis == Map::StaggerY) {
-                bool rowIsStaggered = ((layer->y() + currentPoint.y()) & 1) ^ staggerIndex;
-                if (rowIsStaggered)
-                    right = qMin(right + 1, bounds.right());
-                else
-                    left = qMax(left - 1, bounds.left());
-            } else {
-                leftColumnIsStaggered = ((layer->x() + left) & 1) ^ staggerIndex;
-                rightColumnIsStaggered = ((layer->x() + right) & 1) ^ staggerIndex;
-            }
-        }
-
-        // Loop between left and right and check if cells above or below need
-        // to be added to the queue.
-        auto findFillPositions = [=,&fillPositions](int left, int right, int y) {
-            bool adjacentCellAdded = false;
-
-            for (int x = left; x <= right; ++x) {
-                const int index = y * width + x;
-
-                if (!processedCells[indexOffset + index] && layer->cellAt(x, y) == matchCell) {
-                    // Do not add the cell to the queue if an adjacent cell was added.
-                    if (!adjacentCellAdded) {
-                        fillPositions.enqueue(QPoint(x, y));
-                        adjacentCellAdded = true;
-                    }
-                } else {
-                    adjacentCellAdded = false;
-                }
-
-                processedCells[indexOffset + index] = true;
-            }
-        };
-
-        if (currentPoint.y() > bounds.top()) {
-            int _left = left;
-            int _right = right;
-
-            if (isStaggered && staggerAxis == Map::StaggerX) {
-                if (!leftColumnIsStaggered)
-                    _left = qMax(left - 1, bounds.left());
-                if (!rightColumnIsStaggered)
-                    _right = qMin(right + 1, bounds.right());
-            }
-
-            findFillPositions(_left, _right, currentPoint.y() - 1);
-        }
-
-        if (currentPoint.y() < bounds.bottom()) {
-            int _left = left;
-            int _right = right;
-
-            if (isStaggered && staggerAxis == Map::StaggerX) {
-                if (leftColumnIsStaggered)
-                    _left = qMax(left - 1, bounds.left());
-                if (rightColumnIsStaggered)
-                    _right = qMin(right + 1, bounds.right());
-            }
-
-            findFillPositions(_left, _right, currentPoint.y() + 1);
-        }
-    }
-
-    return fillRegion;
-}
-
 QRegion TilePainter::computePaintableFillRegion(QPoint fillOrigin) const
 {
     const Map *map = mMapDocument->map();
@@ -323,10 +196,8 @@ QRegion TilePainter::computePaintableFillRegion(QPoint fillOrigin) const
     else
         bounds = mTileLayer->rect();
 
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
+    QRegion region = mTileLayer->computeFillRegion(bounds.translated(-mTileLayer->position()),
+                                                   fillOrigin - mTileLayer->position());
 
     region.translate(mTileLayer->position());
 
@@ -340,10 +211,8 @@ QRegion TilePainter::computeFillRegion(QPoint fillOrigin) const
 {
     const Map *map = mMapDocument->map();
     QRegion bounds = map->infinite() ? mTileLayer->bounds() : mTileLayer->rect();
-    QRegion region = fillRegion(mTileLayer,
-                                bounds.translated(-mTileLayer->position()),
-                                fillOrigin - mTileLayer->position(),
-                                map->orientation(), map->staggerAxis(), map->staggerIndex());
+    QRegion region = mTileLayer->computeFillRegion(bounds.translated(-mTileLayer->position()),
+                                                   fillOrigin - mTileLayer->position());
 
     return region.translated(mTileLayer->position());
 }
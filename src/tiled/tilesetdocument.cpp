@@ -180,6 +180,18 @@ TilesetDocumentPtr TilesetDocument::load(const QString &fileName,
         return TilesetDocumentPtr();
     }
 
+    return fromLoadedTileset(tileset, fileName, format);
+}
+
+/**
+ * Creates a TilesetDocument for a \a tileset that was read from \a fileName
+ * using the given \a format. Used when the tileset was read in the
+ * background.
+ */
+TilesetDocumentPtr TilesetDocument::fromLoadedTileset(const SharedTileset &tileset,
+                                                      const QString &fileName,
+                                                      TilesetFormat *format)
+{
     tileset->setFileName(fileName);
     tileset->setFormat(format->shortName());
 
@@ -68,6 +68,9 @@ public:
     static TilesetDocumentPtr load(const QString &fileName,
                                    TilesetFormat *format,
                                    QString *error = nullptr);
+    static TilesetDocumentPtr fromLoadedTileset(const SharedTileset &tileset,
+                                                const QString &fileName,
+                                                TilesetFormat *format);
 
     TilesetFormat *writerFormat() const override;
     void setWriterFormat(TilesetFormat *format);
@@ -30,6 +30,7 @@
 #include "tileset.h"
 #include "tilesetdocument.h"
 #include "tilesetmodel.h"
+#include "tilethumbnailcache.h"
 #include "utils.h"
 #include "wangoverlay.h"
 #include "zoomable.h"
@@ -55,6 +56,29 @@ using namespace Tiled;
 
 namespace {
 
+// Tile images with at least this many pixels are painted using thumbnails
+// when they are displayed smaller than their actual size
+static constexpr int MinimumThumbnailSourceArea = 64 * 64;
+
+/**
+ * Returns the size at which the given tile is displayed at 100% zoom. A
+ * placeholder size is returned for tiles without image.
+ */
+static QSize unscaledTileSize(const Tile *tile)
+{
+    const QPixmap &image = tile->image();
+    if (!image.isNull())
+        return image.size();
+
+    const Tileset *tileset = tile->tileset();
+    if (tileset->isCollection())
+        return QSize(32, 32);
+
+    int max = std::max(tileset->tileWidth(), tileset->tileHeight());
+    int min = std::min(max, 32);
+    return QSize(min, min);
+}
+
 static void setupTilesetGridTransform(const Tileset &tileset, QTransform &transform, QRect &targetRect)
 {
     if (tileset.orientation() == Tileset::Isometric) {
@@ -118,17 +142,7 @@ void TileDelegate::paint(QPainter *painter,
     const qreal zoom = mTilesetView->scale();
     const bool wrapping = mTilesetView->dynamicWrapping();
 
-    QSize tileSize = tileImage.size();
-    if (tileImage.isNull()) {
-        Tileset *tileset = model->tileset();
-        if (tileset->isCollection()) {
-            tileSize = QSize(32, 32);
-        } else {
-            int max = std::max(tileset->tileWidth(), tileset->tileHeight());
-            int min = std::min(max, 32);
-            tileSize = QSize(min, min);
-        }
-    }
+    QSize tileSize = unscaledTileSize(tile);
 
     // Compute rectangle to draw the image in: bottom- and left-aligned
     QRect targetRect = option.rect.adjusted(0, 0, -extra, -extra);
@@ -152,10 +166,22 @@ void TileDelegate::paint(QPainter *painter,
         if (zoomable->smoothTransform())
             painter->setRenderHint(QPainter::SmoothPixmapTransform);
 
-    if (!tileImage.isNull())
-        painter->drawPixmap(targetRect, tileImage);
-    else
+    if (!tileImage.isNull()) {
+        const QSize deviceSize = targetRect.size() * painter->device()->devicePixelRatioF();
+        QPixmap thumbnail;
+
+        // Scaling down large images while painting is slow, so thumbnails
+        // are used once they have been created
+        if (tileImage.width() * tileImage.height() >= MinimumThumbnailSourceArea &&
+                deviceSize.width() < tileImage.width() &&
+                deviceSize.height() < tileImage.height()) {
+            thumbnail = mTilesetView->thumbnail(tileImage, deviceSize);
+        }
+
+        painter->drawPixmap(targetRect, thumbnail.isNull() ? tileImage : thumbnail);
+    } else {
         mTilesetView->imageMissingIcon().paint(painter, targetRect, Qt::AlignBottom | Qt::AlignLeft);
+    }
 
 
     // Overlay with film strip when animated
@@ -190,20 +216,7 @@ QSize TileDelegate::sizeHint(const QStyleOptionViewItem & /* option */,
                          tileset->tileHeight() * scale + extra);
         }
 
-        const QPixmap &image = tile->image();
-        QSize tileSize = image.size();
-
-        if (image.isNull()) {
-            Tileset *tileset = m->tileset();
-            if (tileset->isCollection()) {
-                tileSize = QSize(32, 32);
-            } else {
-                int max = std::max(tileset->tileWidth(), tileset->tileWidth());
-                int min = std::min(max, 32);
-                tileSize = QSize(min, min);
-            }
-        }
-
+        const QSize tileSize = unscaledTileSize(tile);
         return QSize(tileSize.width() * scale + extra,
                      tileSize.height() * scale + extra);
     }
@@ -282,6 +295,7 @@ void TileDelegate::drawWangOverlay(QPainter *painter,
 TilesetView::TilesetView(QWidget *parent)
     : QTableView(parent)
     , mZoomable(new Zoomable(this))
+    , mThumbnailCache(new TileThumbnailCache(this))
     , mImageMissingIcon(QStringLiteral("://images/32/image-missing.png"))
 {
     setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
@@ -316,6 +330,9 @@ TilesetView::TilesetView(QWidget *parent)
             this, &TilesetView::updateBackgroundColor);
 
     connect(mZoomable, &Zoomable::scaleChanged, this, &TilesetView::adjustScale);
+
+    connect(mThumbnailCache, &TileThumbnailCache::thumbnailReady,
+            this, [this] { viewport()->update(); });
 }
 
 void TilesetView::setTilesetDocument(TilesetDocument *tilesetDocument)
@@ -339,34 +356,38 @@ QSize TilesetView::sizeHint() const
 
 int TilesetView::sizeHintForColumn(int column) const
 {
-    Q_UNUSED(column)
     const TilesetModel *model = tilesetModel();
     if (!model)
         return -1;
-    if (model->tileset()->isCollection())
-        return QTableView::sizeHintForColumn(column);
 
     const int gridSpace = mDrawGrid ? 1 : 0;
     if (dynamicWrapping())
         return model->tileset()->tileWidth() * scale() + gridSpace;
 
+    if (model->tileset()->isCollection()) {
+        updateTileSizes();
+        return static_cast<int>(mColumnWidths.value(column) * scale()) + gridSpace;
+    }
+
     const int tileWidth = model->tileset()->tileWidth();
     return qRound(tileWidth * scale()) + gridSpace;
 }
 
 int TilesetView::sizeHintForRow(int row) const
 {
-    Q_UNUSED(row)
     const TilesetModel *model = tilesetModel();
     if (!model)
         return -1;
-    if (model->tileset()->isCollection())
-        return QTableView::sizeHintForRow(row);
 
     const int gridSpace = mDrawGrid ? 1 : 0;
     if (dynamicWrapping())
         return model->tileset()->tileHeight() * scale() + gridSpace;
 
+    if (model->tileset()->isCollection()) {
+        updateTileSizes();
+        return static_cast<int>(mRowHeights.value(row) * scale()) + gridSpace;
+    }
+
     const int tileHeight = model->tileset()->tileHeight();
     return qRound(tileHeight * scale()) + gridSpace;
 }
@@ -405,9 +426,28 @@ bool TilesetView::dynamicWrapping() const
     return false;
 }
 
+/**
+ * Returns the given tile \a image scaled to \a size, or a null pixmap when
+ * the thumbnail is still being created.
+ */
+QPixmap TilesetView::thumbnail(const QPixmap &image, QSize size) const
+{
+    const auto mode = mZoomable->smoothTransform() ? Qt::SmoothTransformation
+                                                   : Qt::FastTransformation;
+    return mThumbnailCache->thumbnail(image, size, mode);
+}
+
 void TilesetView::setModel(QAbstractItemModel *model)
 {
     QTableView::setModel(model);
+    invalidateTileSizes();
+
+    if (model) {
+        connect(model, &QAbstractItemModel::modelReset, this, &TilesetView::invalidateTileSizes);
+        connect(model, &QAbstractItemModel::layoutChanged, this, &TilesetView::invalidateTileSizes);
+        connect(model, &QAbstractItemModel::dataChanged, this, &TilesetView::invalidateTileSizes);
+    }
+
     updateBackgroundColor();
     setVerticalScrollBarPolicy(dynamicWrapping() ? Qt::ScrollBarAlwaysOn : Qt::ScrollBarAsNeeded);
     refreshColumnCount();
@@ -880,6 +920,9 @@ void TilesetView::setDrawGrid(bool drawGrid)
 
 void TilesetView::adjustScale()
 {
+    // Thumbnails requested for the previous scale are no longer needed
+    mThumbnailCache->cancelPending();
+
     scheduleDelayedItemsLayout();
     refreshColumnCount();
 }
@@ -902,6 +945,41 @@ void TilesetView::refreshColumnCount()
     tilesetModel()->setColumnCountOverride(columnCount);
 }
 
+void TilesetView::invalidateTileSizes()
+{
+    mTileSizesDirty = true;
+}
+
+/**
+ * Determines the width of each column and the height of each row at 100%
+ * zoom, for image collections that are not dynamically wrapped. This way the
+ * layout can be adjusted to a new scale without visiting each tile again.
+ */
+void TilesetView::updateTileSizes() const
+{
+    if (!mTileSizesDirty)
+        return;
+
+    mTileSizesDirty = false;
+
+    const TilesetModel *model = tilesetModel();
+    const int rowCount = model->rowCount();
+    const int columnCount = model->columnCount();
+
+    mColumnWidths.fill(0, columnCount);
+    mRowHeights.fill(0, rowCount);
+
+    for (int row = 0; row < rowCount; ++row) {
+        for (int column = 0; column < columnCount; ++column) {
+            if (const Tile *tile = model->tileAt(model->index(row, column))) {
+                const QSize size = unscaledTileSize(tile);
+                mColumnWidths[column] = std::max(mColumnWidths[column], size.width());
+                mRowHeights[row] = std::max(mRowHeights[row], size.height());
+            }
+        }
+    }
+}
+
 void TilesetView::applyWangId()
 {
     if (!mHoveredIndex.isValid() || !mWangSet)
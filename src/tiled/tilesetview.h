@@ -24,11 +24,13 @@
 #include "wangset.h"
 
 #include <QTableView>
+#include <QVector>
 
 namespace Tiled {
 
 class ChangeEvent;
 class TilesetDocument;
+class TileThumbnailCache;
 class Zoomable;
 
 /**
@@ -62,6 +64,8 @@ public:
 
     bool drawGrid() const { return mDrawGrid; }
 
+    QPixmap thumbnail(const QPixmap &image, QSize size) const;
+
     void setDynamicWrapping(bool enabled);
     bool dynamicWrapping() const;
 
@@ -130,6 +134,9 @@ private:
     void adjustScale();
     void refreshColumnCount();
 
+    void invalidateTileSizes();
+    void updateTileSizes() const;
+
     void applyWangId();
     void finishWangIdChange();
     Tile *currentTile() const;
@@ -147,6 +154,7 @@ private:
     };
 
     Zoomable *mZoomable;
+    TileThumbnailCache *mThumbnailCache;
     TilesetDocument *mTilesetDocument = nullptr;
     bool mDrawGrid;
     bool mMarkAnimatedTiles = true;
@@ -163,6 +171,11 @@ private:
     bool mHandScrolling = false;
     QPoint mLastMousePos;
 
+    // Unscaled column widths and row heights, for image collections
+    mutable QVector<int> mColumnWidths;
+    mutable QVector<int> mRowHeights;
+    mutable bool mTileSizesDirty = true;
+
     const QIcon mImageMissingIcon;
 };
 
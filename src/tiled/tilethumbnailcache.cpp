@@ -0,0 +1,140 @@
+/*
+ * tilethumbnailcache.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilethumbnailcache.h"
+
+#include <QImage>
+#include <QRunnable>
+
+namespace Tiled {
+
+// Maximum memory used by the thumbnails, in kilobytes
+static constexpr int MaxCacheSize = 64 * 1024;
+
+bool TileThumbnailCache::Key::operator==(const Key &other) const
+{
+    return cacheKey == other.cacheKey &&
+            size == other.size &&
+            mode == other.mode;
+}
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const TileThumbnailCache::Key &key, uint seed) Q_DECL_NOTHROW
+#else
+size_t qHash(const TileThumbnailCache::Key &key, size_t seed) Q_DECL_NOTHROW
+#endif
+{
+    auto h = ::qHash(key.cacheKey, seed);
+    h = ::qHash(key.size.width(), h);
+    h = ::qHash(key.size.height(), h);
+    h = ::qHash(static_cast<int>(key.mode), h);
+    return h;
+}
+
+
+class TileThumbnailCache::ScaleRunnable : public QRunnable
+{
+public:
+    ScaleRunnable(TileThumbnailCache *cache, const Key &key, const QImage &image)
+        : mCache(cache)
+        , mKey(key)
+        , mImage(image)
+    {}
+
+    void run() override
+    {
+        const QImage scaled = mImage.scaled(mKey.size, Qt::IgnoreAspectRatio, mKey.mode);
+
+        QMetaObject::invokeMethod(mCache, [cache = mCache, key = mKey, scaled] {
+            cache->scaled(key, scaled);
+        }, Qt::QueuedConnection);
+    }
+
+private:
+    TileThumbnailCache * const mCache;
+    const Key mKey;
+    const QImage mImage;
+};
+
+
+TileThumbnailCache::TileThumbnailCache(QObject *parent)
+    : QObject(parent)
+    , mThumbnails(MaxCacheSize)
+{
+}
+
+TileThumbnailCache::~TileThumbnailCache()
+{
+    mThreadPool.clear();
+    mThreadPool.waitForDone();
+}
+
+/**
+ * Returns the given \a image scaled to \a size, when it is available.
+ *
+ * When the thumbnail was not created yet, it is requested and a null pixmap
+ * is returned. The thumbnailReady() signal is emitted once it is available.
+ */
+QPixmap TileThumbnailCache::thumbnail(const QPixmap &image,
+                                      QSize size,
+                                      Qt::TransformationMode mode)
+{
+    if (image.isNull() || size.isEmpty())
+        return QPixmap();
+
+    const Key key { image.cacheKey(), size, mode };
+
+    if (const QPixmap *thumbnail = mThumbnails.object(key))
+        return *thumbnail;
+
+    if (!mPending.contains(key)) {
+        mPending.insert(key);
+
+        // Pixmaps can't be used outside of the GUI thread
+        mThreadPool.start(new ScaleRunnable(this, key, image.toImage()));
+    }
+
+    return QPixmap();
+}
+
+/**
+ * Cancels the creation of the thumbnails that were requested but not yet
+ * started, for example because the zoom level changed.
+ */
+void TileThumbnailCache::cancelPending()
+{
+    mThreadPool.clear();
+    mPending.clear();
+}
+
+void TileThumbnailCache::scaled(const Key &key, const QImage &image)
+{
+    mPending.remove(key);
+
+    const QPixmap pixmap = QPixmap::fromImage(image);
+    mThumbnails.insert(key, new QPixmap(pixmap),
+                       qMax(1, pixmap.width() * pixmap.height() * 4 / 1024));
+
+    emit thumbnailReady();
+}
+
+} // namespace Tiled
+
+#include "moc_tilethumbnailcache.cpp"
@@ -0,0 +1,86 @@
+/*
+ * tilethumbnailcache.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <QCache>
+#include <QObject>
+#include <QPixmap>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+
+namespace Tiled {
+
+/**
+ * Keeps downscaled versions of tile images, used by the tileset view to
+ * avoid scaling large tile images each time they are painted.
+ *
+ * Thumbnails are created on a thread pool, only for the tiles that are
+ * requested, which are the ones being painted. Since the thumbnails for each
+ * zoom level are kept separately, switching back to a previous zoom level
+ * does not require scaling the images again.
+ */
+class TileThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Key
+    {
+        qint64 cacheKey;
+        QSize size;
+        Qt::TransformationMode mode;
+
+        bool operator==(const Key &other) const;
+    };
+
+    explicit TileThumbnailCache(QObject *parent = nullptr);
+    ~TileThumbnailCache() override;
+
+    QPixmap thumbnail(const QPixmap &image,
+                      QSize size,
+                      Qt::TransformationMode mode);
+
+    void cancelPending();
+
+signals:
+    /**
+     * Emitted when a requested thumbnail has been created.
+     */
+    void thumbnailReady();
+
+private:
+    class ScaleRunnable;
+
+    void scaled(const Key &key, const QImage &image);
+
+    QThreadPool mThreadPool;
+    QCache<Key, QPixmap> mThumbnails;
+    QSet<Key> mPending;
+};
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+uint qHash(const TileThumbnailCache::Key &key, uint seed = 0) Q_DECL_NOTHROW;
+#else
+size_t qHash(const TileThumbnailCache::Key &key, size_t seed = 0) Q_DECL_NOTHROW;
+#endif
+
+} // namespace Tiled
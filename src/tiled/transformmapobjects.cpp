@@ -0,0 +1,130 @@
+/*
+ * transformmapobjects.cpp
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "transformmapobjects.h"
+
+#include "changeevents.h"
+#include "document.h"
+
+#include <QCoreApplication>
+
+using namespace Tiled;
+
+// The properties for which the "changed" flag is tracked, which is relevant
+// for objects that are instances of a template
+static constexpr MapObject::Property TrackedProperties[] = {
+    MapObject::SizeProperty,
+    MapObject::ShapeProperty,
+    MapObject::RotationProperty,
+};
+
+TransformState::TransformState(const MapObject *mapObject)
+    : position(mapObject->position())
+    , size(mapObject->size())
+    , polygon(mapObject->polygon())
+    , rotation(mapObject->rotation())
+    , changedProperties(mapObject->changedProperties())
+{
+}
+
+/**
+ * Applies the given \a properties of this state to the \a mapObject,
+ * including their "changed" flags.
+ */
+void TransformState::apply(MapObject *mapObject,
+                           MapObject::ChangedProperties properties) const
+{
+    if (properties & MapObject::PositionProperty)
+        mapObject->setPosition(position);
+    if (properties & MapObject::SizeProperty)
+        mapObject->setSize(size);
+    if (properties & MapObject::ShapeProperty)
+        mapObject->setPolygon(polygon);
+    if (properties & MapObject::RotationProperty)
+        mapObject->setRotation(rotation);
+
+    for (MapObject::Property property : TrackedProperties)
+        if (properties & property)
+            mapObject->setPropertyChanged(property, changedProperties & property);
+}
+
+
+TransformMapObjects::TransformMapObjects(Document *document,
+                                         const QList<MapObject *> &mapObjects,
+                                         const QVector<TransformState> &oldStates,
+                                         MapObject::ChangedProperties properties,
+                                         QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , mDocument(document)
+    , mMapObjects(mapObjects)
+    , mOldStates(oldStates)
+    , mProperties(properties)
+{
+    Q_ASSERT(mMapObjects.size() == mOldStates.size());
+
+    mNewStates.reserve(mMapObjects.size());
+
+    for (int i = 0; i < mMapObjects.size(); ++i) {
+        TransformState newState(mMapObjects.at(i));
+        const TransformState &oldState = mOldStates.at(i);
+
+        // Mark the changed parts of the transform, skipping the shape of
+        // objects that have no polygon
+        for (MapObject::Property property : TrackedProperties) {
+            if (!(properties & property))
+                continue;
+            if (property == MapObject::ShapeProperty && oldState.polygon.isEmpty())
+                continue;
+
+            newState.changedProperties |= property;
+        }
+
+        mNewStates.append(newState);
+    }
+
+    // Uses the context of the tool, since that's where these texts were
+    // translated before
+    const int count = mMapObjects.size();
+
+    if (properties & MapObject::RotationProperty)
+        setText(QCoreApplication::translate("Tiled::ObjectSelectionTool", "Rotate %n Object(s)", nullptr, count));
+    else if (properties & (MapObject::SizeProperty | MapObject::ShapeProperty))
+        setText(QCoreApplication::translate("Tiled::ObjectSelectionTool", "Resize %n Object(s)", nullptr, count));
+    else
+        setText(QCoreApplication::translate("Tiled::ObjectSelectionTool", "Move %n Object(s)", nullptr, count));
+}
+
+void TransformMapObjects::undo()
+{
+    apply(mOldStates);
+}
+
+void TransformMapObjects::redo()
+{
+    apply(mNewStates);
+}
+
+void TransformMapObjects::apply(const QVector<TransformState> &states)
+{
+    for (int i = 0; i < mMapObjects.size(); ++i)
+        states.at(i).apply(mMapObjects.at(i), mProperties);
+
+    emit mDocument->changed(MapObjectsChangeEvent(mMapObjects, mProperties));
+}
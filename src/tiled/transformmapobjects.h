@@ -0,0 +1,85 @@
+/*
+ * transformmapobjects.h
+ * Copyright 2022, Thorbjørn Lindeijer <bjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "mapobject.h"
+
+#include <QList>
+#include <QUndoCommand>
+#include <QVector>
+
+namespace Tiled {
+
+class Document;
+
+/**
+ * The transform of a map object, as changed by moving, rotating or resizing
+ * it.
+ */
+struct TransformState
+{
+    TransformState() = default;
+    explicit TransformState(const MapObject *mapObject);
+
+    void apply(MapObject *mapObject, MapObject::ChangedProperties properties) const;
+
+    QPointF position;
+    QSizeF size;
+    QPolygonF polygon;
+    qreal rotation = 0.0;
+    MapObject::ChangedProperties changedProperties;
+};
+
+/**
+ * Changes the transform of any number of map objects in one step.
+ *
+ * Only a single change event is emitted for all objects on undo and redo,
+ * which is a lot cheaper than using a macro of commands changing one object
+ * each.
+ */
+class TransformMapObjects : public QUndoCommand
+{
+public:
+    /**
+     * Creates a command that changes the given \a mapObjects from the given
+     * \a oldStates to their current transform. The \a properties are the
+     * parts of the transform that were changed.
+     */
+    TransformMapObjects(Document *document,
+                        const QList<MapObject*> &mapObjects,
+                        const QVector<TransformState> &oldStates,
+                        MapObject::ChangedProperties properties,
+                        QUndoCommand *parent = nullptr);
+
+    void undo() override;
+    void redo() override;
+
+private:
+    void apply(const QVector<TransformState> &states);
+
+    Document *mDocument;
+    QList<MapObject*> mMapObjects;
+    QVector<TransformState> mOldStates;
+    QVector<TransformState> mNewStates;
+    MapObject::ChangedProperties mProperties;
+};
+
+} // namespace Tiled
@@ -40,4 +40,40 @@ bool cloneChildren(const QUndoCommand *command, QUndoCommand *parent)
     return true;
 }
 
+/**
+ * Returns the approximate amount of memory used by the given \a command and
+ * its children, in bytes. Only commands implementing CompressibleUndoCommand
+ * are taken into account.
+ */
+qint64 undoMemoryUsage(const QUndoCommand *command)
+{
+    qint64 usage = 0;
+
+    if (auto compressible = dynamic_cast<const CompressibleUndoCommand*>(command))
+        usage += compressible->memoryUsage();
+
+    for (int i = 0, count = command->childCount(); i < count; ++i)
+        usage += undoMemoryUsage(command->child(i));
+
+    return usage;
+}
+
+/**
+ * Compresses the data of the given \a command and its children. Returns
+ * whether any memory was freed.
+ */
+bool compressUndoCommand(QUndoCommand *command)
+{
+    bool compressed = false;
+
+    if (auto compressible = dynamic_cast<CompressibleUndoCommand*>(command))
+        compressed |= compressible->compress();
+
+    // QUndoCommand only provides const access to its children
+    for (int i = 0, count = command->childCount(); i < count; ++i)
+        compressed |= compressUndoCommand(const_cast<QUndoCommand*>(command->child(i)));
+
+    return compressed;
+}
+
 } // namespace Tiled
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <QtGlobal>
+
 class QUndoCommand;
 
 namespace Tiled {
@@ -65,6 +67,35 @@ public:
     virtual QUndoCommand *clone(QUndoCommand *parent = nullptr) const = 0;
 };
 
+/**
+ * Interface to be implemented by undo commands that may hold on to a lot of
+ * memory.
+ *
+ * When the undo history grows beyond its memory limit, the data of commands
+ * that are unlikely to be needed soon is compressed. Commands should
+ * transparently decompress their data when needed again.
+ */
+class CompressibleUndoCommand
+{
+public:
+    virtual ~CompressibleUndoCommand() = default;
+
+    /**
+     * Returns the approximate amount of memory used by this command, in
+     * bytes, not including its children.
+     */
+    virtual qint64 memoryUsage() const = 0;
+
+    /**
+     * Compresses the data held by this command. Returns whether this
+     * freed any memory.
+     */
+    virtual bool compress() = 0;
+};
+
 bool cloneChildren(const QUndoCommand *command, QUndoCommand *parent);
 
+qint64 undoMemoryUsage(const QUndoCommand *command);
+bool compressUndoCommand(QUndoCommand *command);
+
 } // namespace Tiled
@@ -21,12 +21,69 @@
 
 #include "undodock.h"
 
+#include "undocommands.h"
+
 #include <QEvent>
+#include <QLocale>
+#include <QPainter>
+#include <QStyledItemDelegate>
+#include <QUndoStack>
 #include <QUndoView>
 #include <QVBoxLayout>
 
 using namespace Tiled;
 
+namespace {
+
+/**
+ * Shows the memory used by each command on the right side, for commands
+ * that use a significant amount of memory.
+ */
+class UndoCommandDelegate : public QStyledItemDelegate
+{
+public:
+    explicit UndoCommandDelegate(QUndoView *view)
+        : QStyledItemDelegate(view)
+        , mView(view)
+    {}
+
+    void paint(QPainter *painter,
+               const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+
+private:
+    QUndoView *mView;
+};
+
+void UndoCommandDelegate::paint(QPainter *painter,
+                                const QStyleOptionViewItem &option,
+                                const QModelIndex &index) const
+{
+    QStyledItemDelegate::paint(painter, option, index);
+
+    // The first row represents the empty state
+    const QUndoStack *stack = mView->stack();
+    if (!stack || index.row() == 0 || index.row() > stack->count())
+        return;
+
+    const qint64 usage = undoMemoryUsage(stack->command(index.row() - 1));
+    if (usage < 1024)
+        return;
+
+    const QString text = QLocale().formattedDataSize(usage);
+    const QRect textRect = option.rect.adjusted(0, 0, -4, 0);
+    const bool selected = option.state & QStyle::State_Selected;
+
+    painter->save();
+    painter->setPen(option.palette.color(QPalette::Disabled,
+                                         selected ? QPalette::HighlightedText
+                                                  : QPalette::Text));
+    painter->drawText(textRect, Qt::AlignRight | Qt::AlignVCenter, text);
+    painter->restore();
+}
+
+} // anonymous namespace
+
 UndoDock::UndoDock(QWidget *parent)
     : QDockWidget(parent)
 {
@@ -36,6 +93,7 @@ UndoDock::UndoDock(QWidget *parent)
     QIcon cleanIcon(QLatin1String(":images/16/drive-harddisk.png"));
     mUndoView->setCleanIcon(cleanIcon);
     mUndoView->setUniformItemSizes(true);
+    mUndoView->setItemDelegate(new UndoCommandDelegate(mUndoView));
 
     QWidget *widget = new QWidget(this);
     QVBoxLayout *layout = new QVBoxLayout(widget);
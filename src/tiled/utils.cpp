@@ -263,6 +263,43 @@ int matchingScore(const QStringList &words, QStringRef string)
     return totalScore;
 }
 
+static quint64 characterBit(QChar c)
+{
+    const auto u = c.toCaseFolded().unicode();
+
+    if (u >= 'a' && u <= 'z')
+        return quint64(1) << (u - 'a');
+    if (u >= '0' && u <= '9')
+        return quint64(1) << (26 + u - '0');
+
+    // All other characters share the remaining 28 bits
+    return quint64(1) << (36 + u % 28);
+}
+
+/**
+ * Returns a mask of the characters in the given \a string, ignoring case.
+ *
+ * Can be used to quickly rule out strings that don't match a set of words,
+ * since matchingScore() can only match a string when its mask contains the
+ * mask of the words.
+ */
+quint64 characterMask(QStringRef string)
+{
+    quint64 mask = 0;
+    for (const QChar c : string)
+        mask |= characterBit(c);
+    return mask;
+}
+
+quint64 characterMask(const QStringList &words)
+{
+    quint64 mask = 0;
+    for (const QString &word : words)
+        for (const QChar c : word)
+            mask |= characterBit(c);
+    return mask;
+}
+
 RangeSet<int> matchingRanges(const QStringList &words, QStringRef string)
 {
     const int startOfFileName = string.lastIndexOf(QLatin1Char('/')) + 1;
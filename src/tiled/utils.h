@@ -47,6 +47,8 @@ bool fileNameMatchesNameFilter(const QString &fileName,
 QString firstExtension(const QString &nameFilter);
 
 int matchingScore(const QStringList &words, QStringRef string);
+quint64 characterMask(QStringRef string);
+quint64 characterMask(const QStringList &words);
 RangeSet<int> matchingRanges(const QStringList &words, QStringRef string);
 
 /**
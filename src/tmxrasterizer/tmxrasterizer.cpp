@@ -28,13 +28,11 @@
 
 #include "tmxrasterizer.h"
 
-#include "imagelayer.h"
 #include "map.h"
 #include "mapformat.h"
+#include "mapimagerenderer.h"
 #include "mapreader.h"
 #include "maprenderer.h"
-#include "objectgroup.h"
-#include "tilelayer.h"
 #include "tilesetmanager.h"
 #include "worldmanager.h"
 
@@ -53,51 +51,13 @@ void TmxRasterizer::drawMapLayers(const MapRenderer &renderer,
                                   QPainter &painter,
                                   QPoint mapOffset) const
 {
-    // Perform a similar rendering than found in minimaprenderer.cpp
-    LayerIterator iterator(renderer.map());
-    while (const Layer *layer = iterator.next()) {
-        if (!shouldDrawLayer(layer))
-            continue;
-
-        const auto offset = layer->totalOffset() + mapOffset;
-        painter.setOpacity(layer->effectiveOpacity());
-        painter.translate(offset);
-
-        const TileLayer *tileLayer = dynamic_cast<const TileLayer*>(layer);
-        const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
-        const ObjectGroup *objectGroup = dynamic_cast<const ObjectGroup*>(layer);
-
-        if (tileLayer) {
-            renderer.drawTileLayer(&painter, tileLayer);
-        } else if (imageLayer) {
-            renderer.drawImageLayer(&painter, imageLayer);
-        } else if (objectGroup) {
-            QList<MapObject*> objects = objectGroup->objects();
-
-            if (objectGroup->drawOrder() == ObjectGroup::TopDownOrder)
-                std::stable_sort(objects.begin(), objects.end(), [](MapObject *a, MapObject *b){return a->y() < b->y();});
-
-            for (const MapObject *object : qAsConst(objects)) {
-                if (object->isVisible()) {
-                    if (object->rotation() != qreal(0)) {
-                        QPointF origin = renderer.pixelToScreenCoords(object->position());
-                        painter.save();
-                        painter.translate(origin);
-                        painter.rotate(object->rotation());
-                        painter.translate(-origin);
-                    }
-
-                    const QColor color = object->effectiveColor();
-                    renderer.drawMapObject(&painter, object, color);
-
-                    if (object->rotation() != qreal(0))
-                        painter.restore();
-                }
-            }
-        }
+    MapImageRenderer::Options options;
+    options.flags |= MapImageRenderer::IncludeHiddenLayers;   // handled by shouldDrawLayer
+    options.layerFilter = [this] (const Layer *layer) { return shouldDrawLayer(layer); };
 
-        painter.translate(-offset);
-    }
+    painter.translate(mapOffset);
+    MapImageRenderer::drawLayers(painter, renderer, options);
+    painter.translate(-mapOffset);
 }
 
 bool TmxRasterizer::shouldDrawLayer(const Layer *layer) const
@@ -110,6 +110,9 @@ public:
     void paint(QPainter *p, const QStyleOptionGraphicsItem *option, QWidget *) override
     {
         mRenderer->drawTileLayer(p, mTileLayer, option->rect);
+
+        // Release chunks that haven't been drawn recently
+        mTileLayer->unloadColdChunks();
     }
 
 private:
@@ -196,6 +199,9 @@ bool TmxViewer::viewMap(const QString &fileName)
 
     mRenderer.reset();
 
+    // Only decode the chunks of infinite maps when they are displayed
+    MapReader::setLazyChunkLoadingEnabled(true);
+
     MapReader reader;
     mMap = reader.readMap(fileName);
     if (!mMap) {
@@ -0,0 +1,37 @@
+include(../../src/libtiled/libtiled.pri)
+
+QT += testlib
+CONFIG += c++17
+TEMPLATE = app
+TARGET = benchmarks
+
+macx {
+    LIBS += -L$$OUT_PWD/../../bin/Tiled.app/Contents/Frameworks
+} else {
+    LIBS += -L$$OUT_PWD/../../lib
+}
+
+!win32:!macx:!cygwin {
+    QMAKE_RPATHDIR += \$\$ORIGIN/../../lib
+
+    # It is not possible to use ORIGIN in QMAKE_RPATHDIR, so a bit manually
+    QMAKE_LFLAGS += -Wl,-z,origin \'-Wl,-rpath,$$join(QMAKE_RPATHDIR, ":")\'
+    QMAKE_RPATHDIR =
+}
+
+INCLUDEPATH += ../../src/tiled
+
+# Input
+SOURCES += ../../src/tiled/wangfiller.cpp \
+    layerdatabenchmark.cpp \
+    main.cpp \
+    mapiobenchmark.cpp \
+    renderbenchmark.cpp \
+    syntheticmap.cpp \
+    tilelayerbenchmark.cpp
+HEADERS += ../../src/tiled/wangfiller.h \
+    layerdatabenchmark.h \
+    mapiobenchmark.h \
+    renderbenchmark.h \
+    syntheticmap.h \
+    tilelayerbenchmark.h
@@ -0,0 +1,110 @@
+#include "layerdatabenchmark.h"
+
+#include "syntheticmap.h"
+#include "tilelayer.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+/**
+ * The way CSV data used to be written, for comparison.
+ */
+static QString legacyEncodeCSV(const GidMapper &gidMapper,
+                               const TileLayer &tileLayer,
+                               QRect bounds)
+{
+    QString chunkData;
+    chunkData.append(QLatin1Char('\n'));
+
+    for (int y = bounds.top(); y <= bounds.bottom(); y++) {
+        for (int x = bounds.left(); x <= bounds.right(); x++) {
+            const unsigned gid = gidMapper.cellToGid(tileLayer.cellAt(x, y));
+            chunkData.append(QString::number(gid));
+            if (x != bounds.right() || y != bounds.bottom())
+                chunkData.append(QLatin1Char(','));
+        }
+        chunkData.append(QLatin1Char('\n'));
+    }
+
+    return chunkData;
+}
+
+void LayerDataBenchmark::initTestCase()
+{
+    mMap = createSyntheticMap();
+    mGidMapper = GidMapper(mMap->tilesets());
+}
+
+void LayerDataBenchmark::encodeCSV_data()
+{
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("QString") << true;
+    QTest::newRow("formatUnsigned") << false;
+}
+
+void LayerDataBenchmark::encodeCSV()
+{
+    QFETCH(bool, legacy);
+
+    const TileLayer &tileLayer = *mMap->layerAt(0)->asTileLayer();
+    const QRect bounds = tileLayer.localBounds();
+
+    if (legacy) {
+        QBENCHMARK {
+            const QString csv = legacyEncodeCSV(mGidMapper, tileLayer, bounds);
+            Q_UNUSED(csv)
+        }
+    } else {
+        QBENCHMARK {
+            const QString csv = QString::fromLatin1(mGidMapper.encodeCSVLayerData(tileLayer, bounds, true));
+            Q_UNUSED(csv)
+        }
+    }
+}
+
+static void addBinaryLayerDataFormatRows()
+{
+    QTest::addColumn<Map::LayerDataFormat>("format");
+
+    QTest::newRow("base64") << Map::Base64;
+    QTest::newRow("base64-gzip") << Map::Base64Gzip;
+    QTest::newRow("base64-zlib") << Map::Base64Zlib;
+}
+
+void LayerDataBenchmark::encodeLayerData_data()
+{
+    addBinaryLayerDataFormatRows();
+}
+
+void LayerDataBenchmark::encodeLayerData()
+{
+    QFETCH(Map::LayerDataFormat, format);
+
+    const TileLayer &tileLayer = *mMap->layerAt(0)->asTileLayer();
+
+    QBENCHMARK {
+        const QByteArray data = mGidMapper.encodeLayerData(tileLayer, format);
+        QVERIFY(!data.isEmpty());
+    }
+}
+
+void LayerDataBenchmark::decodeLayerData_data()
+{
+    addBinaryLayerDataFormatRows();
+}
+
+void LayerDataBenchmark::decodeLayerData()
+{
+    QFETCH(Map::LayerDataFormat, format);
+
+    const TileLayer &tileLayer = *mMap->layerAt(0)->asTileLayer();
+    const QRect bounds = tileLayer.localBounds();
+    const QByteArray data = mGidMapper.encodeLayerData(tileLayer, format);
+
+    QBENCHMARK {
+        TileLayer decoded(QString(), 0, 0, bounds.width(), bounds.height());
+        QCOMPARE(mGidMapper.decodeLayerData(decoded, data, format, bounds), GidMapper::NoError);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "gidmapper.h"
+#include "map.h"
+
+#include <QObject>
+
+#include <memory>
+
+/**
+ * Benchmarks the encoding and decoding of tile layer data.
+ */
+class LayerDataBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void encodeCSV_data();
+    void encodeCSV();
+
+    void encodeLayerData_data();
+    void encodeLayerData();
+
+    void decodeLayerData_data();
+    void decodeLayerData();
+
+private:
+    std::unique_ptr<Tiled::Map> mMap;
+    Tiled::GidMapper mGidMapper;
+};
@@ -0,0 +1,86 @@
+#include "layerdatabenchmark.h"
+#include "mapiobenchmark.h"
+#include "renderbenchmark.h"
+#include "syntheticmap.h"
+#include "tilelayerbenchmark.h"
+
+#include <QDir>
+#include <QGuiApplication>
+#include <QtTest/QtTest>
+
+/*
+ * Runs all benchmarks, or only those selected with "-benchmark <name>".
+ *
+ * Additional options:
+ *
+ *   -mapsize <n>       Width and height of the synthetic maps (default 1000)
+ *   -resultsdir <dir>  Also write the results of each benchmark to
+ *                      <dir>/<name>.csv, for comparing between releases
+ *
+ * Any other arguments are passed on to QTest, for example "-iterations 10"
+ * or "-callgrind".
+ */
+int main(int argc, char *argv[])
+{
+    // Allow running the benchmarks without a display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QGuiApplication app(argc, argv);
+
+    QStringList testArguments;
+    QStringList selectedBenchmarks;
+    QString resultsDir;
+
+    const QStringList arguments = app.arguments();
+    for (int i = 0; i < arguments.size(); ++i) {
+        const QString &argument = arguments.at(i);
+        const bool hasValue = i + 1 < arguments.size();
+
+        if (argument == QLatin1String("-benchmark") && hasValue) {
+            selectedBenchmarks.append(arguments.at(++i));
+        } else if (argument == QLatin1String("-mapsize") && hasValue) {
+            SyntheticMapOptions::setDefaultSize(arguments.at(++i).toInt());
+        } else if (argument == QLatin1String("-resultsdir") && hasValue) {
+            resultsDir = arguments.at(++i);
+        } else {
+            testArguments.append(argument);
+        }
+    }
+
+    if (!resultsDir.isEmpty() && !QDir().mkpath(resultsDir)) {
+        qWarning("Could not create results directory: %s", qUtf8Printable(resultsDir));
+        return 1;
+    }
+
+    LayerDataBenchmark layerDataBenchmark;
+    MapIOBenchmark mapIOBenchmark;
+    RenderBenchmark renderBenchmark;
+    TileLayerBenchmark tileLayerBenchmark;
+
+    const QList<QObject*> benchmarks {
+        &layerDataBenchmark,
+        &mapIOBenchmark,
+        &renderBenchmark,
+        &tileLayerBenchmark,
+    };
+
+    int status = 0;
+
+    for (QObject *benchmark : benchmarks) {
+        const QString name = QString::fromLatin1(benchmark->metaObject()->className());
+        if (!selectedBenchmarks.isEmpty() && !selectedBenchmarks.contains(name))
+            continue;
+
+        QStringList benchmarkArguments = testArguments;
+        if (!resultsDir.isEmpty()) {
+            const QString fileName = QDir(resultsDir).filePath(name + QLatin1String(".csv"));
+            benchmarkArguments << QStringLiteral("-o") << fileName + QLatin1String(",csv")
+                               << QStringLiteral("-o") << QStringLiteral("-,txt");
+        }
+
+        status |= QTest::qExec(benchmark, benchmarkArguments);
+    }
+
+    return status;
+}
@@ -0,0 +1,145 @@
+#include "mapiobenchmark.h"
+
+#include "mapreader.h"
+#include "maptovariantconverter.h"
+#include "mapwriter.h"
+#include "syntheticmap.h"
+#include "varianttomapconverter.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QJsonDocument>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+static void addMapRows()
+{
+    QTest::addColumn<SyntheticMapOptions>("options");
+    QTest::addColumn<Map::LayerDataFormat>("format");
+
+    const struct {
+        const char *name;
+        Map::LayerDataFormat format;
+    } formats[] = {
+        { "csv", Map::CSV },
+        { "base64", Map::Base64 },
+        { "base64-zlib", Map::Base64Zlib },
+    };
+
+    for (bool infinite : { false, true }) {
+        SyntheticMapOptions options;
+        options.infinite = infinite;
+
+        for (const auto &format : formats) {
+            QTest::newRow((syntheticMapTag(options) + '-' + format.name).constData())
+                    << options << format.format;
+        }
+    }
+
+    SyntheticMapOptions objects;
+    objects.width = 100;
+    objects.height = 100;
+    objects.objectCount = 100000;
+    QTest::newRow(syntheticMapTag(objects).constData()) << objects << Map::Base64Zlib;
+
+    SyntheticMapOptions tilesets;
+    tilesets.tilesetCount = 100;
+    QTest::newRow((syntheticMapTag(tilesets) + "-100-tilesets").constData()) << tilesets << Map::Base64Zlib;
+}
+
+static std::unique_ptr<Map> createMap(const SyntheticMapOptions &options,
+                                      Map::LayerDataFormat format)
+{
+    auto map = createSyntheticMap(options);
+    map->setLayerDataFormat(format);
+    return map;
+}
+
+static QByteArray writeJson(const Map &map)
+{
+    MapToVariantConverter converter;
+    const QVariant variant = converter.toVariant(map, QDir::current());
+    return QJsonDocument::fromVariant(variant).toJson(QJsonDocument::Compact);
+}
+
+void MapIOBenchmark::readTmx_data()
+{
+    addMapRows();
+}
+
+void MapIOBenchmark::readTmx()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(Map::LayerDataFormat, format);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MapWriter().writeMap(createMap(options, format).get(), &buffer);
+    buffer.close();
+
+    QBENCHMARK {
+        buffer.open(QIODevice::ReadOnly);
+        MapReader reader;
+        const auto map = reader.readMap(&buffer);
+        buffer.close();
+        QVERIFY(map);
+    }
+}
+
+void MapIOBenchmark::writeTmx_data()
+{
+    addMapRows();
+}
+
+void MapIOBenchmark::writeTmx()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(Map::LayerDataFormat, format);
+
+    const auto map = createMap(options, format);
+
+    QBENCHMARK {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        MapWriter().writeMap(map.get(), &buffer);
+    }
+}
+
+void MapIOBenchmark::readJson_data()
+{
+    addMapRows();
+}
+
+void MapIOBenchmark::readJson()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(Map::LayerDataFormat, format);
+
+    const QByteArray json = writeJson(*createMap(options, format));
+
+    QBENCHMARK {
+        const QJsonDocument document = QJsonDocument::fromJson(json);
+        VariantToMapConverter converter;
+        const auto map = converter.toMap(document.toVariant(), QDir::current());
+        QVERIFY(map);
+    }
+}
+
+void MapIOBenchmark::writeJson_data()
+{
+    addMapRows();
+}
+
+void MapIOBenchmark::writeJson()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(Map::LayerDataFormat, format);
+
+    const auto map = createMap(options, format);
+
+    QBENCHMARK {
+        const QByteArray json = writeJson(*map);
+        QVERIFY(!json.isEmpty());
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "map.h"
+
+#include <QObject>
+
+/**
+ * Benchmarks reading and writing whole maps in the TMX and JSON formats.
+ */
+class MapIOBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void readTmx_data();
+    void readTmx();
+
+    void writeTmx_data();
+    void writeTmx();
+
+    void readJson_data();
+    void readJson();
+
+    void writeJson_data();
+    void writeJson();
+};
@@ -0,0 +1,143 @@
+#include "renderbenchmark.h"
+
+#include "mapimagerenderer.h"
+#include "maprenderer.h"
+#include "syntheticmap.h"
+#include "tile.h"
+#include "tilelayer.h"
+
+#include <QImage>
+#include <QPainter>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+static const QSize ViewportSize(1920, 1080);
+
+void RenderBenchmark::drawTileLayer_data()
+{
+    QTest::addColumn<SyntheticMapOptions>("options");
+    QTest::addColumn<qreal>("scale");
+
+    const Map::Orientation orientations[] = {
+        Map::Orthogonal,
+        Map::Isometric,
+        Map::Staggered,
+        Map::Hexagonal,
+    };
+
+    for (Map::Orientation orientation : orientations) {
+        for (bool infinite : { false, true }) {
+            SyntheticMapOptions options;
+            options.orientation = orientation;
+            options.infinite = infinite;
+            options.tilesetImages = true;
+
+            // Zoomed in and zoomed out, where many more tiles are visible
+            for (qreal scale : { 1.0, 0.125 }) {
+                QTest::newRow((syntheticMapTag(options) + "-scale-" + QByteArray::number(scale)).constData())
+                        << options << scale;
+            }
+        }
+    }
+}
+
+void RenderBenchmark::drawTileLayer()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(qreal, scale);
+
+    const auto map = createSyntheticMap(options);
+    const auto renderer = MapRenderer::create(map.get());
+    const TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+
+    // Look at the center of the map
+    const QRectF layerRect = renderer->boundingRect(tileLayer->bounds());
+    QRectF exposed(QPointF(), QSizeF(ViewportSize) / scale);
+    exposed.moveCenter(layerRect.center());
+
+    QImage image(ViewportSize, QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.scale(scale, scale);
+        painter.translate(-exposed.topLeft());
+        renderer->drawTileLayer(&painter, tileLayer, exposed);
+    }
+}
+
+void RenderBenchmark::resolveTiles_data()
+{
+    QTest::addColumn<SyntheticMapOptions>("options");
+
+    for (bool infinite : { false, true }) {
+        SyntheticMapOptions options;
+        options.infinite = infinite;
+        options.tilesetImages = true;
+
+        QTest::newRow(syntheticMapTag(options).constData()) << options;
+    }
+}
+
+/*
+ * Looks up the tile of each cell, which the renderers do for every cell
+ * they draw.
+ */
+void RenderBenchmark::resolveTiles()
+{
+    QFETCH(SyntheticMapOptions, options);
+
+    const auto map = createSyntheticMap(options);
+    const TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+
+    QBENCHMARK {
+        int found = 0;
+        for (const Cell &cell : *tileLayer)
+            if (const Tile *tile = cell.tile())
+                if (!tile->currentFrameTile()->image().isNull())
+                    ++found;
+        QVERIFY(found > 0);
+    }
+}
+
+void RenderBenchmark::renderMapImage_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("levelOfDetail");
+
+    for (int threadCount : { 1, 4 }) {
+        for (bool levelOfDetail : { false, true }) {
+            const QByteArray tag = "threads-" + QByteArray::number(threadCount) +
+                    (levelOfDetail ? "-lod" : "");
+            QTest::newRow(tag.constData()) << threadCount << levelOfDetail;
+        }
+    }
+}
+
+/*
+ * Renders a thumbnail of a whole map, reusing the renderer between
+ * iterations like when generating thumbnails for many maps.
+ */
+void RenderBenchmark::renderMapImage()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, levelOfDetail);
+
+    SyntheticMapOptions options;
+    options.tilesetImages = true;
+
+    const auto map = createSyntheticMap(options);
+
+    MapImageRenderer renderer;
+    MapImageRenderer::Options renderOptions;
+    renderOptions.threadCount = threadCount;
+    renderOptions.flags.setFlag(MapImageRenderer::UseLevelOfDetail, levelOfDetail);
+
+    QImage image(512, 512, QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK {
+        renderer.render(map.get(), image, renderOptions);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QObject>
+
+/**
+ * Benchmarks rendering tile layers into an offscreen image, as well as
+ * looking up the tiles referenced by their cells.
+ */
+class RenderBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void drawTileLayer_data();
+    void drawTileLayer();
+
+    void resolveTiles_data();
+    void resolveTiles();
+
+    void renderMapImage_data();
+    void renderMapImage();
+};
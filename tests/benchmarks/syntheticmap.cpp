@@ -0,0 +1,146 @@
+#include "syntheticmap.h"
+
+#include "objectgroup.h"
+#include "mapobject.h"
+#include "tilelayer.h"
+
+#include <QImage>
+#include <QPainter>
+
+using namespace Tiled;
+
+static const int TileSize = 32;
+static const int TilesetColumns = 32;
+static const int TilesPerTileset = TilesetColumns * TilesetColumns;
+
+static int sDefaultSize = 1000;
+
+int SyntheticMapOptions::defaultSize()
+{
+    return sDefaultSize;
+}
+
+void SyntheticMapOptions::setDefaultSize(int size)
+{
+    sDefaultSize = size;
+}
+
+static SharedTileset createTileset(int index, bool withImage)
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("Tileset %1").arg(index),
+                                            TileSize, TileSize);
+
+    if (withImage) {
+        QImage image(TileSize * TilesetColumns, TileSize * TilesetColumns,
+                     QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::transparent);
+
+        // Give each tile a distinct, partially transparent appearance
+        QPainter painter(&image);
+        for (int id = 0; id < TilesPerTileset; ++id) {
+            const QRect rect((id % TilesetColumns) * TileSize,
+                             (id / TilesetColumns) * TileSize,
+                             TileSize, TileSize);
+            painter.fillRect(rect.adjusted(id % 4, id % 3, 0, 0),
+                             QColor::fromHsv((id * 7 + index * 60) % 360, 200, 200, 220));
+        }
+        painter.end();
+
+        tileset->loadFromImage(image, QStringLiteral("synthetic%1.png").arg(index));
+    } else {
+        tileset->setNextTileId(TilesPerTileset);
+    }
+
+    return tileset;
+}
+
+std::unique_ptr<Map> createSyntheticMap(const SyntheticMapOptions &options)
+{
+    Map::Parameters parameters;
+    parameters.orientation = options.orientation;
+    parameters.width = options.width;
+    parameters.height = options.height;
+    parameters.tileWidth = TileSize;
+    parameters.tileHeight = TileSize;
+    parameters.infinite = options.infinite;
+
+    switch (options.orientation) {
+    case Map::Isometric:
+    case Map::Staggered:
+        parameters.tileHeight = TileSize / 2;
+        break;
+    case Map::Hexagonal:
+        parameters.hexSideLength = TileSize / 2;
+        break;
+    default:
+        break;
+    }
+
+    auto map = std::make_unique<Map>(parameters);
+
+    for (int i = 0; i < options.tilesetCount; ++i)
+        map->addTileset(createTileset(i, options.tilesetImages));
+
+    // Infinite maps are filled around the origin, to get negative chunks
+    QRect area(0, 0, options.width, options.height);
+    if (options.infinite)
+        area.moveTo(-options.width / 2, -options.height / 2);
+
+    for (int l = 0; l < options.tileLayerCount; ++l) {
+        auto tileLayer = std::make_unique<TileLayer>(QStringLiteral("Tile Layer %1").arg(l + 1),
+                                                     0, 0,
+                                                     options.infinite ? 0 : options.width,
+                                                     options.infinite ? 0 : options.height);
+
+        // Patches of tiles from the same tileset, to get a realistic spread
+        // of gid lengths and larger areas of matching cells
+        for (int y = area.top(); y <= area.bottom(); ++y) {
+            for (int x = area.left(); x <= area.right(); ++x) {
+                const int patch = (x >> 6) + (y >> 6) + l;
+                if (options.tilesetCount == 0 || patch % 5 == 4)
+                    continue;   // leave some areas empty
+
+                Tileset *tileset = map->tilesetAt(patch % options.tilesetCount).data();
+                const int tileId = patch % 3 == 0 ? patch % TilesPerTileset
+                                                  : (x * 7 + y * 13) % TilesPerTileset;
+                tileLayer->setCell(x, y, Cell(tileset, tileId));
+            }
+        }
+
+        map->addLayer(std::move(tileLayer));
+    }
+
+    if (options.objectCount > 0) {
+        auto objectGroup = std::make_unique<ObjectGroup>(QStringLiteral("Objects"));
+        const QSize mapSize = map->mapSize();
+
+        for (int i = 0; i < options.objectCount; ++i) {
+            const QPointF pos((i * 7919) % qMax(1, mapSize.width() * TileSize),
+                              (i * 6151) % qMax(1, mapSize.height() * TileSize));
+
+            auto object = std::make_unique<MapObject>(QStringLiteral("Object %1").arg(i),
+                                                      QString(),
+                                                      pos,
+                                                      QSizeF(TileSize, TileSize));
+            if (i % 4 == 0)
+                object->setProperty(QStringLiteral("index"), i);
+
+            objectGroup->addObject(std::move(object));
+        }
+
+        map->initializeObjectIds(*objectGroup);
+        map->addLayer(std::move(objectGroup));
+    }
+
+    return map;
+}
+
+QByteArray syntheticMapTag(const SyntheticMapOptions &options)
+{
+    QByteArray tag = orientationToString(options.orientation).toLatin1();
+    tag += options.infinite ? "-infinite" : "-finite";
+    tag += '-' + QByteArray::number(options.width) + 'x' + QByteArray::number(options.height);
+    if (options.objectCount > 0)
+        tag += '-' + QByteArray::number(options.objectCount) + "-objects";
+    return tag;
+}
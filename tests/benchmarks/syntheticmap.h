@@ -0,0 +1,42 @@
+#pragma once
+
+#include "map.h"
+
+#include <memory>
+
+/**
+ * Parameters for generating a synthetic map to run the benchmarks on.
+ */
+struct SyntheticMapOptions
+{
+    Tiled::Map::Orientation orientation = Tiled::Map::Orthogonal;
+    bool infinite = false;
+    int width = defaultSize();
+    int height = defaultSize();
+    int tileLayerCount = 1;
+    int tilesetCount = 2;
+    int objectCount = 0;
+
+    /**
+     * Whether the tilesets should have an image, which is necessary for
+     * rendering. Disabled by default since reading a map would otherwise
+     * fail to find the image.
+     */
+    bool tilesetImages = false;
+
+    /**
+     * The width and height of the generated maps, unless otherwise
+     * specified. Can be changed with the "-mapsize" command-line option.
+     */
+    static int defaultSize();
+    static void setDefaultSize(int size);
+};
+
+std::unique_ptr<Tiled::Map> createSyntheticMap(const SyntheticMapOptions &options = SyntheticMapOptions());
+
+/**
+ * Returns a short name of the given \a options, for use as data tag.
+ */
+QByteArray syntheticMapTag(const SyntheticMapOptions &options);
+
+Q_DECLARE_METATYPE(SyntheticMapOptions)
@@ -0,0 +1,147 @@
+#include "tilelayerbenchmark.h"
+
+#include "maprenderer.h"
+#include "syntheticmap.h"
+#include "tilelayer.h"
+#include "wangfiller.h"
+#include "wangset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+static void addOrientationRows()
+{
+    QTest::addColumn<SyntheticMapOptions>("options");
+
+    for (Map::Orientation orientation : { Map::Orthogonal, Map::Hexagonal }) {
+        for (bool infinite : { false, true }) {
+            SyntheticMapOptions options;
+            options.orientation = orientation;
+            options.infinite = infinite;
+
+            QTest::newRow(syntheticMapTag(options).constData()) << options;
+        }
+    }
+}
+
+void TileLayerBenchmark::region_data()
+{
+    addOrientationRows();
+}
+
+void TileLayerBenchmark::region()
+{
+    QFETCH(SyntheticMapOptions, options);
+
+    const auto map = createSyntheticMap(options);
+    const TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+
+    QBENCHMARK {
+        const QRegion region = tileLayer->region();
+        QVERIFY(!region.isEmpty());
+    }
+}
+
+void TileLayerBenchmark::computeFillRegion_data()
+{
+    addOrientationRows();
+}
+
+void TileLayerBenchmark::computeFillRegion()
+{
+    QFETCH(SyntheticMapOptions, options);
+
+    // A single tile layer with empty areas to fill, separated by walls
+    options.tilesetCount = 1;
+    auto map = createSyntheticMap(options);
+    TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+
+    const QRect bounds = tileLayer->localBounds();
+    const Cell wall(map->tilesetAt(0).data(), 0);
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        for (int x = bounds.left(); x <= bounds.right(); ++x) {
+            const bool isWall = (x % 32 == 0 && y % 64 != 32) || (y % 32 == 0 && x % 64 != 32);
+            tileLayer->setCell(x, y, isWall ? wall : Cell());
+        }
+    }
+
+    const QPoint fillOrigin = bounds.center() + QPoint(5, 5);
+
+    QBENCHMARK {
+        const QRegion region = tileLayer->computeFillRegion(bounds, fillOrigin);
+        QVERIFY(!region.isEmpty());
+    }
+}
+
+/**
+ * Creates a corner Wang set with two colors, with a tile for each of the 16
+ * possible combinations.
+ */
+static std::unique_ptr<WangSet> createCornerWangSet(Tileset *tileset)
+{
+    auto wangSet = std::make_unique<WangSet>(tileset, QStringLiteral("Terrain"), WangSet::Corner);
+    wangSet->addWangColor(QSharedPointer<WangColor>::create(1, QStringLiteral("Grass"), Qt::green));
+    wangSet->addWangColor(QSharedPointer<WangColor>::create(2, QStringLiteral("Water"), Qt::blue));
+
+    for (int tileId = 0; tileId < 16; ++tileId) {
+        WangId wangId;
+        for (int corner = 0; corner < WangId::NumCorners; ++corner)
+            wangId.setCornerColor(corner, (tileId >> corner) & 1 ? 2 : 1);
+        wangSet->setWangId(tileId, wangId);
+    }
+
+    return wangSet;
+}
+
+void TileLayerBenchmark::wangFill_data()
+{
+    QTest::addColumn<SyntheticMapOptions>("options");
+    QTest::addColumn<int>("size");
+
+    for (Map::Orientation orientation : { Map::Orthogonal, Map::Staggered }) {
+        SyntheticMapOptions options;
+        options.orientation = orientation;
+        options.width = 256;
+        options.height = 256;
+        options.tilesetCount = 0;
+
+        for (int size : { 32, 128 }) {
+            QTest::newRow((syntheticMapTag(options) + "-fill-" + QByteArray::number(size)).constData())
+                    << options << size;
+        }
+    }
+}
+
+void TileLayerBenchmark::wangFill()
+{
+    QFETCH(SyntheticMapOptions, options);
+    QFETCH(int, size);
+
+    auto map = createSyntheticMap(options);
+
+    SharedTileset tileset = Tileset::create(QStringLiteral("Terrain"), 32, 32);
+    tileset->setNextTileId(16);
+    tileset->addWangSet(createCornerWangSet(tileset.data()));
+    map->addTileset(tileset);
+
+    const WangSet &wangSet = *tileset->wangSet(0);
+    const auto renderer = MapRenderer::create(map.get());
+
+    // Start from a checkerboard of the two colors, like an existing map
+    TileLayer back(QString(), 0, 0, options.width, options.height);
+    for (int y = 0; y < options.height; ++y)
+        for (int x = 0; x < options.width; ++x)
+            back.setCell(x, y, Cell(tileset.data(), ((x / 16 + y / 16) % 2) ? 15 : 0));
+
+    const QRegion region(QRect((options.width - size) / 2,
+                               (options.height - size) / 2,
+                               size, size));
+
+    QBENCHMARK {
+        TileLayer target(QString(), 0, 0, options.width, options.height);
+        WangFiller wangFiller(wangSet, renderer.get());
+        wangFiller.fillRegion(target, back, region);
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QObject>
+
+/**
+ * Benchmarks region computations and fill operations on tile layers.
+ */
+class TileLayerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void region_data();
+    void region();
+
+    void computeFillRegion_data();
+    void computeFillRegion();
+
+    void wangFill_data();
+    void wangFill();
+};
@@ -0,0 +1,155 @@
+#include "dependencyindex.h"
+#include "exportmanifest.h"
+
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+// Stands in for the dependency index, which requires a project
+static QHash<QString, QStringList> sDependencies;
+
+bool DependencyIndex::isIndexed(const QString &fileName)
+{
+    return sDependencies.contains(fileName);
+}
+
+QStringList DependencyIndex::readDependencies(const QString &fileName)
+{
+    return sDependencies.value(fileName);
+}
+
+class test_ExportManifest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void upToDate();
+    void changedDependency();
+    void changedOptions();
+    void changedProject();
+    void missingTarget();
+
+private:
+    static bool writeFile(const QString &fileName, const QByteArray &contents);
+    void exportMap();
+
+    std::unique_ptr<QTemporaryDir> mDir;
+    QString mProjectFile;
+    QString mMapFile;
+    QString mTilesetFile;
+    QString mTargetFile;
+};
+
+bool test_ExportManifest::writeFile(const QString &fileName, const QByteArray &contents)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+
+void test_ExportManifest::initTestCase()
+{
+    // Keeps the manifests out of the user's cache directory
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void test_ExportManifest::init()
+{
+    mDir = std::make_unique<QTemporaryDir>();
+    QVERIFY(mDir->isValid());
+
+    const QDir dir(mDir->path());
+    mProjectFile = dir.filePath(QStringLiteral("test.tiled-project"));
+    mMapFile = dir.filePath(QStringLiteral("map.tmx"));
+    mTilesetFile = dir.filePath(QStringLiteral("tileset.tsx"));
+    mTargetFile = dir.filePath(QStringLiteral("map.json"));
+
+    QVERIFY(writeFile(mProjectFile, "project"));
+    QVERIFY(writeFile(mMapFile, "map"));
+    QVERIFY(writeFile(mTilesetFile, "tileset"));
+
+    sDependencies.insert(mMapFile, { mTilesetFile });
+    sDependencies.insert(mTilesetFile, {});
+}
+
+void test_ExportManifest::cleanup()
+{
+    sDependencies.clear();
+    mDir.reset();
+}
+
+/**
+ * Exports the map, as far as the manifest is concerned, and saves the
+ * manifest.
+ */
+void test_ExportManifest::exportMap()
+{
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr, {});
+    QVERIFY(!manifest.isUpToDate(mMapFile, hash));
+
+    QVERIFY(writeFile(mTargetFile, "exported"));
+    manifest.setExported(mMapFile, mTargetFile, hash);
+    QVERIFY(manifest.save());
+}
+
+void test_ExportManifest::upToDate()
+{
+    exportMap();
+
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr, {});
+    QVERIFY(manifest.isUpToDate(mMapFile, hash));
+}
+
+void test_ExportManifest::changedDependency()
+{
+    exportMap();
+
+    QVERIFY(writeFile(mTilesetFile, "changed tileset"));
+
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr, {});
+    QVERIFY(!manifest.isUpToDate(mMapFile, hash));
+}
+
+void test_ExportManifest::changedOptions()
+{
+    exportMap();
+
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr,
+                                                Preferences::EmbedTilesets);
+    QVERIFY(!manifest.isUpToDate(mMapFile, hash));
+}
+
+void test_ExportManifest::changedProject()
+{
+    exportMap();
+
+    QVERIFY(writeFile(mProjectFile, "project with changed types"));
+
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr, {});
+    QVERIFY(!manifest.isUpToDate(mMapFile, hash));
+}
+
+void test_ExportManifest::missingTarget()
+{
+    exportMap();
+
+    QVERIFY(QFile::remove(mTargetFile));
+
+    ExportManifest manifest(mProjectFile);
+    const QByteArray hash = manifest.sourceHash(mMapFile, mTargetFile, nullptr, {});
+    QVERIFY(!manifest.isUpToDate(mMapFile, hash));
+}
+
+QTEST_MAIN(test_ExportManifest)
+#include "test_exportmanifest.moc"
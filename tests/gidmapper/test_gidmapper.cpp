@@ -0,0 +1,100 @@
+#include "gidmapper.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_GidMapper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void gidsRoundTrip();
+    void gidsSizeMismatch();
+    void gidsInvalidTile();
+
+private:
+    static QByteArray toBuffer(const QVector<quint32> &gids);
+};
+
+QByteArray test_GidMapper::toBuffer(const QVector<quint32> &gids)
+{
+    return QByteArray(reinterpret_cast<const char*>(gids.constData()),
+                      gids.size() * int(sizeof(quint32)));
+}
+
+void test_GidMapper::gidsRoundTrip()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"), 32, 32);
+    tileset->findOrCreateTile(0);
+    tileset->findOrCreateTile(3);
+
+    GidMapper gidMapper;
+    gidMapper.insert(1, tileset);
+
+    TileLayer layer(QString(), 0, 0, 3, 2);
+    Cell flipped(tileset.data(), 3);
+    flipped.setFlippedVertically(true);
+    layer.setCell(0, 0, Cell(tileset.data(), 0));
+    layer.setCell(2, 0, flipped);
+    layer.setCell(1, 1, Cell(tileset.data(), 3));
+
+    const QRect bounds(0, 0, 3, 2);
+    const QByteArray gids = gidMapper.encodeGids(layer, bounds);
+    QCOMPARE(gids.size(), 6 * int(sizeof(quint32)));
+    QCOMPARE(reinterpret_cast<const quint32*>(gids.constData())[0], quint32(1));
+    QCOMPARE(reinterpret_cast<const quint32*>(gids.constData())[4], quint32(4));
+
+    QVector<Cell> cells;
+    QCOMPARE(gidMapper.decodeGids(cells, gids, 6), GidMapper::NoError);
+    QCOMPARE(cells.size(), 6);
+
+    for (int i = 0; i < cells.size(); ++i)
+        QVERIFY(cells.at(i) == layer.cellAt(i % 3, i / 3));
+}
+
+void test_GidMapper::gidsSizeMismatch()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"), 32, 32);
+
+    GidMapper gidMapper;
+    gidMapper.insert(1, tileset);
+
+    QVector<Cell> cells(2, Cell(tileset.data(), 0));
+    const QByteArray gids = toBuffer({ 1, 1, 1 });
+
+    QCOMPARE(gidMapper.decodeGids(cells, gids, 2), GidMapper::CorruptLayerData);
+    QCOMPARE(gidMapper.decodeGids(cells, gids, 4), GidMapper::CorruptLayerData);
+    QCOMPARE(gidMapper.decodeGids(cells, gids.left(5), 1), GidMapper::CorruptLayerData);
+
+    // The cells are left alone when decoding failed
+    QCOMPARE(cells.size(), 2);
+    QVERIFY(cells.at(0) == Cell(tileset.data(), 0));
+}
+
+void test_GidMapper::gidsInvalidTile()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"), 32, 32);
+
+    GidMapper gidMapper;
+    gidMapper.insert(5, tileset);
+
+    // The last gid lies before the first tileset
+    QVector<Cell> cells;
+    const QByteArray gids = toBuffer({ 5, 0, 2 });
+
+    QCOMPARE(gidMapper.decodeGids(cells, gids, 3), GidMapper::InvalidTile);
+    QCOMPARE(gidMapper.invalidTile(), 2u);
+    QVERIFY(cells.isEmpty());
+
+    GidMapper emptyGidMapper;
+    QCOMPARE(emptyGidMapper.decodeGids(cells, toBuffer({ 1 }), 1), GidMapper::TileButNoTilesets);
+    QCOMPARE(emptyGidMapper.decodeGids(cells, toBuffer({ 0 }), 1), GidMapper::NoError);
+    QCOMPARE(cells.size(), 1);
+    QVERIFY(cells.at(0).isEmpty());
+}
+
+QTEST_MAIN(test_GidMapper)
+#include "test_gidmapper.moc"
@@ -3,7 +3,9 @@
 #include "objectgroup.h"
 #include "tilelayer.h"
 #include "mapreader.h"
+#include "mapwriter.h"
 
+#include <QBuffer>
 #include <QtTest/QtTest>
 
 using namespace Tiled;
@@ -14,6 +16,7 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+    void lazyChunkClone();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +56,57 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+void test_MapReader::lazyChunkClone()
+{
+    Map::Parameters parameters;
+    parameters.tileWidth = 32;
+    parameters.tileHeight = 32;
+    parameters.infinite = true;
+
+    Map map(parameters);
+    SharedTileset tileset = Tileset::create(QStringLiteral("tiles"), 32, 32);
+    Tile *tile0 = tileset->findOrCreateTile(0);
+    Tile *tile1 = tileset->findOrCreateTile(1);
+    map.addTileset(tileset);
+
+    auto layer = std::make_unique<TileLayer>(QStringLiteral("Tiles"), 0, 0, 0, 0);
+    layer->setCell(1, 1, Cell(tile0));
+    layer->setCell(40, 3, Cell(tile1));
+    map.addLayer(std::move(layer));
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    MapWriter().writeMap(&map, &buffer);
+    buffer.close();
+
+    const bool wasLazy = MapReader::lazyChunkLoadingEnabled();
+    MapReader::setLazyChunkLoadingEnabled(true);
+
+    buffer.open(QIODevice::ReadOnly);
+    MapReader reader;
+    auto readMap = reader.readMap(&buffer);
+
+    MapReader::setLazyChunkLoadingEnabled(wasLazy);
+
+    QVERIFY(readMap.get());
+    TileLayer *original = readMap->layerAt(0)->asTileLayer();
+    QVERIFY(original);
+
+    // The clone must not be affected by changes made to the original, like
+    // the changes remembered by the undo stack
+    std::unique_ptr<TileLayer> clone(original->clone());
+    original->setCell(1, 1, Cell());
+    original->unloadColdChunks(0);
+
+    QCOMPARE(clone->cellAt(1, 1).tileId(), 0);
+    QCOMPARE(clone->cellAt(40, 3).tileId(), 1);
+    QVERIFY(original->cellAt(1, 1).isEmpty());
+    QCOMPARE(original->cellAt(40, 3).tileId(), 1);
+
+    // Resizing must not leave any chunks in their encoded form
+    original->resize(QSize(64, 64), QPoint(1, 0));
+    QCOMPARE(original->cellAt(41, 3).tileId(), 1);
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
@@ -183,6 +183,8 @@ private slots:
     void loadProperties();
     void saveProperties();
     void mergeProperties();
+    void aggregateProperties();
+    void findTypes();
 
     void cleanupTestCase();
 
@@ -392,6 +394,74 @@ void test_Properties::mergeProperties()
     QCOMPARE(classMember.typeId, newEnumStringType->id);
 }
 
+void test_Properties::aggregateProperties()
+{
+    const QString a = QStringLiteral("a");
+    const QString b = QStringLiteral("b");
+
+    const Properties first { { a, 1 }, { b, 1 } };
+    const Properties second { { a, 1 }, { b, 2 } };
+    const Properties third { { b, 2 } };
+
+    AggregatedProperties aggregated;
+    Tiled::aggregateProperties(aggregated, first);
+    Tiled::aggregateProperties(aggregated, second);
+    Tiled::aggregateProperties(aggregated, third);
+
+    QCOMPARE(aggregated.value(a).presenceCount(), 2);
+    QVERIFY(aggregated.value(a).valueConsistent());
+    QCOMPARE(aggregated.value(b).presenceCount(), 3);
+    QVERIFY(!aggregated.value(b).valueConsistent());
+
+    // Removing the object that set the reference value leaves "b" undetermined
+    const QStringList undetermined = deaggregateProperties(aggregated, first);
+    QCOMPARE(undetermined, QStringList { b });
+    QCOMPARE(aggregated.value(a).presenceCount(), 1);
+    QVERIFY(aggregated.value(a).valueConsistent());
+
+    // Properties no longer present on any object are removed
+    QCOMPARE(deaggregateProperties(aggregated, second), QStringList { b });
+    QVERIFY(!aggregated.contains(a));
+}
+
+void test_Properties::findTypes()
+{
+    PropertyTypes types;
+    auto &a = types.add(std::make_unique<EnumPropertyType>(QStringLiteral("A")));
+    auto &b = types.add(std::make_unique<ClassPropertyType>(QStringLiteral("B")));
+
+    QCOMPARE(types.findTypeByName(QStringLiteral("A")), &a);
+    QCOMPARE(types.findTypeById(b.id), &b);
+    QVERIFY(!types.findTypeByName(QStringLiteral("C")));
+
+    types.setTypeName(0, QStringLiteral("C"));
+    QVERIFY(!types.findTypeByName(QStringLiteral("A")));
+    QCOMPARE(types.findTypeByName(QStringLiteral("C")), &a);
+
+    const int idOfA = a.id;
+    types.removeAt(0);
+    QVERIFY(!types.findTypeById(idOfA));
+    QVERIFY(!types.findTypeByName(QStringLiteral("C")));
+    QCOMPARE(types.findTypeByName(QStringLiteral("B")), &b);
+
+    // Merged types replace existing types with the same name
+    PropertyTypes typesToMerge;
+    typesToMerge.add(std::make_unique<EnumPropertyType>(QStringLiteral("B")));
+    typesToMerge.add(std::make_unique<EnumPropertyType>(QStringLiteral("D")));
+    const int idOfB = b.id;
+    types.merge(std::move(typesToMerge));
+
+    QCOMPARE(types.count(), size_t(2));
+    const PropertyType *mergedB = types.findTypeByName(QStringLiteral("B"));
+    QVERIFY(mergedB && mergedB->type == PropertyType::PT_Enum);
+    QCOMPARE(mergedB->id, idOfB);
+    QCOMPARE(types.findTypeById(idOfB), mergedB);
+
+    const PropertyType *d = types.findTypeByName(QStringLiteral("D"));
+    QVERIFY(d);
+    QCOMPARE(types.findTypeById(d->id), d);
+}
+
 void test_Properties::cleanupTestCase()
 {
     mTypes.clear();
@@ -400,16 +470,16 @@ void test_Properties::cleanupTestCase()
 
 EnumPropertyType &test_Properties::addEnum(const QString &name)
 {
-    auto &type = mTypes.add(std::make_unique<EnumPropertyType>(name));
-    type.id = ++mNextId;
-    return static_cast<EnumPropertyType&>(type);
+    auto type = std::make_unique<EnumPropertyType>(name);
+    type->id = ++mNextId;
+    return static_cast<EnumPropertyType&>(mTypes.add(std::move(type)));
 }
 
 ClassPropertyType &test_Properties::addClass(const QString &name)
 {
-    auto &type = mTypes.add(std::make_unique<ClassPropertyType>(name));
-    type.id = ++mNextId;
-    return static_cast<ClassPropertyType&>(type);
+    auto type = std::make_unique<ClassPropertyType>(name);
+    type->id = ++mNextId;
+    return static_cast<ClassPropertyType&>(mTypes.add(std::move(type)));
 }
 
 QTEST_MAIN(test_Properties)
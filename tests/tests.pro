@@ -1,4 +1,11 @@
 TEMPLATE=subdirs
 SUBDIRS = \
+    benchmarks \
+    exportmanifest \
+    gidmapper \
     mapreader \
-    staggeredrenderer
+    staggeredrenderer \
+    tilelayersnapshot \
+    tileregion \
+    tileset \
+    world
@@ -0,0 +1,71 @@
+#include "tilelayer.h"
+#include "tilelayersnapshot.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_TileLayerSnapshot : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void packUnpack();
+};
+
+void test_TileLayerSnapshot::packUnpack()
+{
+    SharedTileset tileset1 = Tileset::create(QStringLiteral("tiles1"), 32, 32);
+    SharedTileset tileset2 = Tileset::create(QStringLiteral("tiles2"), 32, 32);
+
+    auto layer = std::make_unique<TileLayer>(QString(), 0, 0, 20, 10);
+    for (int y = 0; y < 10; ++y)
+        for (int x = 0; x < 20; ++x)
+            layer->setCell(x, y, Cell(x < 10 ? tileset1.data() : tileset2.data(), x + y));
+
+    Cell flipped(tileset2.data(), 7);
+    flipped.setFlippedHorizontally(true);
+    flipped.setFlippedAntiDiagonally(true);
+    layer->setCell(12, 3, flipped);
+
+    TileLayerSnapshot snapshot(std::move(layer));
+    QVERIFY(!snapshot.isPacked());
+
+    const qint64 unpackedUsage = snapshot.memoryUsage();
+
+    // Cells outside of the packed region are dropped
+    const QRegion region = QRegion(0, 0, 15, 5) + QRegion(10, 0, 10, 10);
+    QVERIFY(snapshot.pack(region));
+    QVERIFY(snapshot.isPacked());
+    QVERIFY(snapshot);
+    QVERIFY(snapshot.memoryUsage() < unpackedUsage);
+
+    // Accessing the layer unpacks it
+    const TileLayer &unpacked = *snapshot;
+    QVERIFY(!snapshot.isPacked());
+    QCOMPARE(unpacked.rect(), QRect(0, 0, 20, 10));
+
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 20; ++x) {
+            const Cell &cell = unpacked.cellAt(x, y);
+
+            if (!region.contains(QPoint(x, y))) {
+                QVERIFY(cell.isEmpty());
+            } else if (x == 12 && y == 3) {
+                QVERIFY(cell == flipped);
+            } else {
+                QCOMPARE(cell.tileset(), x < 10 ? tileset1.data() : tileset2.data());
+                QCOMPARE(cell.tileId(), x + y);
+                QVERIFY(!cell.flippedHorizontally());
+            }
+        }
+    }
+
+    // The snapshot can be packed again after being unpacked
+    QVERIFY(snapshot.pack(region));
+    QVERIFY(snapshot->cellAt(12, 3) == flipped);
+}
+
+QTEST_MAIN(test_TileLayerSnapshot)
+#include "test_tilelayersnapshot.moc"
@@ -0,0 +1,191 @@
+#include "tilelayer.h"
+#include "tileregion.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+#include <random>
+
+using namespace Tiled;
+
+class test_TileRegion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void addAndContains();
+    void spansAcrossChunks();
+    void setOperations();
+    void translate_data();
+    void translate();
+    void boundingRect();
+    void toRegion();
+    void tileLayerRegion();
+};
+
+static QVector<QRect> randomRects(std::mt19937 &generator, int count)
+{
+    std::uniform_int_distribution<int> position(-40, 40);
+    std::uniform_int_distribution<int> size(1, 24);
+
+    QVector<QRect> rects;
+    for (int i = 0; i < count; ++i)
+        rects.append(QRect(position(generator), position(generator),
+                           size(generator), size(generator)));
+    return rects;
+}
+
+static void compareWithRegion(const TileRegion &tileRegion, const QRegion &region)
+{
+    const QRect bounds = region.boundingRect().adjusted(-2, -2, 2, 2);
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y)
+        for (int x = bounds.left(); x <= bounds.right(); ++x)
+            QCOMPARE(tileRegion.contains(x, y), region.contains(QPoint(x, y)));
+
+    QCOMPARE(tileRegion.toRegion(), region);
+    QCOMPARE(tileRegion.boundingRect(), region.boundingRect());
+}
+
+void test_TileRegion::addAndContains()
+{
+    TileRegion region;
+    QVERIFY(region.isEmpty());
+
+    region.add(3, 4);
+    region.add(-1, -1);
+    region.add(QPoint(16, 0));
+
+    QVERIFY(!region.isEmpty());
+    QVERIFY(region.contains(3, 4));
+    QVERIFY(region.contains(-1, -1));
+    QVERIFY(region.contains(16, 0));
+    QVERIFY(!region.contains(4, 4));
+    QVERIFY(!region.contains(-16, -1));
+    QCOMPARE(region.tileCount(), 3);
+}
+
+void test_TileRegion::spansAcrossChunks()
+{
+    TileRegion region;
+    region.addSpan(5, -20, 40);
+
+    QVector<QRect> spans;
+    region.forEachSpan([&] (int y, int left, int right) {
+        spans.append(QRect(QPoint(left, y), QPoint(right, y)));
+    });
+
+    QCOMPARE(spans.size(), 1);
+    QCOMPARE(spans.first(), QRect(QPoint(-20, 5), QPoint(40, 5)));
+    QCOMPARE(region.tileCount(), 61);
+}
+
+void test_TileRegion::setOperations()
+{
+    std::mt19937 generator(42);
+
+    for (int iteration = 0; iteration < 20; ++iteration) {
+        QRegion a, b;
+        TileRegion tileA, tileB;
+
+        for (const QRect &rect : randomRects(generator, 8)) {
+            a += rect;
+            tileA.add(rect);
+        }
+        for (const QRect &rect : randomRects(generator, 8)) {
+            b += rect;
+            tileB.add(rect);
+        }
+
+        compareWithRegion(tileA, a);
+        compareWithRegion(tileA.united(tileB), a.united(b));
+        compareWithRegion(tileA.intersected(tileB), a.intersected(b));
+        compareWithRegion(tileA.subtracted(tileB), a.subtracted(b));
+        QCOMPARE(TileRegion(a), tileA);
+    }
+}
+
+void test_TileRegion::translate_data()
+{
+    QTest::addColumn<QPoint>("offset");
+
+    QTest::newRow("aligned") << QPoint(32, -16);
+    QTest::newRow("unaligned") << QPoint(5, -3);
+    QTest::newRow("negative") << QPoint(-17, -31);
+}
+
+void test_TileRegion::translate()
+{
+    QFETCH(QPoint, offset);
+
+    std::mt19937 generator(7);
+
+    QRegion region;
+    TileRegion tileRegion;
+    for (const QRect &rect : randomRects(generator, 10)) {
+        region += rect;
+        tileRegion.add(rect);
+    }
+
+    compareWithRegion(tileRegion.translated(offset), region.translated(offset));
+}
+
+void test_TileRegion::boundingRect()
+{
+    QCOMPARE(TileRegion().boundingRect(), QRect());
+
+    TileRegion region(QRect(-5, 3, 30, 2));
+    region.add(7, 40);
+    QCOMPARE(region.boundingRect(), QRect(QPoint(-5, 3), QPoint(24, 40)));
+
+    region.remove(QRect(-5, 3, 30, 2));
+    QCOMPARE(region.boundingRect(), QRect(7, 40, 1, 1));
+}
+
+void test_TileRegion::toRegion()
+{
+    // Identical consecutive rows are merged into a single band
+    TileRegion region(QRect(0, 0, 40, 40));
+    QCOMPARE(region.rects(), QVector<QRect> { QRect(0, 0, 40, 40) });
+
+    region.remove(QRect(10, 10, 5, 5));
+    QCOMPARE(region.toRegion(), QRegion(0, 0, 40, 40).subtracted(QRegion(10, 10, 5, 5)));
+}
+
+void test_TileRegion::tileLayerRegion()
+{
+    TileLayer layer(QString(), 3, -2, 20, 20);
+    SharedTileset tileset = Tileset::create(QString(), 16, 16);
+
+    QRegion expected;
+    QRegion expectedOdd;
+    for (int y = 0; y < 20; y += 3) {
+        for (int x = y % 2; x < 20; x += 2) {
+            layer.setCell(x, y, Cell(tileset.data(), x % 4));
+            expected += QRect(x + 3, y - 2, 1, 1);
+            if (x % 4 == 1)
+                expectedOdd += QRect(x + 3, y - 2, 1, 1);
+        }
+    }
+
+    QCOMPARE(layer.region(), expected);
+    QCOMPARE(layer.tileRegion().boundingRect(), expected.boundingRect());
+    QCOMPARE(layer.region([] (const Cell &cell) { return cell.tileId() == 1; }),
+             expectedOdd);
+
+    // The chunk summaries need to follow changes to the cells
+    QCOMPARE(layer.tileBounds(), expected.boundingRect());
+    QVERIFY(layer.referencesTileset(tileset.data()));
+    QVERIFY(!layer.isEmpty());
+
+    layer.setCell(0, 0, Cell());
+    layer.setCell(18, 18, Cell());
+    QCOMPARE(layer.tileBounds(), layer.region().boundingRect());
+
+    layer.removeReferencesToTileset(tileset.data());
+    QVERIFY(!layer.referencesTileset(tileset.data()));
+    QVERIFY(layer.isEmpty());
+    QCOMPARE(layer.tileBounds(), QRect());
+}
+
+QTEST_APPLESS_MAIN(test_TileRegion)
+#include "test_tileregion.moc"
@@ -0,0 +1,56 @@
+#include "tile.h"
+#include "tileset.h"
+
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+class test_Tileset : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void findTile();
+    void findSparseTiles();
+};
+
+void test_Tileset::findTile()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("test"), 32, 32);
+
+    for (int id = 0; id < 10; ++id)
+        QCOMPARE(tileset->findOrCreateTile(id)->id(), id);
+
+    for (int id = 0; id < 10; ++id)
+        QCOMPARE(tileset->findTile(id)->id(), id);
+
+    QVERIFY(!tileset->findTile(-1));
+    QVERIFY(!tileset->findTile(10));
+}
+
+void test_Tileset::findSparseTiles()
+{
+    SharedTileset tileset = Tileset::create(QStringLiteral("test"), 32, 32);
+
+    // The tiles from 100 are first too sparse to be stored in the array,
+    // until tile 179 makes it grow to include them
+    for (int id = 0; id < 10; ++id)
+        tileset->findOrCreateTile(id);
+    for (int id = 100; id < 180; ++id)
+        tileset->findOrCreateTile(id);
+
+    for (int id = 0; id < 10; ++id)
+        QCOMPARE(tileset->findTile(id)->id(), id);
+    for (int id = 10; id < 100; ++id)
+        QVERIFY(!tileset->findTile(id));
+    for (int id = 100; id < 180; ++id)
+        QCOMPARE(tileset->findTile(id)->id(), id);
+
+    // A far away ID is found even though it is not stored in the array
+    tileset->findOrCreateTile(100000);
+    QCOMPARE(tileset->findTile(100000)->id(), 100000);
+    QCOMPARE(tileset->findTile(150)->id(), 150);
+}
+
+QTEST_MAIN(test_Tileset)
+#include "test_tileset.moc"
@@ -0,0 +1,162 @@
+#include "worldmanager.h"
+
+#include <QtTest/QtTest>
+
+#include <random>
+
+using namespace Tiled;
+
+class test_World : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mapsInRect();
+    void largeMaps();
+    void modifyMaps();
+    void patternMaps();
+};
+
+static QStringList fileNames(const QVector<World::MapEntry> &maps)
+{
+    QStringList names;
+    for (const World::MapEntry &map : maps)
+        names.append(map.fileName);
+    return names;
+}
+
+static QStringList bruteForceMapsInRect(const World &world, const QRect &rect)
+{
+    QStringList names;
+    for (const World::MapEntry &map : world.allMaps())
+        if (map.rect.intersects(rect))
+            names.append(map.fileName);
+    return names;
+}
+
+static bool createFile(const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly);
+}
+
+void test_World::mapsInRect()
+{
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<int> position(-5000, 5000);
+    std::uniform_int_distribution<int> size(1, 800);
+
+    World world;
+    world.fileName = QStringLiteral("test.world");
+
+    for (int i = 0; i < 500; ++i) {
+        world.addMap(QStringLiteral("map%1.tmx").arg(i),
+                     QRect(position(generator), position(generator),
+                           size(generator), size(generator)));
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        const QRect rect(position(generator), position(generator),
+                         size(generator) * 2, size(generator) * 2);
+        QCOMPARE(fileNames(world.mapsInRect(rect)), bruteForceMapsInRect(world, rect));
+    }
+
+    // Query areas covering many grid cells
+    const QRect everything(-10000, -10000, 20000, 20000);
+    QCOMPARE(world.mapsInRect(everything).size(), 500);
+
+    QVERIFY(world.mapsInRect(QRect()).isEmpty());
+}
+
+void test_World::largeMaps()
+{
+    World world;
+    world.fileName = QStringLiteral("test.world");
+
+    for (int y = -5; y < 5; ++y)
+        for (int x = -5; x < 5; ++x)
+            world.addMap(QStringLiteral("map_%1_%2.tmx").arg(x).arg(y),
+                         QRect(x * 100, y * 100, 100, 100));
+
+    world.addMap(QStringLiteral("huge.tmx"), QRect(-1000000, -1000000, 2000000, 2000000));
+    world.addMap(QStringLiteral("empty.tmx"), QRect(0, 0, 0, 0));
+
+    const QRect rect(150, -250, 10, 10);
+    const QStringList expected { QStringLiteral("map_1_-3.tmx"), QStringLiteral("huge.tmx") };
+    QCOMPARE(fileNames(world.mapsInRect(rect)), expected);
+    QCOMPARE(fileNames(world.mapsInRect(rect)), bruteForceMapsInRect(world, rect));
+
+    const QRect farAway(900000, 900000, 10, 10);
+    QCOMPARE(fileNames(world.mapsInRect(farAway)), QStringList { QStringLiteral("huge.tmx") });
+}
+
+void test_World::modifyMaps()
+{
+    World world;
+    world.fileName = QStringLiteral("test.world");
+
+    world.addMap(QStringLiteral("a.tmx"), QRect(0, 0, 100, 100));
+    world.addMap(QStringLiteral("b.tmx"), QRect(100, 0, 100, 100));
+
+    QCOMPARE(world.mapIndex(QStringLiteral("b.tmx")), 1);
+    QCOMPARE(world.mapRect(QStringLiteral("b.tmx")), QRect(100, 0, 100, 100));
+    QCOMPARE(fileNames(world.mapsInRect(QRect(150, 50, 1, 1))),
+             QStringList { QStringLiteral("b.tmx") });
+
+    world.setMapRect(1, QRect(1000, 1000, 100, 100));
+    QVERIFY(world.mapsInRect(QRect(150, 50, 1, 1)).isEmpty());
+    QCOMPARE(fileNames(world.mapsInRect(QRect(1050, 1050, 1, 1))),
+             QStringList { QStringLiteral("b.tmx") });
+
+    world.removeMap(0);
+    QCOMPARE(world.mapIndex(QStringLiteral("a.tmx")), -1);
+    QCOMPARE(world.mapIndex(QStringLiteral("b.tmx")), 0);
+    QVERIFY(!world.containsMap(QStringLiteral("a.tmx")));
+    QVERIFY(world.mapsInRect(QRect(50, 50, 1, 1)).isEmpty());
+}
+
+void test_World::patternMaps()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    World world;
+    world.fileName = dir.filePath(QStringLiteral("test.world"));
+
+    World::Pattern pattern;
+    pattern.regexp.setPattern(QStringLiteral("map_(-?\\d+)_(-?\\d+)\\.tmx$"));
+    pattern.multiplierX = 100;
+    pattern.multiplierY = 100;
+    pattern.offset = QPoint(-50, -50);
+    pattern.mapSize = QSize(100, 100);
+    world.patterns.append(pattern);
+
+    QVERIFY(createFile(dir.filePath(QStringLiteral("map_0_0.tmx"))));
+    QVERIFY(createFile(dir.filePath(QStringLiteral("map_-1_2.tmx"))));
+    QVERIFY(createFile(dir.filePath(QStringLiteral("other.tmx"))));
+
+    const QString map00 = dir.filePath(QStringLiteral("map_0_0.tmx"));
+    const QString map12 = dir.filePath(QStringLiteral("map_-1_2.tmx"));
+    const QString map30 = dir.filePath(QStringLiteral("map_3_0.tmx"));
+
+    QCOMPARE(world.allMaps().size(), 2);
+    QVERIFY(world.containsMap(map00));
+    QVERIFY(!world.containsMap(dir.filePath(QStringLiteral("other.tmx"))));
+    QCOMPARE(world.mapRect(map12), QRect(-150, 150, 100, 100));
+    QCOMPARE(world.mapIndex(map00), -1);
+    QCOMPARE(fileNames(world.mapsInRect(QRect(-10, -10, 20, 20))), QStringList { map00 });
+
+    // Maps not found in the directory are still matched by the patterns
+    QVERIFY(world.containsMap(map30));
+    QCOMPARE(world.mapRect(map30), QRect(250, -50, 100, 100));
+
+    // New files are only picked up after the index was invalidated
+    QVERIFY(createFile(map30));
+    QCOMPARE(world.allMaps().size(), 2);
+    world.invalidateMapIndex();
+    QCOMPARE(world.allMaps().size(), 3);
+    QCOMPARE(fileNames(world.mapsInRect(QRect(300, 0, 1, 1))), QStringList { map30 });
+}
+
+QTEST_MAIN(test_World)
+#include "test_world.moc"